@@ -0,0 +1,296 @@
+#include <jni.h>
+
+#include <cstddef>
+
+#include "core/src/main/java/com/roboknights4348/lib/wpimath/src/main/java/edu/wpi/first/math/com_roboknights4348_lib_wpimath_src_main_java_edu_wpi_first_math_GeometryJNI.h"
+#include "geometry/Batch.h"
+
+namespace {
+
+/**
+ * Holds the elements of a Java double[] for the duration of a call. Inputs
+ * are released without copying back; outputs are copied back.
+ */
+    class DoubleArray {
+    public:
+        DoubleArray(JNIEnv *env, jdoubleArray array, bool output)
+                : m_env(env), m_array(array), m_output(output) {
+            m_size = env->GetArrayLength(array);
+            m_elements = env->GetDoubleArrayElements(array, nullptr);
+        }
+
+        ~DoubleArray() {
+            if (m_elements) {
+                m_env->ReleaseDoubleArrayElements(m_array, m_elements,
+                                                  m_output ? 0 : JNI_ABORT);
+            }
+        }
+
+        DoubleArray(const DoubleArray &) = delete;
+
+        DoubleArray &operator=(const DoubleArray &) = delete;
+
+        explicit operator bool() const { return m_elements != nullptr; }
+
+        double *data() const { return m_elements; }
+
+        size_t size() const { return m_size; }
+
+    private:
+        JNIEnv *m_env;
+        jdoubleArray m_array;
+        bool m_output;
+        jdouble *m_elements;
+        size_t m_size;
+    };
+
+    void ThrowIllegalArgument(JNIEnv *env, const char *msg) {
+        jclass cls = env->FindClass("java/lang/IllegalArgumentException");
+        if (cls) {
+            env->ThrowNew(cls, msg);
+        }
+    }
+
+/**
+ * Checks that an array holds a whole number of elements of the given stride
+ * and returns that number, or throws and returns -1.
+ */
+    ptrdiff_t Count(JNIEnv *env, const DoubleArray &array, size_t stride) {
+        if (array.size() % stride != 0) {
+            ThrowIllegalArgument(env, "array length is not a multiple of the stride");
+            return -1;
+        }
+        return array.size() / stride;
+    }
+
+    bool CheckOutput(JNIEnv *env, const DoubleArray &out, size_t count,
+                     size_t stride) {
+        if (out.size() < count * stride) {
+            ThrowIllegalArgument(env, "output array is too short");
+            return false;
+        }
+        return true;
+    }
+
+    template<typename Fn>
+    void RunTransform(JNIEnv *env, jdoubleArray transform, size_t transformSize,
+                      jdoubleArray in, size_t stride, jdoubleArray out, Fn fn) {
+        DoubleArray nativeTransform{env, transform, false};
+        DoubleArray nativeIn{env, in, false};
+        DoubleArray nativeOut{env, out, true};
+        if (!nativeTransform || !nativeIn || !nativeOut) return;
+        if (nativeTransform.size() != transformSize) {
+            ThrowIllegalArgument(env, "transform has the wrong length");
+            return;
+        }
+        ptrdiff_t count = Count(env, nativeIn, stride);
+        if (count < 0 || !CheckOutput(env, nativeOut, count, stride)) return;
+        fn(nativeTransform.data(), nativeIn.data(), nativeOut.data(), count);
+    }
+
+    template<typename Fn>
+    void RunMap(JNIEnv *env, jdoubleArray in, size_t inStride, jdoubleArray out,
+                size_t outStride, Fn fn) {
+        DoubleArray nativeIn{env, in, false};
+        DoubleArray nativeOut{env, out, true};
+        if (!nativeIn || !nativeOut) return;
+        ptrdiff_t count = Count(env, nativeIn, inStride);
+        if (count < 0 || !CheckOutput(env, nativeOut, count, outStride)) return;
+        fn(nativeIn.data(), nativeOut.data(), count);
+    }
+
+    template<typename Fn>
+    void RunInterpolate(JNIEnv *env, jdoubleArray a, jdoubleArray b, size_t stride,
+                        jdoubleArray out, Fn fn) {
+        DoubleArray nativeA{env, a, false};
+        DoubleArray nativeB{env, b, false};
+        DoubleArray nativeOut{env, out, true};
+        if (!nativeA || !nativeB || !nativeOut) return;
+        ptrdiff_t count = Count(env, nativeA, stride);
+        if (count < 0) return;
+        if (nativeB.size() != nativeA.size()) {
+            ThrowIllegalArgument(env, "pose arrays differ in length");
+            return;
+        }
+        if (!CheckOutput(env, nativeOut, count, stride)) return;
+        fn(nativeA.data(), nativeB.data(), nativeOut.data(), count);
+    }
+
+    geometry::SE2 LoadSE2(const double *p) {
+        return geometry::SE2(p[0], p[1], p[2]);
+    }
+
+}  // namespace
+
+extern "C" {
+
+/*
+ * Class:     edu_wpi_first_math_GeometryJNI
+ * Method:    transformPoses2d
+ * Signature: ([D[D[D)V
+ */
+JNIEXPORT void JNICALL
+Java_com_roboknights4348_lib_wpimath_src_main_java_edu_wpi_first_math_GeometryJNI_transformPoses2d
+        (JNIEnv *env, jclass, jdoubleArray transform, jdoubleArray poses,
+         jdoubleArray out) {
+    RunTransform(
+            env, transform, 3, poses, 3, out,
+            [](const double *T, const double *in, double *out, size_t n) {
+                geometry::TransformPoses(LoadSE2(T), in, out, n);
+            });
+}
+
+/*
+ * Class:     edu_wpi_first_math_GeometryJNI
+ * Method:    transformPoses3d
+ * Signature: ([D[D[D)V
+ */
+JNIEXPORT void JNICALL
+Java_com_roboknights4348_lib_wpimath_src_main_java_edu_wpi_first_math_GeometryJNI_transformPoses3d
+        (JNIEnv *env, jclass, jdoubleArray transform, jdoubleArray poses,
+         jdoubleArray out) {
+    RunTransform(
+            env, transform, 7, poses, 7, out,
+            [](const double *T, const double *in, double *out, size_t n) {
+                geometry::TransformPoses(geometry::LoadSE3(T), in, out, n);
+            });
+}
+
+/*
+ * Class:     edu_wpi_first_math_GeometryJNI
+ * Method:    transformPoints2d
+ * Signature: ([D[D[D)V
+ */
+JNIEXPORT void JNICALL
+Java_com_roboknights4348_lib_wpimath_src_main_java_edu_wpi_first_math_GeometryJNI_transformPoints2d
+        (JNIEnv *env, jclass, jdoubleArray transform, jdoubleArray points,
+         jdoubleArray out) {
+    RunTransform(
+            env, transform, 3, points, 2, out,
+            [](const double *T, const double *in, double *out, size_t n) {
+                geometry::TransformPoints(LoadSE2(T), in, out, n);
+            });
+}
+
+/*
+ * Class:     edu_wpi_first_math_GeometryJNI
+ * Method:    transformPoints3d
+ * Signature: ([D[D[D)V
+ */
+JNIEXPORT void JNICALL
+Java_com_roboknights4348_lib_wpimath_src_main_java_edu_wpi_first_math_GeometryJNI_transformPoints3d
+        (JNIEnv *env, jclass, jdoubleArray transform, jdoubleArray points,
+         jdoubleArray out) {
+    RunTransform(
+            env, transform, 7, points, 3, out,
+            [](const double *T, const double *in, double *out, size_t n) {
+                geometry::TransformPoints(geometry::LoadSE3(T), in, out, n);
+            });
+}
+
+/*
+ * Class:     edu_wpi_first_math_GeometryJNI
+ * Method:    composePoses2d
+ * Signature: ([D[D[D)V
+ */
+JNIEXPORT void JNICALL
+Java_com_roboknights4348_lib_wpimath_src_main_java_edu_wpi_first_math_GeometryJNI_composePoses2d
+        (JNIEnv *env, jclass, jdoubleArray poses, jdoubleArray transform,
+         jdoubleArray out) {
+    RunTransform(
+            env, transform, 3, poses, 3, out,
+            [](const double *T, const double *in, double *out, size_t n) {
+                geometry::ComposePoses(in, LoadSE2(T), out, n);
+            });
+}
+
+/*
+ * Class:     edu_wpi_first_math_GeometryJNI
+ * Method:    composePoses3d
+ * Signature: ([D[D[D)V
+ */
+JNIEXPORT void JNICALL
+Java_com_roboknights4348_lib_wpimath_src_main_java_edu_wpi_first_math_GeometryJNI_composePoses3d
+        (JNIEnv *env, jclass, jdoubleArray poses, jdoubleArray transform,
+         jdoubleArray out) {
+    RunTransform(
+            env, transform, 7, poses, 7, out,
+            [](const double *T, const double *in, double *out, size_t n) {
+                geometry::ComposePoses(in, geometry::LoadSE3(T), out, n);
+            });
+}
+
+/*
+ * Class:     edu_wpi_first_math_GeometryJNI
+ * Method:    expPoses2d
+ * Signature: ([D[D)V
+ */
+JNIEXPORT void JNICALL
+Java_com_roboknights4348_lib_wpimath_src_main_java_edu_wpi_first_math_GeometryJNI_expPoses2d
+        (JNIEnv *env, jclass, jdoubleArray twists, jdoubleArray out) {
+    RunMap(env, twists, 3, out, 3, geometry::ExpPoses2d);
+}
+
+/*
+ * Class:     edu_wpi_first_math_GeometryJNI
+ * Method:    logPoses2d
+ * Signature: ([D[D)V
+ */
+JNIEXPORT void JNICALL
+Java_com_roboknights4348_lib_wpimath_src_main_java_edu_wpi_first_math_GeometryJNI_logPoses2d
+        (JNIEnv *env, jclass, jdoubleArray poses, jdoubleArray out) {
+    RunMap(env, poses, 3, out, 3, geometry::LogPoses2d);
+}
+
+/*
+ * Class:     edu_wpi_first_math_GeometryJNI
+ * Method:    expPoses3d
+ * Signature: ([D[D)V
+ */
+JNIEXPORT void JNICALL
+Java_com_roboknights4348_lib_wpimath_src_main_java_edu_wpi_first_math_GeometryJNI_expPoses3d
+        (JNIEnv *env, jclass, jdoubleArray twists, jdoubleArray out) {
+    RunMap(env, twists, 6, out, 7, geometry::ExpPoses3d);
+}
+
+/*
+ * Class:     edu_wpi_first_math_GeometryJNI
+ * Method:    logPoses3d
+ * Signature: ([D[D)V
+ */
+JNIEXPORT void JNICALL
+Java_com_roboknights4348_lib_wpimath_src_main_java_edu_wpi_first_math_GeometryJNI_logPoses3d
+        (JNIEnv *env, jclass, jdoubleArray poses, jdoubleArray out) {
+    RunMap(env, poses, 7, out, 6, geometry::LogPoses3d);
+}
+
+/*
+ * Class:     edu_wpi_first_math_GeometryJNI
+ * Method:    interpolatePoses2d
+ * Signature: ([D[DD[D)V
+ */
+JNIEXPORT void JNICALL
+Java_com_roboknights4348_lib_wpimath_src_main_java_edu_wpi_first_math_GeometryJNI_interpolatePoses2d
+        (JNIEnv *env, jclass, jdoubleArray a, jdoubleArray b, jdouble t,
+         jdoubleArray out) {
+    RunInterpolate(env, a, b, 3, out,
+                   [t](const double *a, const double *b, double *out, size_t n) {
+                       geometry::InterpolatePoses2d(a, b, t, out, n);
+                   });
+}
+
+/*
+ * Class:     edu_wpi_first_math_GeometryJNI
+ * Method:    interpolatePoses3d
+ * Signature: ([D[DD[D)V
+ */
+JNIEXPORT void JNICALL
+Java_com_roboknights4348_lib_wpimath_src_main_java_edu_wpi_first_math_GeometryJNI_interpolatePoses3d
+        (JNIEnv *env, jclass, jdoubleArray a, jdoubleArray b, jdouble t,
+         jdoubleArray out) {
+    RunInterpolate(env, a, b, 7, out,
+                   [t](const double *a, const double *b, double *out, size_t n) {
+                       geometry::InterpolatePoses3d(a, b, t, out, n);
+                   });
+}
+}  // extern "C"
@@ -0,0 +1,251 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+
+#include <Eigen/Core>
+
+#include "SE2.h"
+#include "SE3.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define GEOMETRY_NEON
+#endif
+
+/*
+ * Batched operations over packed arrays of poses.
+ *
+ * Planar poses are packed as (x, y, theta) and spatial poses as
+ * (x, y, z, qw, qx, qy, qz), one after another with no padding, which is the
+ * layout the JNI entry points receive from Java. Points are packed as (x, y)
+ * or (x, y, z). Unless noted otherwise, in and out may be the same array.
+ */
+namespace geometry {
+
+    namespace detail {
+
+/**
+ * Applies a fixed planar rotation and translation to (x, y) pairs. The
+ * rotation columns and translation are held in vector registers so each pair
+ * costs two multiplies and two adds.
+ */
+        class XYTransform {
+        public:
+            explicit XYTransform(const SE2 &T) {
+#if defined(__SSE2__)
+                m_col0 = _mm_set_pd(T.Sin(), T.Cos());
+                m_col1 = _mm_set_pd(T.Cos(), -T.Sin());
+                m_t = _mm_set_pd(T.Y(), T.X());
+#elif defined(GEOMETRY_NEON)
+                m_col0 = float64x2_t{T.Cos(), T.Sin()};
+                m_col1 = float64x2_t{-T.Sin(), T.Cos()};
+                m_t = float64x2_t{T.X(), T.Y()};
+#else
+                m_c = T.Cos();
+                m_s = T.Sin();
+                m_x = T.X();
+                m_y = T.Y();
+#endif
+            }
+
+            void operator()(const double *in, double *out) const {
+#if defined(__SSE2__)
+                __m128d x = _mm_set1_pd(in[0]);
+                __m128d y = _mm_set1_pd(in[1]);
+                _mm_storeu_pd(out, _mm_add_pd(_mm_add_pd(_mm_mul_pd(m_col0, x),
+                                                         _mm_mul_pd(m_col1, y)),
+                                              m_t));
+#elif defined(GEOMETRY_NEON)
+                vst1q_f64(out, vfmaq_n_f64(vfmaq_n_f64(m_t, m_col0, in[0]), m_col1,
+                                           in[1]));
+#else
+                double x = in[0], y = in[1];
+                out[0] = m_c * x - m_s * y + m_x;
+                out[1] = m_s * x + m_c * y + m_y;
+#endif
+            }
+
+        private:
+#if defined(__SSE2__)
+            __m128d m_col0, m_col1, m_t;
+#elif defined(GEOMETRY_NEON)
+            float64x2_t m_col0, m_col1, m_t;
+#else
+            double m_c, m_s, m_x, m_y;
+#endif
+        };
+
+        inline double WrapAngle(double angle) {
+            return std::remainder(angle, 2 * M_PI);
+        }
+
+    }  // namespace detail
+
+/// Reads a spatial pose packed as (x, y, z, qw, qx, qy, qz).
+    inline SE3 LoadSE3(const double *p) {
+        return SE3(SE3::Point(p[0], p[1], p[2]),
+                   SE3::Quaternion(p[3], p[4], p[5], p[6]));
+    }
+
+/// Writes a spatial pose packed as (x, y, z, qw, qx, qy, qz).
+    inline void StoreSE3(const SE3 &T, double *p) {
+        Eigen::Map<Eigen::Vector3d>{p} = T.Translation();
+        Eigen::Map<Eigen::Vector4d>{p + 3} = T.Quat();
+    }
+
+/**
+ * Computes out[i] = T * in[i] for n planar poses.
+ */
+    inline void TransformPoses(const SE2 &T, const double *in, double *out,
+                               size_t n) {
+        detail::XYTransform xy{T};
+        double theta = T.Theta();
+        for (size_t i = 0; i < n; ++i, in += 3, out += 3) {
+            double inTheta = in[2];
+            xy(in, out);
+            out[2] = detail::WrapAngle(inTheta + theta);
+        }
+    }
+
+/**
+ * Computes out[i] = T * in[i] for n planar points.
+ */
+    inline void TransformPoints(const SE2 &T, const double *in, double *out,
+                                size_t n) {
+        detail::XYTransform xy{T};
+        for (size_t i = 0; i < n; ++i, in += 2, out += 2) xy(in, out);
+    }
+
+/**
+ * Computes out[i] = in[i] * T for n planar poses.
+ */
+    inline void ComposePoses(const double *in, const SE2 &T, double *out,
+                             size_t n) {
+        for (size_t i = 0; i < n; ++i, in += 3, out += 3) {
+            SE2 pose = SE2(in[0], in[1], in[2]) * T;
+            out[0] = pose.X();
+            out[1] = pose.Y();
+            out[2] = pose.Theta();
+        }
+    }
+
+/**
+ * Computes out[i] = T * in[i] for n spatial poses.
+ *
+ * The quaternion part is a 4x4 matrix-vector product, which Eigen evaluates
+ * with SSE2/NEON packets.
+ */
+    inline void TransformPoses(const SE3 &T, const double *in, double *out,
+                               size_t n) {
+        const Eigen::Matrix3d R = T.Rotation();
+        const Eigen::Matrix4d L = SE3::LeftMatrix(T.Quat());
+        const Eigen::Vector3d t = T.Translation();
+        for (size_t i = 0; i < n; ++i, in += 7, out += 7) {
+            Eigen::Vector3d p = R * Eigen::Map<const Eigen::Vector3d>{in} + t;
+            Eigen::Vector4d q = L * Eigen::Map<const Eigen::Vector4d>{in + 3};
+            Eigen::Map<Eigen::Vector3d>{out} = p;
+            Eigen::Map<Eigen::Vector4d>{out + 3} = q;
+        }
+    }
+
+/**
+ * Computes out[i] = T * in[i] for n spatial points.
+ */
+    inline void TransformPoints(const SE3 &T, const double *in, double *out,
+                                size_t n) {
+        const Eigen::Matrix3d R = T.Rotation();
+        const Eigen::Vector3d t = T.Translation();
+        for (size_t i = 0; i < n; ++i, in += 3, out += 3) {
+            Eigen::Vector3d p = R * Eigen::Map<const Eigen::Vector3d>{in} + t;
+            Eigen::Map<Eigen::Vector3d>{out} = p;
+        }
+    }
+
+/**
+ * Computes out[i] = in[i] * T for n spatial poses.
+ */
+    inline void ComposePoses(const double *in, const SE3 &T, double *out,
+                             size_t n) {
+        const Eigen::Matrix4d Rq = SE3::RightMatrix(T.Quat());
+        for (size_t i = 0; i < n; ++i, in += 7, out += 7) {
+            SE3 pose = LoadSE3(in);
+            Eigen::Vector3d p = pose * T.Translation();
+            Eigen::Vector4d q = Rq * Eigen::Map<const Eigen::Vector4d>{in + 3};
+            Eigen::Map<Eigen::Vector3d>{out} = p;
+            Eigen::Map<Eigen::Vector4d>{out + 3} = q;
+        }
+    }
+
+/**
+ * Maps n planar twists (dx, dy, dtheta) to poses.
+ */
+    inline void ExpPoses2d(const double *twists, double *out, size_t n) {
+        for (size_t i = 0; i < n; ++i, twists += 3, out += 3) {
+            SE2 pose = SE2::Exp(Eigen::Map<const Eigen::Vector3d>{twists});
+            out[0] = pose.X();
+            out[1] = pose.Y();
+            out[2] = pose.Theta();
+        }
+    }
+
+/**
+ * Maps n planar poses to twists (dx, dy, dtheta).
+ */
+    inline void LogPoses2d(const double *in, double *twists, size_t n) {
+        for (size_t i = 0; i < n; ++i, in += 3, twists += 3) {
+            Eigen::Map<Eigen::Vector3d>{twists} = SE2(in[0], in[1], in[2]).Log();
+        }
+    }
+
+/**
+ * Maps n spatial twists (rho, omega) to poses.
+ */
+    inline void ExpPoses3d(const double *twists, double *out, size_t n) {
+        for (size_t i = 0; i < n; ++i, twists += 6, out += 7) {
+            StoreSE3(
+                    SE3::Exp(Eigen::Map<const SE3::Tangent, Eigen::Unaligned>{twists}),
+                    out);
+        }
+    }
+
+/**
+ * Maps n spatial poses to twists (rho, omega).
+ */
+    inline void LogPoses3d(const double *in, double *twists, size_t n) {
+        for (size_t i = 0; i < n; ++i, in += 7, twists += 6) {
+            Eigen::Map<SE3::Tangent, Eigen::Unaligned>{twists} =
+                    LoadSE3(in).Log();
+        }
+    }
+
+/**
+ * Interpolates pairwise between n planar poses in a and b.
+ */
+    inline void InterpolatePoses2d(const double *a, const double *b, double t,
+                                   double *out, size_t n) {
+        for (size_t i = 0; i < n; ++i, a += 3, b += 3, out += 3) {
+            SE2 pose = SE2::Interpolate(SE2(a[0], a[1], a[2]),
+                                        SE2(b[0], b[1], b[2]), t);
+            out[0] = pose.X();
+            out[1] = pose.Y();
+            out[2] = pose.Theta();
+        }
+    }
+
+/**
+ * Interpolates pairwise between n spatial poses in a and b.
+ */
+    inline void InterpolatePoses3d(const double *a, const double *b, double t,
+                                   double *out, size_t n) {
+        for (size_t i = 0; i < n; ++i, a += 7, b += 7, out += 7) {
+            StoreSE3(
+                    SE3::Interpolate(LoadSE3(a), LoadSE3(b), t), out);
+        }
+    }
+
+}  // namespace geometry
+
+#undef GEOMETRY_NEON
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <cmath>
+
+#include <Eigen/Core>
+
+namespace geometry {
+
+/**
+ * A rigid transform in the plane: a rotation followed by a translation.
+ *
+ * The rotation is stored as a unit complex number (cos, sin) so that
+ * composition and point transforms need no trigonometry. Everything is
+ * fixed-size and lives on the stack.
+ */
+    class SE2 {
+    public:
+        /// Tangent vector (dx, dy, dtheta)
+        using Tangent = Eigen::Vector3d;
+        using Point = Eigen::Vector2d;
+
+        SE2() = default;
+
+        SE2(double x, double y, double theta)
+                : m_translation(x, y), m_cos(std::cos(theta)), m_sin(std::sin(theta)) {}
+
+        SE2(const Point &translation, double cos, double sin)
+                : m_translation(translation), m_cos(cos), m_sin(sin) {}
+
+        /**
+         * Returns the transform reached by following a constant-curvature twist
+         * for unit time.
+         */
+        static SE2 Exp(const Tangent &twist) {
+            double dtheta = twist(2);
+            double s, c;
+            if (std::abs(dtheta) < 1e-9) {
+                s = 1.0 - dtheta * dtheta / 6.0;
+                c = 0.5 * dtheta;
+            } else {
+                s = std::sin(dtheta) / dtheta;
+                c = (1 - std::cos(dtheta)) / dtheta;
+            }
+            return SE2(Point(twist(0) * s - twist(1) * c, twist(0) * c + twist(1) * s),
+                       std::cos(dtheta), std::sin(dtheta));
+        }
+
+        /// Inverse of Exp().
+        Tangent Log() const {
+            double dtheta = Theta();
+            double halfDtheta = 0.5 * dtheta;
+            double cosMinusOne = m_cos - 1;
+            double a;
+            if (std::abs(cosMinusOne) < 1e-9) {
+                a = 1.0 - dtheta * dtheta / 12.0;
+            } else {
+                a = -(halfDtheta * m_sin) / cosMinusOne;
+            }
+            return Tangent(a * m_translation(0) + halfDtheta * m_translation(1),
+                           -halfDtheta * m_translation(0) + a * m_translation(1),
+                           dtheta);
+        }
+
+        /// Returns this transform followed by (i.e. expressed in) other's frame.
+        SE2 operator*(const SE2 &other) const {
+            return SE2(*this * other.m_translation,
+                       m_cos * other.m_cos - m_sin * other.m_sin,
+                       m_sin * other.m_cos + m_cos * other.m_sin);
+        }
+
+        /// Transforms a point.
+        Point operator*(const Point &p) const {
+            return Point(m_cos * p(0) - m_sin * p(1) + m_translation(0),
+                         m_sin * p(0) + m_cos * p(1) + m_translation(1));
+        }
+
+        SE2 Inverse() const {
+            return SE2(Point(-m_cos * m_translation(0) - m_sin * m_translation(1),
+                             m_sin * m_translation(0) - m_cos * m_translation(1)),
+                       m_cos, -m_sin);
+        }
+
+        /**
+         * Interpolates along the twist between two transforms.
+         *
+         * @param t interpolation parameter in [0, 1]
+         */
+        static SE2 Interpolate(const SE2 &a, const SE2 &b, double t) {
+            return a * Exp(t * (a.Inverse() * b).Log());
+        }
+
+        /// Returns the 2x2 rotation matrix.
+        Eigen::Matrix2d Rotation() const {
+            return (Eigen::Matrix2d() << m_cos, -m_sin, m_sin, m_cos).finished();
+        }
+
+        const Point &Translation() const { return m_translation; }
+
+        double X() const { return m_translation(0); }
+
+        double Y() const { return m_translation(1); }
+
+        double Theta() const { return std::atan2(m_sin, m_cos); }
+
+        double Cos() const { return m_cos; }
+
+        double Sin() const { return m_sin; }
+
+    private:
+        Point m_translation = Point::Zero();
+        double m_cos = 1;
+        double m_sin = 0;
+    };
+
+}  // namespace geometry
@@ -0,0 +1,214 @@
+#pragma once
+
+#include <cmath>
+
+#include <Eigen/Core>
+
+namespace geometry {
+
+/**
+ * Returns the skew-symmetric matrix [v]x such that [v]x * u = v x u.
+ */
+    inline Eigen::Matrix3d Skew(const Eigen::Vector3d &v) {
+        return (Eigen::Matrix3d() << 0, -v(2), v(1),
+                v(2), 0, -v(0),
+                -v(1), v(0), 0).finished();
+    }
+
+/**
+ * Returns the cross product a x b. Eigen's cross() lives in the Geometry
+ * module, which is not vendored here.
+ */
+    inline Eigen::Vector3d Cross(const Eigen::Vector3d &a, const Eigen::Vector3d &b) {
+        return Eigen::Vector3d(a(1) * b(2) - a(2) * b(1), a(2) * b(0) - a(0) * b(2),
+                               a(0) * b(1) - a(1) * b(0));
+    }
+
+/**
+ * A rigid transform in space: a rotation followed by a translation.
+ *
+ * The rotation is stored as a unit quaternion in (w, x, y, z) order. The
+ * quaternion uses an unaligned vector so that SE3 may be held by value in
+ * std::vector and other containers without an aligned allocator.
+ */
+    class SE3 {
+    public:
+        /// Tangent vector (rho, omega): translational then rotational part
+        using Tangent = Eigen::Matrix<double, 6, 1>;
+        using Point = Eigen::Vector3d;
+        using Quaternion = Eigen::Matrix<double, 4, 1, Eigen::DontAlign>;
+
+        SE3() = default;
+
+        /**
+         * @param translation translation
+         * @param rotation unit quaternion (w, x, y, z)
+         */
+        SE3(const Point &translation, const Quaternion &rotation)
+                : m_translation(translation), m_rotation(rotation) {}
+
+        /**
+         * Builds a rotation from intrinsic yaw-pitch-roll (Z-Y-X) angles.
+         */
+        static Quaternion EulerToQuaternion(double yaw, double pitch, double roll) {
+            double cy = std::cos(yaw / 2), sy = std::sin(yaw / 2);
+            double cp = std::cos(pitch / 2), sp = std::sin(pitch / 2);
+            double cr = std::cos(roll / 2), sr = std::sin(roll / 2);
+            return Quaternion(cr * cp * cy + sr * sp * sy,
+                              sr * cp * cy - cr * sp * sy,
+                              cr * sp * cy + sr * cp * sy,
+                              cr * cp * sy - sr * sp * cy);
+        }
+
+        /// Hamilton product a * b.
+        static Quaternion Multiply(const Quaternion &a, const Quaternion &b) {
+            return Quaternion(a(0) * b(0) - a(1) * b(1) - a(2) * b(2) - a(3) * b(3),
+                              a(0) * b(1) + a(1) * b(0) + a(2) * b(3) - a(3) * b(2),
+                              a(0) * b(2) - a(1) * b(3) + a(2) * b(0) + a(3) * b(1),
+                              a(0) * b(3) + a(1) * b(2) - a(2) * b(1) + a(3) * b(0));
+        }
+
+        /**
+         * Returns the matrix L(q) such that q * p = L(q) p.
+         */
+        static Eigen::Matrix4d LeftMatrix(const Quaternion &q) {
+            return (Eigen::Matrix4d() << q(0), -q(1), -q(2), -q(3),
+                    q(1), q(0), -q(3), q(2),
+                    q(2), q(3), q(0), -q(1),
+                    q(3), -q(2), q(1), q(0)).finished();
+        }
+
+        /**
+         * Returns the matrix R(q) such that p * q = R(q) p.
+         */
+        static Eigen::Matrix4d RightMatrix(const Quaternion &q) {
+            return (Eigen::Matrix4d() << q(0), -q(1), -q(2), -q(3),
+                    q(1), q(0), q(3), -q(2),
+                    q(2), -q(3), q(0), q(1),
+                    q(3), q(2), -q(1), q(0)).finished();
+        }
+
+        /// Converts a unit quaternion to a rotation matrix.
+        static Eigen::Matrix3d QuaternionToMatrix(const Quaternion &q) {
+            double w = q(0), x = q(1), y = q(2), z = q(3);
+            Eigen::Matrix3d m;
+            m << 1 - 2 * (y * y + z * z), 2 * (x * y - z * w), 2 * (x * z + y * w),
+                    2 * (x * y + z * w), 1 - 2 * (x * x + z * z), 2 * (y * z - x * w),
+                    2 * (x * z - y * w), 2 * (y * z + x * w), 1 - 2 * (x * x + y * y);
+            return m;
+        }
+
+        /// Rotation exponential: axis-angle vector to unit quaternion.
+        static Quaternion ExpRotation(const Eigen::Vector3d &omega) {
+            double theta = omega.norm();
+            if (theta < 1e-9) {
+                Quaternion q(1, 0.5 * omega(0), 0.5 * omega(1), 0.5 * omega(2));
+                return q / q.norm();
+            }
+            double s = std::sin(0.5 * theta) / theta;
+            return Quaternion(std::cos(0.5 * theta), s * omega(0), s * omega(1),
+                              s * omega(2));
+        }
+
+        /// Rotation logarithm: unit quaternion to axis-angle vector.
+        static Eigen::Vector3d LogRotation(const Quaternion &q) {
+            // q and -q are the same rotation; pick the one with the shorter angle
+            double w = q(0) < 0 ? -q(0) : q(0);
+            Eigen::Vector3d v = q(0) < 0 ? Eigen::Vector3d(-q.tail<3>())
+                                         : Eigen::Vector3d(q.tail<3>());
+            double n = v.norm();
+            if (n < 1e-9) return 2.0 / w * v;
+            return 2.0 * std::atan2(n, w) / n * v;
+        }
+
+        /**
+         * Returns the transform reached by following a constant twist for unit
+         * time.
+         */
+        static SE3 Exp(const Tangent &twist) {
+            Eigen::Vector3d rho = twist.head<3>();
+            Eigen::Vector3d omega = twist.tail<3>();
+            return SE3(V(omega) * rho, ExpRotation(omega));
+        }
+
+        /// Inverse of Exp().
+        Tangent Log() const {
+            Eigen::Vector3d omega = LogRotation(m_rotation);
+            Tangent twist;
+            twist << VInverse(omega) * m_translation, omega;
+            return twist;
+        }
+
+        /// Returns this transform followed by (i.e. expressed in) other's frame.
+        SE3 operator*(const SE3 &other) const {
+            return SE3(*this * other.m_translation,
+                       Multiply(m_rotation, other.m_rotation));
+        }
+
+        /// Transforms a point.
+        Point operator*(const Point &p) const {
+            return Rotate(p) + m_translation;
+        }
+
+        /// Rotates a vector without translating it.
+        Point Rotate(const Point &p) const {
+            // v + 2w(u x v) + 2u x (u x v), cheaper than building the matrix
+            Eigen::Vector3d u = m_rotation.tail<3>();
+            Eigen::Vector3d t = 2.0 * Cross(u, p);
+            return p + m_rotation(0) * t + Cross(u, t);
+        }
+
+        SE3 Inverse() const {
+            Quaternion conj(m_rotation(0), -m_rotation(1), -m_rotation(2),
+                            -m_rotation(3));
+            SE3 inv(Point::Zero(), conj);
+            inv.m_translation = -inv.Rotate(m_translation);
+            return inv;
+        }
+
+        /**
+         * Interpolates along the twist between two transforms.
+         *
+         * @param t interpolation parameter in [0, 1]
+         */
+        static SE3 Interpolate(const SE3 &a, const SE3 &b, double t) {
+            return a * Exp(t * (a.Inverse() * b).Log());
+        }
+
+        /// Returns the 3x3 rotation matrix.
+        Eigen::Matrix3d Rotation() const { return QuaternionToMatrix(m_rotation); }
+
+        const Point &Translation() const { return m_translation; }
+
+        const Quaternion &Quat() const { return m_rotation; }
+
+    private:
+        /// Left Jacobian of SO(3), which maps rho to the translation.
+        static Eigen::Matrix3d V(const Eigen::Vector3d &omega) {
+            double theta = omega.norm();
+            Eigen::Matrix3d K = Skew(omega);
+            if (theta < 1e-6) {
+                return Eigen::Matrix3d::Identity() + 0.5 * K + K * K / 6.0;
+            }
+            double theta2 = theta * theta;
+            return Eigen::Matrix3d::Identity() +
+                   (1 - std::cos(theta)) / theta2 * K +
+                   (theta - std::sin(theta)) / (theta2 * theta) * K * K;
+        }
+
+        static Eigen::Matrix3d VInverse(const Eigen::Vector3d &omega) {
+            double theta = omega.norm();
+            Eigen::Matrix3d K = Skew(omega);
+            if (theta < 1e-6) {
+                return Eigen::Matrix3d::Identity() - 0.5 * K + K * K / 12.0;
+            }
+            double c = (1 - theta * std::sin(theta) / (2 * (1 - std::cos(theta)))) /
+                       (theta * theta);
+            return Eigen::Matrix3d::Identity() - 0.5 * K + c * K * K;
+        }
+
+        Point m_translation = Point::Zero();
+        Quaternion m_rotation = Quaternion(1, 0, 0, 0);
+    };
+
+}  // namespace geometry
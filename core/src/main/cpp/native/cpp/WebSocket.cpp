@@ -4,19 +4,103 @@
 
 #include "wpi/WebSocket.h"
 
+#include <zlib.h>
+
+#include <algorithm>
+#include <cstring>
+#include <deque>
 #include <random>
+#include <vector>
 
 #include "wpi/Base64.h"
+#include "wpi/Endian.h"
 #include "wpi/HttpParser.h"
 #include "wpi/SmallString.h"
 #include "wpi/SmallVector.h"
+#include "wpi/StringMap.h"
 #include "wpi/raw_uv_ostream.h"
 #include "wpi/sha1.h"
 #include "wpi/uv/Stream.h"
+#include "wpi/uv/Work.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define WPI_WS_MASK_SSE2
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define WPI_WS_MASK_NEON
+#endif
 
 using namespace wpi;
 
 namespace {
+    /**
+     * XOR len bytes of src with the 4-byte masking key, writing them to dst
+     * (which may be src).  The first byte is masked with key[phase].
+     * Sixteen bytes are masked at a time where SSE2 or NEON is available,
+     * then eight with a 64-bit word; loads and stores are unaligned, so
+     * neither pointer needs any particular alignment.
+     * @return Key phase of the byte following the last one masked.
+     */
+    size_t MaskCopy(uint8_t *dst, const uint8_t *src, size_t len,
+                    const uint8_t key[4], size_t phase) {
+        // the key rotated to start at phase, repeated; every block below is a
+        // multiple of 4 bytes, so byte i is always masked with pattern[i & 3]
+        alignas(16) uint8_t pattern[16];
+        for (size_t i = 0; i < 16; ++i) {
+            pattern[i] = key[(phase + i) & 3];
+        }
+
+        size_t i = 0;
+#if defined(WPI_WS_MASK_SSE2)
+        const __m128i k = _mm_load_si128(reinterpret_cast<const __m128i *>(pattern));
+        for (; i + 64 <= len; i += 64) {
+            auto s = reinterpret_cast<const __m128i *>(src + i);
+            auto d = reinterpret_cast<__m128i *>(dst + i);
+            __m128i a = _mm_loadu_si128(s);
+            __m128i b = _mm_loadu_si128(s + 1);
+            __m128i c = _mm_loadu_si128(s + 2);
+            __m128i e = _mm_loadu_si128(s + 3);
+            _mm_storeu_si128(d, _mm_xor_si128(a, k));
+            _mm_storeu_si128(d + 1, _mm_xor_si128(b, k));
+            _mm_storeu_si128(d + 2, _mm_xor_si128(c, k));
+            _mm_storeu_si128(d + 3, _mm_xor_si128(e, k));
+        }
+        for (; i + 16 <= len; i += 16) {
+            auto s = reinterpret_cast<const __m128i *>(src + i);
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i),
+                             _mm_xor_si128(_mm_loadu_si128(s), k));
+        }
+#elif defined(WPI_WS_MASK_NEON)
+        const uint8x16_t k = vld1q_u8(pattern);
+        for (; i + 64 <= len; i += 64) {
+            uint8x16_t a = vld1q_u8(src + i);
+            uint8x16_t b = vld1q_u8(src + i + 16);
+            uint8x16_t c = vld1q_u8(src + i + 32);
+            uint8x16_t e = vld1q_u8(src + i + 48);
+            vst1q_u8(dst + i, veorq_u8(a, k));
+            vst1q_u8(dst + i + 16, veorq_u8(b, k));
+            vst1q_u8(dst + i + 32, veorq_u8(c, k));
+            vst1q_u8(dst + i + 48, veorq_u8(e, k));
+        }
+        for (; i + 16 <= len; i += 16) {
+            vst1q_u8(dst + i, veorq_u8(vld1q_u8(src + i), k));
+        }
+#endif
+        uint64_t k64;
+        std::memcpy(&k64, pattern, sizeof(k64));
+        for (; i + 8 <= len; i += 8) {
+            uint64_t word;
+            std::memcpy(&word, src + i, sizeof(word));
+            word ^= k64;
+            std::memcpy(dst + i, &word, sizeof(word));
+        }
+        for (; i < len; ++i) {
+            dst[i] = src[i] ^ pattern[i & 3];
+        }
+        return (phase + len) & 3;
+    }
+
     class WebSocketWriteReq : public uv::WriteReq {
     public:
         explicit WebSocketWriteReq(
@@ -33,6 +117,81 @@ namespace {
         SmallVector<uv::Buffer, 4> m_bufs;
         size_t m_startUser;
     };
+
+    /**
+     * Parameters of a permessage-deflate offer or response.  Window bits are 0
+     * if absent; a client_max_window_bits offer without a value is -1.
+     */
+    struct DeflateParams {
+        bool serverNoContextTakeover = false;
+        bool clientNoContextTakeover = false;
+        int serverMaxWindowBits = 0;
+        int clientMaxWindowBits = 0;
+    };
+
+    /**
+     * Parse one element of a Sec-WebSocket-Extensions header field.
+     * @return False if it is not permessage-deflate, or has unknown, repeated
+     *         or invalid parameters.
+     */
+    bool ParseDeflate(StringRef element, DeflateParams &params) {
+        SmallVector<StringRef, 4> parts;
+        element.split(parts, ';');
+        if (!parts[0].trim().equals_lower("permessage-deflate")) {
+            return false;
+        }
+        for (auto part : makeArrayRef(parts).drop_front()) {
+            StringRef name, value;
+            std::tie(name, value) = part.split('=');
+            name = name.trim();
+            value = value.trim();
+            bool hasValue = part.find('=') != StringRef::npos;
+            // values may be quoted strings
+            if (value.size() >= 2 && value.front() == '"' && value.back() == '"') {
+                value = value.drop_front().drop_back();
+            }
+            unsigned int bits = 0;
+            if (hasValue &&
+                (value.getAsInteger(10, bits) || bits < 8 || bits > 15)) {
+                return false;
+            }
+            if (name.equals_lower("server_no_context_takeover")) {
+                if (hasValue || params.serverNoContextTakeover) {
+                    return false;
+                }
+                params.serverNoContextTakeover = true;
+            } else if (name.equals_lower("client_no_context_takeover")) {
+                if (hasValue || params.clientNoContextTakeover) {
+                    return false;
+                }
+                params.clientNoContextTakeover = true;
+            } else if (name.equals_lower("server_max_window_bits")) {
+                if (!hasValue || params.serverMaxWindowBits != 0) {
+                    return false;
+                }
+                params.serverMaxWindowBits = bits;
+            } else if (name.equals_lower("client_max_window_bits")) {
+                if (params.clientMaxWindowBits != 0) {
+                    return false;
+                }
+                params.clientMaxWindowBits = hasValue ? bits : -1;
+            } else {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // zlib does not support a raw deflate window of 8 bits
+    int ClampWindowBits(int bits) { return (std::max)(9, (std::min)(bits, 15)); }
+
+    size_t TotalSize(ArrayRef <uv::Buffer> bufs) {
+        size_t size = 0;
+        for (auto &&buf : bufs) {
+            size += buf.len;
+        }
+        return size;
+    }
 }  // namespace
 
 class WebSocket::ClientHandshakeData {
@@ -64,10 +223,220 @@ public:
     bool hasConnection = false;
     bool hasAccept = false;
     bool hasProtocol = false;
+    DeflateOptions deflate;                    // compression offered
+    bool hasExtension = false;
+    DeflateParams extension;                   // compression accepted
 
     std::weak_ptr <uv::Timer> timer;
 };
 
+class WebSocket::DeflateData {
+public:
+    struct PendingMessage {
+        uint8_t opcode;
+        SmallVector<uv::Buffer, 4> data;
+        std::function<void(MutableArrayRef < uv::Buffer > , uv::Error)> callback;
+        // data is an encoded frame from SendEncoded()
+        bool encoded = false;
+    };
+
+    /**
+     * Create compression contexts.
+     * @param options Local options
+     * @param windowBits Window bits of the compression context
+     * @param resetDeflate Whether to reset the compression context after each
+     *                     message sent (our no_context_takeover)
+     * @param resetInflate Whether to reset the decompression context after each
+     *                     message received (the peer's no_context_takeover)
+     * @return Nullptr if zlib fails to initialize
+     */
+    static std::unique_ptr <DeflateData> Create(const DeflateOptions &options,
+                                                int windowBits, bool resetDeflate,
+                                                bool resetInflate) {
+        auto data = std::make_unique<DeflateData>();
+        data->minSize = options.minSize;
+        data->offloadSize = options.offloadSize;
+        data->resetDeflate = resetDeflate;
+        data->resetInflate = resetInflate;
+        // raw deflate streams, as RFC 7692 omits the zlib header; the peer's
+        // window is at most 15 bits, so inflating with 15 accepts any of them
+        if (deflateInit2(&data->deflater, options.level, Z_DEFLATED, -windowBits,
+                         8, Z_DEFAULT_STRATEGY) != Z_OK) {
+            return nullptr;
+        }
+        data->hasDeflater = true;
+        if (inflateInit2(&data->inflater, -15) != Z_OK) {
+            return nullptr;
+        }
+        data->hasInflater = true;
+        return data;
+    }
+
+    ~DeflateData() {
+        if (hasDeflater) {
+            deflateEnd(&deflater);
+        }
+        if (hasInflater) {
+            inflateEnd(&inflater);
+        }
+    }
+
+    /**
+     * Whether a message should be compressed.  Only unfragmented data messages
+     * are; fragments are sent as they are.
+     */
+    bool ShouldDeflate(uint8_t opcode, uint64_t size) const {
+        return (opcode == (kFlagFin | kOpText) ||
+                opcode == (kFlagFin | kOpBinary)) &&
+               size >= minSize;
+    }
+
+    /**
+     * Compress a message into newly allocated buffers appended to out, without
+     * the trailing 0x00 0x00 0xff 0xff of the sync flush.  Does not touch any
+     * other state, so it can run on the thread pool.
+     */
+    void Deflate(ArrayRef <uv::Buffer> data, SmallVectorImpl <uv::Buffer> &out) {
+        uint64_t size = 0;
+        for (auto &&buf : data) {
+            size += buf.len;
+        }
+        // most messages compress into a single buffer
+        size_t chunk = (std::min)(
+                static_cast<size_t>(deflateBound(&deflater, size)) + 16, size_t{65536});
+        size_t start = out.size();
+
+        auto run = [&](int flush) {
+            do {
+                if (deflater.avail_out == 0) {
+                    out.emplace_back(uv::Buffer::Allocate(chunk));
+                    deflater.next_out = reinterpret_cast<Bytef *>(out.back().base);
+                    deflater.avail_out = chunk;
+                }
+                deflate(&deflater, flush);
+                out.back().len = chunk - deflater.avail_out;
+            } while (deflater.avail_in != 0 ||
+                     (flush == Z_SYNC_FLUSH && deflater.avail_out == 0));
+        };
+        deflater.avail_out = 0;
+        for (auto &&buf : data) {
+            if (buf.len == 0) {
+                continue;
+            }
+            deflater.next_in = reinterpret_cast<Bytef *>(buf.base);
+            deflater.avail_in = buf.len;
+            run(Z_NO_FLUSH);
+        }
+        deflater.next_in = nullptr;
+        deflater.avail_in = 0;
+        run(Z_SYNC_FLUSH);
+
+        // remove the 4-byte trailer, which may span buffers
+        size_t trailer = 4;
+        while (trailer > 0 && out.size() > start) {
+            auto &buf = out.back();
+            size_t amt = (std::min)(trailer, buf.len);
+            buf.len -= amt;
+            trailer -= amt;
+            if (buf.len == 0) {
+                buf.Deallocate();
+                out.pop_back();
+            }
+        }
+
+        if (resetDeflate) {
+            deflateReset(&deflater);
+        }
+    }
+
+    /**
+     * Decompress a frame of a compressed message, appending to inflated.
+     * @param in Frame payload
+     * @param fin Whether this is the last frame of the message
+     * @param maxSize Maximum size of inflated
+     * @return 0 on success, otherwise the close code to fail with
+     */
+    uint16_t Inflate(ArrayRef <uint8_t> in, bool fin, size_t maxSize) {
+        static const uint8_t trailer[] = {0x00, 0x00, 0xff, 0xff};
+        if (uint16_t code = InflateData(in, maxSize)) {
+            return code;
+        }
+        if (fin) {
+            if (uint16_t code = InflateData(trailer, maxSize)) {
+                return code;
+            }
+            if (resetInflate) {
+                inflateReset(&inflater);
+            }
+        }
+        return 0;
+    }
+
+    z_stream deflater{};
+    z_stream inflater{};
+    bool hasDeflater = false;
+    bool hasInflater = false;
+    bool resetDeflate = false;
+    bool resetInflate = false;
+    size_t minSize = 0;
+    size_t offloadSize = 0;
+
+    // a message is being compressed on the thread pool
+    bool busy = false;
+    // messages sent while busy, in order
+    std::deque <PendingMessage> pending;
+    // bytes being compressed on the thread pool or pending
+    size_t queuedSize = 0;
+
+    // the message being received is compressed
+    bool inflating = false;
+    // decompressed message (or fragment, if not combining fragments)
+    SmallVector<uint8_t, 0> inflated;
+
+private:
+    uint16_t InflateData(ArrayRef <uint8_t> in, size_t maxSize) {
+        inflater.next_in = const_cast<Bytef *>(in.data());
+        inflater.avail_in = in.size();
+        size_t len = inflated.size();
+        for (;;) {
+            if (len == inflated.size()) {
+                // allow one byte over the maximum to detect messages that are
+                // too large
+                if (len > maxSize) {
+                    inflated.resize(len);
+                    return 1009;
+                }
+                inflated.resize(
+                        (std::min)(maxSize + 1, (std::max)(len * 2, len + 4096)));
+            }
+            inflater.next_out = inflated.data() + len;
+            inflater.avail_out = inflated.size() - len;
+            int ret = inflate(&inflater, Z_SYNC_FLUSH);
+            len = inflated.size() - inflater.avail_out;
+            if (ret == Z_STREAM_END) {
+                // the peer ended the deflate stream; it may start a new one
+                inflateReset(&inflater);
+            } else if (ret == Z_BUF_ERROR) {
+                // no progress possible: input consumed and all output written
+                if (inflater.avail_in == 0) {
+                    break;
+                }
+                return 1007;
+            } else if (ret != Z_OK) {
+                return 1007;
+            }
+            if (inflater.avail_in == 0 && inflater.avail_out != 0) {
+                break;
+            }
+        }
+        inflated.resize(len);
+        if (len > maxSize) {
+            return 1009;
+        }
+        return 0;
+    }
+};
+
 static StringRef AcceptHash(StringRef key, SmallVectorImpl<char> &buf) {
     SHA1 hash;
     hash.Update(key);
@@ -76,6 +445,35 @@ static StringRef AcceptHash(StringRef key, SmallVectorImpl<char> &buf) {
     return Base64Encode(hash.RawFinal(hashBuf), buf);
 }
 
+class WebSocket::CoalesceData {
+public:
+    struct Message {
+        uint8_t opcode;
+        uv::Buffer data;
+    };
+
+    ~CoalesceData() {
+        for (auto &&msg : messages) {
+            msg.data.Deallocate();
+        }
+    }
+
+    // Hold data for key, replacing any message already held for it
+    void Hold(StringRef key, uint8_t opcode, uv::Buffer data) {
+        auto it = index.try_emplace(key, messages.size());
+        if (it.second) {
+            messages.push_back(Message{opcode, data});
+        } else {
+            auto &msg = messages[it.first->second];
+            msg.data.Deallocate();
+            msg = Message{opcode, data};
+        }
+    }
+
+    StringMap <size_t> index;       // key to position in messages
+    std::vector <Message> messages;  // in the order keys were first held
+};
+
 WebSocket::WebSocket(uv::Stream &stream, bool server, const private_init &)
         : m_stream{stream}, m_server{server} {
     // Connect closed and error signals to ourselves
@@ -104,13 +502,12 @@ std::shared_ptr <WebSocket> WebSocket::CreateClient(
     return ws;
 }
 
-std::shared_ptr <WebSocket> WebSocket::CreateServer(uv::Stream &stream,
-                                                    StringRef key,
-                                                    StringRef version,
-                                                    StringRef protocol) {
+std::shared_ptr <WebSocket> WebSocket::CreateServer(
+        uv::Stream &stream, StringRef key, StringRef version, StringRef protocol,
+        StringRef extensions, const DeflateOptions &deflate) {
     auto ws = std::make_shared<WebSocket>(stream, true, private_init{});
     stream.SetData(ws);
-    ws->StartServer(key, version, protocol);
+    ws->StartServer(key, version, protocol, extensions, deflate);
     return ws;
 }
 
@@ -172,6 +569,30 @@ void WebSocket::StartClient(const Twine &uri, const Twine &host,
         os << "\r\n";
     }
 
+    // permessage-deflate offer (if enabled); always offer to accept a limit
+    // on our window, which the server may or may not use
+    if (options.deflate.enable) {
+        const DeflateOptions &deflate = options.deflate;
+        os << "Sec-WebSocket-Extensions: permessage-deflate";
+        if (deflate.serverNoContextTakeover) {
+            os << "; server_no_context_takeover";
+        }
+        if (deflate.clientNoContextTakeover) {
+            os << "; client_no_context_takeover";
+        }
+        int serverBits = ClampWindowBits(deflate.serverMaxWindowBits);
+        if (serverBits < 15) {
+            os << "; server_max_window_bits=" << serverBits;
+        }
+        os << "; client_max_window_bits";
+        int clientBits = ClampWindowBits(deflate.clientMaxWindowBits);
+        if (clientBits < 15) {
+            os << '=' << clientBits;
+        }
+        os << "\r\n";
+        m_clientHandshake->deflate = deflate;
+    }
+
     // other headers
     for (auto &&header : options.extraHeaders) {
         os << header.first << ": " << header.second << "\r\n";
@@ -215,10 +636,22 @@ void WebSocket::StartClient(const Twine &uri, const Twine &host,
                     }
                     m_clientHandshake->hasAccept = true;
                 } else if (name.equals_lower("sec-websocket-extensions")) {
-                    // No extensions are supported
-                    if (!value.empty()) {
+                    // Only the permessage-deflate we offered is supported
+                    if (value.empty()) {
+                        return;
+                    }
+                    auto &hs = *m_clientHandshake;
+                    if (!hs.deflate.enable || hs.hasExtension ||
+                        !ParseDeflate(value, hs.extension) ||
+                        hs.extension.clientMaxWindowBits < 0) {
                         return Terminate(1010, "unsupported extension");
                     }
+                    // the server may limit our window, but not to one zlib can't
+                    // produce
+                    if (hs.extension.clientMaxWindowBits == 8) {
+                        return Terminate(1010, "unsupported extension parameter");
+                    }
+                    hs.hasExtension = true;
                 } else if (name.equals_lower("sec-websocket-protocol")) {
                     // Make sure it was one of the provided protocols
                     bool match = false;
@@ -242,6 +675,19 @@ void WebSocket::StartClient(const Twine &uri, const Twine &host,
              !m_clientHandshake->protocols.empty())) {
             return Terminate(1002, "invalid response");
         }
+        if (m_clientHandshake->hasExtension) {
+            auto &hs = *m_clientHandshake;
+            int bits = ClampWindowBits(hs.deflate.clientMaxWindowBits);
+            if (hs.extension.clientMaxWindowBits > 0) {
+                bits = (std::min)(bits, hs.extension.clientMaxWindowBits);
+            }
+            m_deflate = DeflateData::Create(hs.deflate, bits,
+                                            hs.extension.clientNoContextTakeover,
+                                            hs.extension.serverNoContextTakeover);
+            if (!m_deflate) {
+                return Terminate(1011, "compression unavailable");
+            }
+        }
         if (m_state == CONNECTING) {
             m_state = OPEN;
             open(m_protocol);
@@ -259,7 +705,8 @@ void WebSocket::StartClient(const Twine &uri, const Twine &host,
 }
 
 void WebSocket::StartServer(StringRef key, StringRef version,
-                            StringRef protocol) {
+                            StringRef protocol, StringRef extensions,
+                            const DeflateOptions &deflate) {
     m_protocol = protocol;
 
     // Build server response
@@ -294,6 +741,57 @@ void WebSocket::StartServer(StringRef key, StringRef version,
         os << "Sec-WebSocket-Protocol: " << protocol << "\r\n";
     }
 
+    // Accept the first permessage-deflate offer we can honor
+    SmallVector<StringRef, 2> offers;
+    if (deflate.enable) {
+        extensions.split(offers, ',', -1, false);
+    }
+    for (auto offer : offers) {
+        DeflateParams params;
+        if (!ParseDeflate(offer, params)) {
+            continue;
+        }
+        int serverBits = ClampWindowBits(deflate.serverMaxWindowBits);
+        if (params.serverMaxWindowBits != 0) {
+            if (params.serverMaxWindowBits < 9) {
+                continue;  // can't be produced by zlib
+            }
+            serverBits = (std::min)(serverBits, params.serverMaxWindowBits);
+        }
+        bool serverNoContext =
+                params.serverNoContextTakeover || deflate.serverNoContextTakeover;
+        bool clientNoContext =
+                params.clientNoContextTakeover || deflate.clientNoContextTakeover;
+        m_deflate = DeflateData::Create(deflate, serverBits, serverNoContext,
+                                        clientNoContext);
+        if (!m_deflate) {
+            break;
+        }
+
+        os << "Sec-WebSocket-Extensions: permessage-deflate";
+        if (serverNoContext) {
+            os << "; server_no_context_takeover";
+        }
+        if (clientNoContext) {
+            os << "; client_no_context_takeover";
+        }
+        if (serverBits < 15 || params.serverMaxWindowBits != 0) {
+            os << "; server_max_window_bits=" << serverBits;
+        }
+        // the client's window can only be limited if it offered to accept that
+        if (params.clientMaxWindowBits != 0) {
+            int clientBits = ClampWindowBits(deflate.clientMaxWindowBits);
+            if (params.clientMaxWindowBits > 0) {
+                clientBits = (std::min)(clientBits, params.clientMaxWindowBits);
+            }
+            if (clientBits < 15) {
+                os << "; client_max_window_bits=" << clientBits;
+            }
+        }
+        os << "\r\n";
+        break;
+    }
+
     // end headers
     os << "\r\n";
 
@@ -330,6 +828,11 @@ void WebSocket::SetClosed(uint16_t code, const Twine &reason, bool failed) {
         return;
     }
     m_state = failed ? FAILED : CLOSED;
+    if (m_deflate) {
+        // Don't leave a close frame waiting behind compression, as the
+        // connection may be shut down next
+        SendPending();
+    }
     SmallString<64> reasonBuf;
     closed(code, reason.toStringRef(reasonBuf));
 }
@@ -344,12 +847,14 @@ void WebSocket::HandleIncoming(uv::Buffer &buf, size_t size) {
         return;
     }
 
-    StringRef data{buf.base, size};
+    MutableArrayRef<uint8_t> data{reinterpret_cast<uint8_t *>(buf.base), size};
 
     // Handle connecting state (mainly on client)
     if (m_state == CONNECTING) {
         if (m_clientHandshake) {
-            data = m_clientHandshake->parser.Execute(data);
+            StringRef rest = m_clientHandshake->parser.Execute(
+                    StringRef{reinterpret_cast<char *>(data.data()), data.size()});
+            data = data.take_back(rest.size());
             // check for parser failure
             if (m_clientHandshake->parser.HasError()) {
                 return Terminate(1003, "invalid response");
@@ -373,14 +878,18 @@ void WebSocket::HandleIncoming(uv::Buffer &buf, size_t size) {
             // Need at least two bytes to determine header length
             if (m_header.size() < 2u) {
                 size_t toCopy = (std::min)(2u - m_header.size(), data.size());
-                m_header.append(data.bytes_begin(), data.bytes_begin() + toCopy);
+                m_header.append(data.begin(), data.begin() + toCopy);
                 data = data.drop_front(toCopy);
                 if (m_header.size() < 2u) {
                     return;  // need more data
                 }
 
-                // Validate RSV bits are zero
-                if ((m_header[0] & 0x70) != 0) {
+                // Validate RSV bits are zero, except RSV1 on the first frame of
+                // a compressed message
+                uint8_t rsv = m_header[0] & 0x70;
+                uint8_t opcode = m_header[0] & kOpMask;
+                if (rsv != 0 && (rsv != kFlagCompressed || !m_deflate ||
+                                 (opcode != kOpText && opcode != kOpBinary))) {
                     return Fail(1002, "nonzero RSV");
                 }
             }
@@ -411,7 +920,7 @@ void WebSocket::HandleIncoming(uv::Buffer &buf, size_t size) {
             // Need to complete header to calculate message size
             if (m_header.size() < m_headerSize) {
                 size_t toCopy = (std::min)(m_headerSize - m_header.size(), data.size());
-                m_header.append(data.bytes_begin(), data.bytes_begin() + toCopy);
+                m_header.append(data.begin(), data.begin() + toCopy);
                 data = data.drop_front(toCopy);
                 if (m_header.size() < m_headerSize) {
                     return;  // need more data
@@ -445,129 +954,176 @@ void WebSocket::HandleIncoming(uv::Buffer &buf, size_t size) {
         }
 
         if (m_frameSize != UINT64_MAX) {
-            size_t need = m_frameStart + m_frameSize - m_payload.size();
-            size_t toCopy = (std::min)(need, data.size());
-            m_payload.append(data.bytes_begin(), data.bytes_begin() + toCopy);
-            data = data.drop_front(toCopy);
-            need -= toCopy;
-            if (need == 0) {
-                // We have a complete frame
-                // If the message had masking, unmask it
-                if ((m_header[1] & kFlagMasking) != 0) {
-                    uint8_t key[4] = {
-                            m_header[m_headerSize - 4], m_header[m_headerSize - 3],
-                            m_header[m_headerSize - 2], m_header[m_headerSize - 1]};
-                    int n = 0;
-                    for (uint8_t &ch :
-                            MutableArrayRef < uint8_t > {m_payload}.slice(m_frameStart)) {
-                        ch ^= key[n++];
-                        if (n >= 4) {
-                            n = 0;
-                        }
-                    }
+            bool fin = (m_header[0] & kFlagFin) != 0;
+            uint8_t opcode = m_header[0] & kOpMask;
+            bool control = (opcode & 0x08) != 0;
+            bool compressed = false;
+            if (m_deflate && !control) {
+                if (opcode != kOpCont) {
+                    m_deflate->inflating = (m_header[0] & kFlagCompressed) != 0;
                 }
+                compressed = m_deflate->inflating;
+            }
 
-                // Handle message
-                bool fin = (m_header[0] & kFlagFin) != 0;
-                uint8_t opcode = m_header[0] & kOpMask;
-                switch (opcode) {
-                    case kOpCont:
-                        switch (m_fragmentOpcode) {
-                            case kOpText:
-                                if (!m_combineFragments || fin) {
-                                    text(StringRef{reinterpret_cast<char *>(m_payload.data()),
-                                                   m_payload.size()},
-                                         fin);
-                                }
-                                break;
-                            case kOpBinary:
-                                if (!m_combineFragments || fin) {
-                                    binary(m_payload, fin);
-                                }
-                                break;
-                            default:
-                                // no preceding message?
-                                return Fail(1002, "invalid continuation message");
-                        }
-                        if (fin) {
-                            m_fragmentOpcode = 0;
-                        }
-                        break;
-                    case kOpText:
-                        if (m_fragmentOpcode != 0) {
-                            return Fail(1002, "incomplete fragment");
-                        }
-                        if (!m_combineFragments || fin) {
-                            text(StringRef{reinterpret_cast<char *>(m_payload.data()),
-                                           m_payload.size()},
-                                 fin);
-                        }
-                        if (!fin) {
-                            m_fragmentOpcode = opcode;
-                        }
-                        break;
-                    case kOpBinary:
-                        if (m_fragmentOpcode != 0) {
-                            return Fail(1002, "incomplete fragment");
-                        }
-                        if (!m_combineFragments || fin) {
-                            binary(m_payload, fin);
-                        }
-                        if (!fin) {
-                            m_fragmentOpcode = opcode;
-                        }
-                        break;
-                    case kOpClose: {
-                        uint16_t code;
-                        StringRef reason;
-                        if (!fin) {
-                            code = 1002;
-                            reason = "cannot fragment control frames";
-                        } else if (m_payload.size() < 2) {
-                            code = 1005;
-                        } else {
-                            code = (static_cast<uint16_t>(m_payload[0]) << 8) |
-                                   static_cast<uint16_t>(m_payload[1]);
-                            reason = StringRef{reinterpret_cast<char *>(m_payload.data()),
-                                               m_payload.size()}
-                                    .drop_front(2);
-                        }
-                        // Echo the close if we didn't previously send it
-                        if (m_state != CLOSING) {
-                            SendClose(code, reason);
-                        }
-                        SetClosed(code, reason);
-                        // If we're the server, shutdown the connection.
-                        if (m_server) {
-                            Shutdown();
-                        }
-                        break;
-                    }
-                    case kOpPing:
-                        if (!fin) {
-                            return Fail(1002, "cannot fragment control frames");
-                        }
-                        ping(m_payload);
-                        break;
-                    case kOpPong:
-                        if (!fin) {
-                            return Fail(1002, "cannot fragment control frames");
-                        }
-                        pong(m_payload);
-                        break;
-                    default:
-                        return Fail(1002, "invalid message opcode");
+            // A frame contained in this read is handed out as a slice of the
+            // read buffer, unless it needs to be combined with other fragments.
+            // Otherwise it is reassembled in m_payload; control frames can
+            // arrive between fragments, so they are kept after them.  Frames
+            // of compressed messages are decompressed one at a time, so they
+            // don't need to be kept either.
+            MutableArrayRef<uint8_t> frame;
+            if (m_payload.size() == m_frameStart && data.size() >= m_frameSize &&
+                (control || compressed ||
+                 (m_frameStart == 0 && (!m_combineFragments || fin)))) {
+                frame = data.take_front(m_frameSize);
+                data = data.drop_front(m_frameSize);
+            } else {
+                if (m_payload.size() == m_frameStart) {
+                    // size the buffer for the whole frame up front; the size was
+                    // checked against the maximum message size above
+                    m_payload.reserve(m_frameStart + m_frameSize);
                 }
+                size_t need = m_frameStart + m_frameSize - m_payload.size();
+                size_t toCopy = (std::min)(need, data.size());
+                m_payload.append(data.begin(), data.begin() + toCopy);
+                data = data.drop_front(toCopy);
+                if (need != toCopy) {
+                    return;  // need more data
+                }
+                frame = MutableArrayRef<uint8_t>{m_payload}.slice(m_frameStart);
+            }
 
-                // Prepare for next message
-                m_header.clear();
-                m_headerSize = 0;
-                if (!m_combineFragments || fin) {
-                    m_payload.clear();
+            // We have a complete frame
+            // If the message had masking, unmask it (in place, which is fine
+            // for the read buffer too: the WebSocket is its only reader)
+            if ((m_header[1] & kFlagMasking) != 0) {
+                uint8_t key[4] = {
+                        m_header[m_headerSize - 4], m_header[m_headerSize - 3],
+                        m_header[m_headerSize - 2], m_header[m_headerSize - 1]};
+                MaskCopy(frame.data(), frame.data(), frame.size(), key, 0);
+            }
+
+            // The message is the frame, or all of the fragments so far if they
+            // are being combined
+            ArrayRef<uint8_t> message = frame;
+            if (compressed) {
+                uint16_t code = m_deflate->Inflate(frame, fin, m_maxMessageSize);
+                if (code == 1009) {
+                    return Fail(1009, "message too large");
+                } else if (code != 0) {
+                    return Fail(code, "invalid compressed data");
                 }
-                m_frameStart = m_payload.size();
-                m_frameSize = UINT64_MAX;
+                message = m_deflate->inflated;
+            } else if (!control && m_frameStart != 0) {
+                message = m_payload;
             }
+
+            // Handle message
+            switch (opcode) {
+                case kOpCont:
+                    switch (m_fragmentOpcode) {
+                        case kOpText:
+                            if (!m_combineFragments || fin) {
+                                text(StringRef{reinterpret_cast<const char *>(message.data()),
+                                               message.size()},
+                                     fin);
+                            }
+                            break;
+                        case kOpBinary:
+                            if (!m_combineFragments || fin) {
+                                binary(message, fin);
+                            }
+                            break;
+                        default:
+                            // no preceding message?
+                            return Fail(1002, "invalid continuation message");
+                    }
+                    if (fin) {
+                        m_fragmentOpcode = 0;
+                    }
+                    break;
+                case kOpText:
+                    if (m_fragmentOpcode != 0) {
+                        return Fail(1002, "incomplete fragment");
+                    }
+                    if (!m_combineFragments || fin) {
+                        text(StringRef{reinterpret_cast<const char *>(message.data()),
+                                       message.size()},
+                             fin);
+                    }
+                    if (!fin) {
+                        m_fragmentOpcode = opcode;
+                    }
+                    break;
+                case kOpBinary:
+                    if (m_fragmentOpcode != 0) {
+                        return Fail(1002, "incomplete fragment");
+                    }
+                    if (!m_combineFragments || fin) {
+                        binary(message, fin);
+                    }
+                    if (!fin) {
+                        m_fragmentOpcode = opcode;
+                    }
+                    break;
+                case kOpClose: {
+                    uint16_t code;
+                    StringRef reason;
+                    if (!fin) {
+                        code = 1002;
+                        reason = "cannot fragment control frames";
+                    } else if (frame.size() < 2) {
+                        code = 1005;
+                    } else {
+                        code = (static_cast<uint16_t>(frame[0]) << 8) |
+                               static_cast<uint16_t>(frame[1]);
+                        reason = StringRef{reinterpret_cast<const char *>(frame.data()),
+                                           frame.size()}
+                                .drop_front(2);
+                    }
+                    // Echo the close if we didn't previously send it
+                    if (m_state != CLOSING) {
+                        SendClose(code, reason);
+                    }
+                    SetClosed(code, reason);
+                    // If we're the server, shutdown the connection.
+                    if (m_server) {
+                        Shutdown();
+                    }
+                    break;
+                }
+                case kOpPing:
+                    if (!fin) {
+                        return Fail(1002, "cannot fragment control frames");
+                    }
+                    ping(frame);
+                    break;
+                case kOpPong:
+                    if (!fin) {
+                        return Fail(1002, "cannot fragment control frames");
+                    }
+                    pong(frame);
+                    break;
+                default:
+                    return Fail(1002, "invalid message opcode");
+            }
+
+            // Prepare for next message
+            m_header.clear();
+            m_headerSize = 0;
+            if (control || compressed) {
+                m_payload.resize(m_frameStart);
+            } else if (!m_combineFragments || fin) {
+                m_payload.clear();
+            }
+            if (compressed && (!m_combineFragments || fin)) {
+                m_deflate->inflated.clear();
+            }
+            if (compressed && fin) {
+                m_deflate->inflating = false;
+            }
+            m_frameStart = m_payload.size();
+            m_frameSize = UINT64_MAX;
         }
     }
 }
@@ -588,36 +1144,219 @@ void WebSocket::Send(
         return;
     }
 
-    auto req = std::make_shared<WebSocketWriteReq>(callback);
-    raw_uv_ostream os{req->m_bufs, 4096};
-
-    // opcode (includes FIN bit)
-    os << static_cast<unsigned char>(opcode);
+    // Pings and pongs may come between the frames of a message, so they need
+    // not wait for compression.  A close frame must follow everything sent
+    // before it, so it waits (see SetClosed()).
+    uint8_t op = opcode & kOpMask;
+    if (!m_deflate || op == kOpPing || op == kOpPong) {
+        SendFrame(opcode, data, MutableArrayRef < uv::Buffer > {}, callback);
+    } else if (m_deflate->busy || !m_deflate->pending.empty()) {
+        // Wait behind a message being compressed on the thread pool
+        m_deflate->queuedSize += TotalSize(data);
+        m_deflate->pending.push_back(DeflateData::PendingMessage{
+                opcode, {data.begin(), data.end()}, std::move(callback)});
+    } else {
+        SendDeflated(opcode, data, callback);
+    }
+    UpdateWritable();
+}
 
-    // payload length
+void WebSocket::SendDeflated(
+        uint8_t opcode, ArrayRef <uv::Buffer> data,
+        std::function<void(MutableArrayRef < uv::Buffer > , uv::Error)> callback) {
     uint64_t size = 0;
     for (auto &&buf : data) {
         size += buf.len;
     }
+    if (!m_deflate->ShouldDeflate(opcode, size)) {
+        SendFrame(opcode, data, MutableArrayRef < uv::Buffer > {}, callback);
+        return;
+    }
+
+    if (size < m_deflate->offloadSize) {
+        SmallVector<uv::Buffer, 4> compressed;
+        m_deflate->Deflate(data, compressed);
+        SendFrame(opcode | kFlagCompressed, data, compressed, callback);
+        return;
+    }
+
+    // Compress large messages on the thread pool.  The compression context is
+    // only used there until the work completes; keep this alive until then.
+    struct Work {
+        SmallVector<uv::Buffer, 4> data;
+        SmallVector<uv::Buffer, 4> compressed;
+    };
+    auto work = std::make_shared<Work>();
+    work->data.append(data.begin(), data.end());
+    m_deflate->busy = true;
+    m_deflate->queuedSize += size;
+    uv::QueueWork(
+            m_stream.GetLoopRef(),
+            [work, deflate = m_deflate.get()] {
+                deflate->Deflate(work->data, work->compressed);
+            },
+            [self = shared_from_this(), work, opcode, size, callback] {
+                self->m_deflate->busy = false;
+                self->m_deflate->queuedSize -= size;
+                if (self->m_state == FAILED || self->m_state == CLOSED) {
+                    for (auto &&buf : work->compressed) {
+                        buf.Deallocate();
+                    }
+                    callback(work->data, uv::Error{UV_ESHUTDOWN});
+                } else {
+                    self->SendFrame(opcode | kFlagCompressed, work->data,
+                                    work->compressed, callback);
+                }
+                self->SendPending();
+            });
+}
+
+void WebSocket::SendPending() {
+    // once failed or closed, nothing waits for the message being compressed:
+    // only a close frame still goes out, ahead of that message
+    bool closed = m_state == FAILED || m_state == CLOSED;
+    while ((closed || !m_deflate->busy) && !m_deflate->pending.empty()) {
+        auto msg = std::move(m_deflate->pending.front());
+        m_deflate->pending.pop_front();
+        m_deflate->queuedSize -= TotalSize(msg.data);
+        // these were accepted while open; still send them while closing
+        if (closed) {
+            if (!msg.encoded && (msg.opcode & kOpMask) == kOpClose &&
+                !m_stream.IsClosing()) {
+                SendFrame(msg.opcode, msg.data, MutableArrayRef < uv::Buffer > {},
+                          msg.callback);
+            } else {
+                msg.callback(msg.data, uv::Error{UV_ESHUTDOWN});
+            }
+        } else if (msg.encoded) {
+            m_stream.Write(msg.data, msg.callback);
+        } else {
+            SendDeflated(msg.opcode, msg.data, msg.callback);
+        }
+    }
+}
+
+void WebSocket::SendEncoded(
+        ArrayRef <uv::Buffer> frame,
+        std::function<void(MutableArrayRef < uv::Buffer > , uv::Error)> callback) {
+    if (m_state != OPEN) {
+        SmallVector<uv::Buffer, 4> bufs{frame.begin(), frame.end()};
+        callback(bufs, uv::Error{m_state == CONNECTING ? UV_EAGAIN : UV_ESHUTDOWN});
+        return;
+    }
+    // the stream only reports the write queue size when a write completes
+    auto done = [this, callback = std::move(callback)](auto bufs, uv::Error err) {
+        callback(bufs, err);
+        UpdateWritable();
+    };
+    if (m_deflate && (m_deflate->busy || !m_deflate->pending.empty())) {
+        m_deflate->queuedSize += TotalSize(frame);
+        m_deflate->pending.push_back(DeflateData::PendingMessage{
+                0, {frame.begin(), frame.end()}, std::move(done), true});
+    } else {
+        m_stream.Write(frame, std::move(done));
+    }
+    UpdateWritable();
+}
+
+void WebSocket::SendCoalesced(uint8_t opcode, StringRef key,
+                              ArrayRef <uv::Buffer> data) {
+    if (m_state != OPEN) {
+        return;
+    }
+    auto copy = uv::Buffer::Allocate(TotalSize(data));
+    char *out = copy.base;
+    for (auto &&buf : data) {
+        std::memcpy(out, buf.base, buf.len);
+        out += buf.len;
+    }
+    if (!m_writable) {
+        if (!m_coalesce) {
+            m_coalesce = std::make_unique<CoalesceData>();
+        }
+        m_coalesce->Hold(key, opcode, copy);
+        return;
+    }
+    Send(opcode, copy, [](auto bufs, uv::Error) {
+        for (auto &&buf : bufs) {
+            buf.Deallocate();
+        }
+    });
+}
+
+size_t WebSocket::GetWriteQueueSize() const {
+    return m_stream.GetWriteQueueSize() + (m_deflate ? m_deflate->queuedSize : 0);
+}
+
+void WebSocket::UpdateWritable() {
+    if (m_state != OPEN) {
+        return;
+    }
+    size_t queued = GetWriteQueueSize();
+    if (m_writable) {
+        if (queued > m_highWatermark) {
+            m_writable = false;
+        }
+        return;
+    }
+    if (queued > m_lowWatermark) {
+        return;
+    }
+    m_writable = true;
+
+    // send the held messages first; this may go over the high watermark again
+    if (m_coalesce) {
+        auto coalesce = std::move(m_coalesce);
+        for (auto &&msg : coalesce->messages) {
+            uv::Buffer data = msg.data;
+            msg.data = uv::Buffer{};
+            Send(msg.opcode, data, [](auto bufs, uv::Error) {
+                for (auto &&buf : bufs) {
+                    buf.Deallocate();
+                }
+            });
+        }
+    }
+    if (m_writable) {
+        writable();
+    }
+}
+
+size_t WebSocket::EncodeHeader(uint8_t *out, uint8_t opcode, bool masking,
+                               uint64_t size) {
+    const uint8_t mask = masking ? kFlagMasking : 0x00;
+    out[0] = opcode;
     if (size < 126) {
-        os << static_cast<unsigned char>((m_server ? 0x00 : kFlagMasking) | size);
+        out[1] = mask | size;
+        return 2;
     } else if (size <= 0xffff) {
-        os << static_cast<unsigned char>((m_server ? 0x00 : kFlagMasking) | 126);
-        const uint8_t sizeMsb[] = {static_cast<uint8_t>((size >> 8) & 0xff),
-                                   static_cast<uint8_t>(size & 0xff)};
-        os << ArrayRef<uint8_t>(sizeMsb);
+        out[1] = mask | 126;
+        support::endian::write16be(out + 2, size);
+        return 4;
     } else {
-        os << static_cast<unsigned char>((m_server ? 0x00 : kFlagMasking) | 127);
-        const uint8_t sizeMsb[] = {static_cast<uint8_t>((size >> 56) & 0xff),
-                                   static_cast<uint8_t>((size >> 48) & 0xff),
-                                   static_cast<uint8_t>((size >> 40) & 0xff),
-                                   static_cast<uint8_t>((size >> 32) & 0xff),
-                                   static_cast<uint8_t>((size >> 24) & 0xff),
-                                   static_cast<uint8_t>((size >> 16) & 0xff),
-                                   static_cast<uint8_t>((size >> 8) & 0xff),
-                                   static_cast<uint8_t>(size & 0xff)};
-        os << ArrayRef<uint8_t>(sizeMsb);
+        out[1] = mask | 127;
+        support::endian::write64be(out + 2, size);
+        return 10;
     }
+}
+
+void WebSocket::SendFrame(
+        uint8_t opcode, ArrayRef <uv::Buffer> data,
+        MutableArrayRef <uv::Buffer> compressed,
+        std::function<void(MutableArrayRef < uv::Buffer > , uv::Error)> callback) {
+    auto req = std::make_shared<WebSocketWriteReq>(callback);
+    req->finish.connect([this](uv::Error) { UpdateWritable(); });
+    raw_uv_ostream os{req->m_bufs, 4096};
+
+    // opcode (includes FIN and compressed bits) and payload length; compressed
+    // data is sent instead of the user data
+    bool isCompressed = (opcode & kFlagCompressed) != 0;
+    uint64_t size = 0;
+    for (auto &&buf : isCompressed ? ArrayRef<uv::Buffer>{compressed} : data) {
+        size += buf.len;
+    }
+    uint8_t header[10];
+    os << ArrayRef<uint8_t>(header, EncodeHeader(header, opcode, !m_server, size));
 
     // clients need to mask the input data
     if (!m_server) {
@@ -630,19 +1369,32 @@ void WebSocket::Send(
             v = dist(gen);
         }
         os << ArrayRef < uint8_t > {key, 4};
-        // copy and mask data
-        int n = 0;
-        for (auto &&buf : data) {
-            for (auto &&ch : buf.data()) {
-                os << static_cast<unsigned char>(static_cast<uint8_t>(ch) ^ key[n++]);
-                if (n >= 4) {
-                    n = 0;
-                }
+        if (isCompressed) {
+            // the compressed buffers are ours, so mask them in place
+            size_t phase = 0;
+            for (auto &&buf : compressed) {
+                auto p = reinterpret_cast<uint8_t *>(buf.base);
+                phase = MaskCopy(p, p, buf.len, key, phase);
             }
+        } else if (size != 0) {
+            // copy and mask data into a single buffer
+            auto payload = uv::Buffer::Allocate(size);
+            auto out = reinterpret_cast<uint8_t *>(payload.base);
+            size_t phase = 0;
+            for (auto &&buf : data) {
+                phase = MaskCopy(out, reinterpret_cast<const uint8_t *>(buf.base),
+                                 buf.len, key, phase);
+                out += buf.len;
+            }
+            req->m_bufs.emplace_back(payload);
         }
+    }
+
+    if (isCompressed || !m_server) {
+        // don't send the user bufs as we compressed or copied their data
+        req->m_bufs.append(compressed.begin(), compressed.end());
         req->m_startUser = req->m_bufs.size();
         req->m_bufs.append(data.begin(), data.end());
-        // don't send the user bufs as we copied their data
         m_stream.Write(ArrayRef < uv::Buffer > {req->m_bufs}.slice(0, req->m_startUser),
                        req);
     } else {
@@ -0,0 +1,182 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#include "wpi/WebSocketBroadcaster.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+#include "wpi/Signal.h"
+#include "wpi/uv/Stream.h"
+#include "wpi/uv/Timer.h"
+
+using namespace wpi;
+
+// how long a connection failed by kDisconnect may take to send its backlog
+static constexpr uv::Timer::Time kDisconnectTimeout{1000};
+
+// An encoded message: the frame header and payload in one buffer, shared by
+// all writes of it and freed after the last one completes
+class WebSocketBroadcaster::Frame {
+public:
+    Frame(uint8_t opcode, ArrayRef <uv::Buffer> data) : opcode{opcode} {
+        uint64_t size = 0;
+        for (auto &&buf : data) {
+            size += buf.len;
+        }
+        uint8_t header[10];
+        size_t headerSize = WebSocket::EncodeHeader(header, opcode, false, size);
+        frame = uv::Buffer::Allocate(headerSize + size);
+        std::memcpy(frame.base, header, headerSize);
+        char *out = frame.base + headerSize;
+        for (auto &&buf : data) {
+            std::memcpy(out, buf.base, buf.len);
+            out += buf.len;
+        }
+        payload = uv::Buffer{frame.base + headerSize, size};
+    }
+
+    ~Frame() { frame.Deallocate(); }
+
+    Frame(const Frame &) = delete;
+
+    Frame &operator=(const Frame &) = delete;
+
+    uint8_t opcode;
+    uv::Buffer frame;    // unmasked server frame
+    uv::Buffer payload;  // payload within frame
+};
+
+class WebSocketBroadcaster::Client {
+public:
+    Client(WebSocket &ws, size_t maxQueued) : ws{&ws}, maxQueued{maxQueued} {}
+
+    bool IsBacklogged(Overflow overflow) const {
+        // coalescing relies on the writable event, which follows the
+        // connection's watermarks rather than our limit
+        if (overflow == kCoalesce) {
+            return !ws->IsWritable();
+        }
+        return ws->GetWriteQueueSize() >= maxQueued;
+    }
+
+    void Write(std::shared_ptr <Frame> frame) {
+        // the frame is freed once every connection has written it
+        auto callback = [frame](auto, uv::Error) {};
+        if (ws->m_server) {
+            ws->SendEncoded(frame->frame, callback);
+        } else {
+            // clients mask each frame with a new key, so send a copy
+            ws->Send(frame->opcode, frame->payload, callback);
+        }
+    }
+
+    WebSocket *ws;  // nullptr once removed
+    size_t maxQueued;
+    std::shared_ptr <Frame> latest;  // coalesced message waiting to be sent
+    sig::ScopedConnection closedConn;
+    sig::ScopedConnection writableConn;
+};
+
+WebSocketBroadcaster::WebSocketBroadcaster(Overflow overflow, size_t maxQueued)
+        : m_overflow{overflow}, m_maxQueued{maxQueued} {}
+
+WebSocketBroadcaster::~WebSocketBroadcaster() = default;
+
+void WebSocketBroadcaster::Add(WebSocket &ws) {
+    // a connection that has closed won't emit closed again to remove it
+    if (!ws.IsOpen()) {
+        return;
+    }
+    for (auto &&client : m_clients) {
+        if (client->ws == &ws) {
+            return;
+        }
+    }
+    auto client = std::make_shared<Client>(ws, m_maxQueued);
+    client->closedConn = ws.closed.connect_connection(
+            [this, &ws](uint16_t, StringRef) { Remove(ws); });
+    if (m_overflow == kCoalesce) {
+        // send the coalesced message once the connection has drained
+        client->writableConn = ws.writable.connect_connection([c = client.get()] {
+            if (c->ws && c->latest) {
+                c->Write(std::move(c->latest));
+            }
+        });
+    }
+    m_clients.emplace_back(std::move(client));
+}
+
+void WebSocketBroadcaster::Remove(WebSocket &ws) {
+    auto it = std::find_if(m_clients.begin(), m_clients.end(),
+                           [&](const auto &client) { return client->ws == &ws; });
+    if (it == m_clients.end()) {
+        return;
+    }
+    (*it)->ws = nullptr;
+    (*it)->latest.reset();
+    // Send() erases removed clients when done
+    if (!m_sending) {
+        m_clients.erase(it);
+    }
+}
+
+size_t WebSocketBroadcaster::GetSize() const {
+    return std::count_if(m_clients.begin(), m_clients.end(),
+                         [](const auto &client) { return client->ws != nullptr; });
+}
+
+void WebSocketBroadcaster::Send(uint8_t opcode, ArrayRef <uv::Buffer> data) {
+    if (m_clients.empty()) {
+        return;
+    }
+    auto frame = std::make_shared<Frame>(opcode, data);
+
+    // Delivering may close connections, which removes them
+    m_sending = true;
+    for (size_t i = 0; i < m_clients.size(); ++i) {
+        if (m_clients[i]->ws) {
+            Deliver(*m_clients[i], frame);
+        }
+    }
+    m_sending = false;
+    m_clients.erase(
+            std::remove_if(m_clients.begin(), m_clients.end(),
+                           [](const auto &client) { return client->ws == nullptr; }),
+            m_clients.end());
+}
+
+void WebSocketBroadcaster::Deliver(Client &client,
+                                   const std::shared_ptr <Frame> &frame) {
+    if (client.IsBacklogged(m_overflow)) {
+        switch (m_overflow) {
+            case kDrop:
+                break;
+            case kCoalesce:
+                client.latest = frame;
+                break;
+            case kDisconnect: {
+                // this removes the client; the peer gets the close frame
+                // after the backlog, but the shutdown waits for that backlog,
+                // so don't let a peer that has stopped reading hold it
+                uv::Stream &stream = client.ws->GetStream();
+                std::weak_ptr<uv::Handle> weak = stream.shared_from_this();
+                client.ws->Fail(1008, "write queue full");
+                uv::Timer::SingleShot(stream.GetLoopRef(), kDisconnectTimeout,
+                                      [weak] {
+                                          auto handle = weak.lock();
+                                          if (handle && !handle->IsClosing()) {
+                                              handle->Close();
+                                          }
+                                      });
+                break;
+            }
+        }
+        return;
+    }
+    // a newer message replaces any coalesced one
+    client.latest.reset();
+    client.Write(frame);
+}
@@ -34,6 +34,12 @@ WebSocketServerHelper::WebSocketServerHelper(HttpParser &req) {
                     m_protocols.emplace_back(protocol);
                 }
             }
+        } else if (name.equals_lower("sec-websocket-extensions")) {
+            // Repeated headers add to the list, as for protocols
+            if (!m_extensions.empty()) {
+                m_extensions += ", ";
+            }
+            m_extensions += value;
         }
     });
     req.headersComplete.connect([&req, this](bool) {
@@ -107,7 +113,7 @@ WebSocketServer::WebSocketServer(uv::Stream &stream,
         auto self = shared_from_this();
 
         // Accept the upgrade
-        auto ws = m_helper.Accept(m_stream, protocol);
+        auto ws = m_helper.Accept(m_stream, protocol, m_options.deflate);
 
         // Connect the websocket open event to our connected event.
         ws->open.connect_extended([self, s = ws.get()](auto conn, StringRef) {
@@ -123,26 +123,33 @@ namespace wpi {
         }
     }
 
-    void json::json_value::destroy(value_t t) noexcept {
+    void json::json_value::destroy(value_t t, bool in_arena) noexcept {
+        // arena payloads are only destroyed; the arena releases their memory
         switch (t) {
             case value_t::object: {
                 std::allocator <object_t> alloc;
                 std::allocator_traits<decltype(alloc)>::destroy(alloc, object);
-                std::allocator_traits<decltype(alloc)>::deallocate(alloc, object, 1);
+                if (!in_arena) {
+                    std::allocator_traits<decltype(alloc)>::deallocate(alloc, object, 1);
+                }
                 break;
             }
 
             case value_t::array: {
                 std::allocator <array_t> alloc;
                 std::allocator_traits<decltype(alloc)>::destroy(alloc, array);
-                std::allocator_traits<decltype(alloc)>::deallocate(alloc, array, 1);
+                if (!in_arena) {
+                    std::allocator_traits<decltype(alloc)>::deallocate(alloc, array, 1);
+                }
                 break;
             }
 
             case value_t::string: {
                 std::allocator <std::string> alloc;
                 std::allocator_traits<decltype(alloc)>::destroy(alloc, string);
-                std::allocator_traits<decltype(alloc)>::deallocate(alloc, string, 1);
+                if (!in_arena) {
+                    std::allocator_traits<decltype(alloc)>::deallocate(alloc, string, 1);
+                }
                 break;
             }
 
@@ -533,8 +540,8 @@ namespace wpi {
             }
 
             case value_t::object: {
-                // delegate call to std::allocator<object_t>::max_size()
-                return std::allocator_traits<object_t>::max_size(*m_value.object);
+                // delegate call to object_t::max_size()
+                return m_value.object->max_size();
             }
 
             default: {
@@ -928,6 +935,12 @@ namespace wpi {
     json json::patch(const json &json_patch) const {
         // make a working copy to apply the patch to
         json result = *this;
+        result.patch_inplace(json_patch);
+        return result;
+    }
+
+    void json::patch_inplace(const json &json_patch) {
+        json &result = *this;
 
         // the valid JSON Patch operations
         enum class patch_operations {
@@ -1096,8 +1109,9 @@ namespace wpi {
                     const std::string from_path = get_value("move", "from", true);
                     json_pointer from_ptr(from_path);
 
-                    // the "from" location must exist - use at()
-                    json v = result.at(from_ptr);
+                    // the "from" location must exist - use at(); the value
+                    // is about to be removed, so take it instead of copying
+                    json v = std::move(result.at(from_ptr));
 
                     // The move operation is functionally identical to a
                     // "remove" operation on the "from" location, followed
@@ -1151,21 +1165,16 @@ namespace wpi {
                 }
             }
         }
-
-        return result;
     }
 
-    json json::diff(const json &source, const json &target,
-                    const std::string &path) {
-        // the patch
-        json result(value_t::array);
-
-        // if the values are the same, return empty patch
-        if (source == target) {
-            return result;
-        }
-
+    void json::diff_into(const json &source, const json &target,
+                         std::string &path, json &result) {
         if (source.type() != target.type()) {
+            // numbers of different types may still be equal
+            if (source == target) {
+                return;
+            }
+
             // different types: replace value
             result.push_back(
                     {
@@ -1173,98 +1182,120 @@ namespace wpi {
                             {"path",  path},
                             {"value", target}
                     });
-        } else {
-            switch (source.type()) {
-                case value_t::array: {
-                    // first pass: traverse common elements
-                    std::size_t i = 0;
-                    while (i < source.size() and i < target.size()) {
-                        // recursive call to compare array values at index i
-                        auto temp_diff = diff(source[i], target[i], path + "/" + std::to_string(i));
-                        result.insert(result.end(), temp_diff.begin(), temp_diff.end());
-                        ++i;
+            return;
+        }
+
+        const std::size_t path_len = path.size();
+        switch (source.type()) {
+            case value_t::array: {
+                // first pass: traverse common elements
+                std::size_t i = 0;
+                while (i < source.size() and i < target.size()) {
+                    // recursive call to compare array values at index i,
+                    // skipping equal elements without building their path
+                    if (not(source[i] == target[i])) {
+                        path += '/';
+                        path += std::to_string(i);
+                        diff_into(source[i], target[i], path, result);
+                        path.resize(path_len);
                     }
+                    ++i;
+                }
 
-                    // i now reached the end of at least one array
-                    // in a second pass, traverse the remaining elements
+                // i now reached the end of at least one array
+                // in a second pass, traverse the remaining elements
+
+                // remove my remaining elements, in reverse order to
+                // avoid invalid indices
+                for (std::size_t j = source.size(); j > i; --j) {
+                    result.push_back(object(
+                            {
+                                    {"op",   "remove"},
+                                    {"path", path + "/" + std::to_string(j - 1)}
+                            }));
+                }
+
+                // add other remaining elements
+                while (i < target.size()) {
+                    result.push_back(
+                            {
+                                    {"op",    "add"},
+                                    {"path",  path + "/" + std::to_string(i)},
+                                    {"value", target[i]}
+                            });
+                    ++i;
+                }
+
+                break;
+            }
+
+            case value_t::object: {
+                // first pass: traverse this object's elements
+                for (auto it = source.cbegin(); it != source.cend(); ++it) {
+                    auto other = target.find(it.key());
+                    if (other != target.end() and it.value() == *other) {
+                        // equal members produce no operations
+                        continue;
+                    }
 
-                    // remove my remaining elements
-                    const auto end_index = static_cast<difference_type>(result.size());
-                    while (i < source.size()) {
-                        // add operations in reverse order to avoid invalid
-                        // indices
-                        result.insert(result.begin() + end_index, object(
+                    // escape the key name to be used in a JSON patch
+                    path += '/';
+                    path += json_pointer::escape(it.key());
+
+                    if (other != target.end()) {
+                        // recursive call to compare object values at key it
+                        diff_into(it.value(), *other, path, result);
+                    } else {
+                        // found a key that is not in o -> remove it
+                        result.push_back(object(
                                 {
                                         {"op",   "remove"},
-                                        {"path", path + "/" + std::to_string(i)}
+                                        {"path", path}
                                 }));
-                        ++i;
                     }
+                    path.resize(path_len);
+                }
 
-                    // add other remaining elements
-                    while (i < target.size()) {
+                // second pass: traverse other object's elements
+                for (auto it = target.cbegin(); it != target.cend(); ++it) {
+                    if (source.find(it.key()) == source.end()) {
+                        // found a key that is not in this -> add it
                         result.push_back(
                                 {
                                         {"op",    "add"},
-                                        {"path",  path + "/" + std::to_string(i)},
-                                        {"value", target[i]}
+                                        {"path",  path + "/" + json_pointer::escape(it.key())},
+                                        {"value", it.value()}
                                 });
-                        ++i;
                     }
-
-                    break;
                 }
 
-                case value_t::object: {
-                    // first pass: traverse this object's elements
-                    for (auto it = source.cbegin(); it != source.cend(); ++it) {
-                        // escape the key name to be used in a JSON patch
-                        const auto key = json_pointer::escape(it.key());
-
-                        if (target.find(it.key()) != target.end()) {
-                            // recursive call to compare object values at key it
-                            auto temp_diff = diff(it.value(), target[it.key()], path + "/" + key);
-                            result.insert(result.end(), temp_diff.begin(), temp_diff.end());
-                        } else {
-                            // found a key that is not in o -> remove it
-                            result.push_back(object(
-                                    {
-                                            {"op",   "remove"},
-                                            {"path", path + "/" + key}
-                                    }));
-                        }
-                    }
-
-                    // second pass: traverse other object's elements
-                    for (auto it = target.cbegin(); it != target.cend(); ++it) {
-                        if (source.find(it.key()) == source.end()) {
-                            // found a key that is not in this -> add it
-                            const auto key = json_pointer::escape(it.key());
-                            result.push_back(
-                                    {
-                                            {"op",    "add"},
-                                            {"path",  path + "/" + key},
-                                            {"value", it.value()}
-                                    });
-                        }
-                    }
-
-                    break;
-                }
+                break;
+            }
 
-                default: {
-                    // both primitive type: replace value
+            default: {
+                // both primitive type: replace value if it changed
+                if (not(source == target)) {
                     result.push_back(
                             {
                                     {"op",    "replace"},
                                     {"path",  path},
                                     {"value", target}
                             });
-                    break;
                 }
+                break;
             }
         }
+    }
+
+    json json::diff(const json &source, const json &target,
+                    const std::string &path) {
+        // the patch
+        json result(value_t::array);
 
+        // equal subtrees are skipped by comparing them, and the operations
+        // are appended to a single patch instead of merged level by level
+        std::string cur_path = path;
+        diff_into(source, target, cur_path, result);
         return result;
     }
 
@@ -1285,4 +1316,39 @@ namespace wpi {
         }
     }
 
+    json json::merge_diff(const json &source, const json &target) {
+        // anything but an object patch replaces the value as a whole
+        if (not source.is_object() or not target.is_object()) {
+            return target;
+        }
+
+        json result(value_t::object);
+
+        // members that are gone are removed with null
+        for (auto it = source.cbegin(); it != source.cend(); ++it) {
+            if (target.find(it.key()) == target.end()) {
+                result[it.key()] = nullptr;
+            }
+        }
+
+        for (auto it = target.cbegin(); it != target.cend(); ++it) {
+            auto old = source.find(it.key());
+            if (old == source.end()) {
+                // new member
+                result[it.key()] = it.value();
+            } else if (*old == it.value()) {
+                // unchanged members are left out
+                continue;
+            } else if (old->is_object() and it.value().is_object()) {
+                // recurse into changed objects
+                result[it.key()] = merge_diff(*old, it.value());
+            } else {
+                // changed scalar or array
+                result[it.key()] = it.value();
+            }
+        }
+
+        return result;
+    }
+
 }  // namespace wpi
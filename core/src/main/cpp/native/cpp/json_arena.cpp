@@ -0,0 +1,58 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#include <cstdlib>
+
+#include "wpi/MemAlloc.h"
+#include "wpi/json.h"
+
+using namespace wpi;
+
+namespace {
+
+    constexpr std::size_t kAlign = alignof(std::max_align_t);
+
+    std::size_t AlignUp(std::size_t size) {
+        return (size + kAlign - 1) & ~(kAlign - 1);
+    }
+
+}  // namespace
+
+json_arena::~json_arena() { reset(); }
+
+void *json_arena::allocate(std::size_t size) {
+    size = AlignUp(size);
+    m_bytes += size;
+    if (static_cast<std::size_t>(m_end - m_cur) >= size) {
+        void *p = m_cur;
+        m_cur += size;
+        return p;
+    }
+
+    // Oversized requests get a block of their own so that the current block
+    // keeps serving small ones
+    std::size_t header = AlignUp(sizeof(block));
+    bool dedicated = size > m_block_size / 4;
+    std::size_t capacity = dedicated ? size : std::max(m_block_size, size);
+    auto b = static_cast<block *>(safe_malloc(header + capacity));
+    b->next = m_blocks;
+    m_blocks = b;
+    char *data = reinterpret_cast<char *>(b) + header;
+    if (!dedicated) {
+        m_cur = data + size;
+        m_end = data + capacity;
+    }
+    return data;
+}
+
+void json_arena::reset() noexcept {
+    while (m_blocks) {
+        block *next = m_blocks->next;
+        std::free(m_blocks);
+        m_blocks = next;
+    }
+    m_cur = nullptr;
+    m_end = nullptr;
+    m_bytes = 0;
+}
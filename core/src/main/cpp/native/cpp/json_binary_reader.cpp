@@ -39,6 +39,8 @@ SOFTWARE.
 
 #include "wpi/raw_istream.h"
 
+#include "json_typed_array.h"
+
 namespace wpi {
 
 /*!
@@ -50,8 +52,13 @@ namespace wpi {
         @brief create a binary reader
 
         @param[in] adapter  input adapter to read from
+        @param[in] arena    where to allocate the payloads of CBOR and
+                            MessagePack values, or nullptr for the heap
+        @param[in] keys     where to intern long object keys, or nullptr
         */
-        explicit binary_reader(raw_istream &s) : is(s) {
+        explicit binary_reader(raw_istream &s, json_arena *arena = nullptr,
+                               json_key_table *keys = nullptr)
+                : is(s), m_arena(arena), m_keys(keys) {
         }
 
         /*!
@@ -65,7 +72,7 @@ namespace wpi {
         @throw parse_error.112 if unsupported byte was read
         */
         json parse_cbor(const bool strict) {
-            const auto res = parse_cbor_internal();
+            auto res = parse_cbor_internal();
             if (strict) {
                 get();
                 expect_eof();
@@ -84,7 +91,7 @@ namespace wpi {
         @throw parse_error.112 if unsupported byte was read
         */
         json parse_msgpack(const bool strict) {
-            const auto res = parse_msgpack_internal();
+            auto res = parse_msgpack_internal();
             if (strict) {
                 get();
                 expect_eof();
@@ -103,7 +110,7 @@ namespace wpi {
         @throw parse_error.112 if unsupported byte was read
         */
         json parse_ubjson(const bool strict) {
-            const auto res = parse_ubjson_internal();
+            auto res = parse_ubjson_internal();
             if (strict) {
                 get_ignore_noop();
                 expect_eof();
@@ -111,6 +118,50 @@ namespace wpi {
             return res;
         }
 
+        /*!
+        @brief report CBOR input to a SAX handler
+
+        @param[in] sax     handler receiving the events
+        @param[in] strict  whether to expect the input to be consumed completed
+        @return whether the input was read completely (false if @a sax stopped)
+
+        @throw parse_error.110 if input ended unexpectedly or the end of file was
+                               not reached when @a strict was set to true
+        @throw parse_error.112 if unsupported byte was read
+        */
+        bool sax_parse_cbor(json_sax *sax, const bool strict) {
+            if (not sax_cbor_internal(sax)) {
+                return false;
+            }
+            if (strict) {
+                get();
+                expect_eof();
+            }
+            return true;
+        }
+
+        /*!
+        @brief report MessagePack input to a SAX handler
+
+        @param[in] sax     handler receiving the events
+        @param[in] strict  whether to expect the input to be consumed completed
+        @return whether the input was read completely (false if @a sax stopped)
+
+        @throw parse_error.110 if input ended unexpectedly or the end of file was
+                               not reached when @a strict was set to true
+        @throw parse_error.112 if unsupported byte was read
+        */
+        bool sax_parse_msgpack(json_sax *sax, const bool strict) {
+            if (not sax_msgpack_internal(sax)) {
+                return false;
+            }
+            if (strict) {
+                get();
+                expect_eof();
+            }
+            return true;
+        }
+
         /*!
         @brief determine system byte order
 
@@ -130,7 +181,194 @@ namespace wpi {
         */
         json parse_cbor_internal(const bool get_char = true);
 
-        json parse_msgpack_internal();
+        /*!
+        @param[in] get_char  whether a new character should be retrieved from the
+                             input (true, default) or whether the last read
+                             character should be considered instead
+        */
+        json parse_msgpack_internal(const bool get_char = true);
+
+        /*!
+        @brief read one CBOR value and report it to @a sax
+
+        Strings and containers are reported as they are read; scalars are
+        decoded by parse_cbor_internal().
+
+        @param[in] get_char  whether a new character should be retrieved from the
+                             input (true, default) or whether the last read
+                             character should be considered instead
+        @return false if @a sax stopped the parse
+        */
+        bool sax_cbor_internal(json_sax *sax, const bool get_char = true);
+
+        /// read one MessagePack value and report it to @a sax
+        bool sax_msgpack_internal(json_sax *sax);
+
+        template<typename NumberType>
+        bool sax_msgpack_array(json_sax *sax, const NumberType len) {
+            if (not sax->start_array()) {
+                return false;
+            }
+            json_sax *target = sax_target(sax);
+            for (NumberType i = 0; i < len; ++i) {
+                if (not sax_msgpack_internal(target)) {
+                    return false;
+                }
+            }
+            return sax->end_array();
+        }
+
+        template<typename NumberType>
+        bool sax_msgpack_object(json_sax *sax, const NumberType len) {
+            if (not sax->start_object()) {
+                return false;
+            }
+            json_sax *target = sax_target(sax);
+            for (NumberType i = 0; i < len; ++i) {
+                get();
+                if (not target->key(get_msgpack_string()) or
+                    not sax_msgpack_internal(sax_target(target))) {
+                    return false;
+                }
+            }
+            return sax->end_object();
+        }
+
+        /*!
+        @brief read the length of a CBOR array or map
+
+        @param[out] len  the number of items; unset for indefinite length
+        @return false if the container has indefinite length
+
+        @throw parse_error.112 if the length encoding is invalid
+        */
+        bool get_cbor_length(uint64_t &len);
+
+        /// report a scalar value to @a sax
+        static bool sax_scalar(json_sax *sax, const json &val);
+
+        /*!
+        @brief read the tag and byte string header of a CBOR typed array
+
+        @param[out] info  the element type
+        @param[out] len   the number of bytes of elements
+
+        @throw parse_error.110 if input ended
+        @throw parse_error.112 if the tag is not a supported typed array, it
+                               is not on a byte string of definite length, or
+                               the length is not a multiple of the element
+                               size
+        */
+        void get_cbor_typed_array(detail::typed_array &info, uint64_t &len);
+
+        /*!
+        @brief read the header of a MessagePack ext value holding an array
+
+        @param[out] info  the element type
+        @param[out] len   the number of bytes of elements
+
+        @throw parse_error.110 if input ended
+        @throw parse_error.112 if the ext type is not a supported typed array
+                               or the length is not a multiple of the
+                               element size
+        */
+        void get_msgpack_typed_array(detail::typed_array &info, uint64_t &len);
+
+        /*!
+        @brief read the elements of a typed array
+
+        The elements are read in chunks rather than all at once, so a bogus
+        length fails at the end of the input instead of allocating it.
+
+        @param[in] fn  called with each element; stops the read by returning
+                       false
+        @return false if @a fn stopped the read
+
+        @throw parse_error.110 if input has less than @a len bytes
+        */
+        template<typename Fn>
+        bool get_typed_elements(const detail::typed_array &info, uint64_t len,
+                                Fn fn) {
+            uint8_t chunk[512];
+            while (len != 0) {
+                const std::size_t n = static_cast<std::size_t>(
+                        (std::min)(len, uint64_t{sizeof(chunk) / info.size * info.size}));
+                is.read(chunk, n);
+                chars_read += n;
+                if (JSON_UNLIKELY(is.has_error())) {
+                    current = std::char_traits<char>::eof();
+                    unexpect_eof();
+                }
+                for (std::size_t i = 0; i < n; i += info.size) {
+                    if (not fn(info.element(chunk + i))) {
+                        return false;
+                    }
+                }
+                len -= n;
+            }
+            return true;
+        }
+
+        /// an empty array or object, with its payload from the arena if there is one
+        json make_container(value_t t) {
+            json result;
+            result.m_type = t;
+            if (t == value_t::object) {
+                result.m_value.object = create_in<object_t>(m_arena);
+            } else {
+                result.m_value.array = create_in<array_t>(m_arena);
+            }
+            result.m_in_arena = m_arena != nullptr;
+            return result;
+        }
+
+        /// a string, with its payload from the arena if there is one
+        json make_string(std::string &&s) {
+            json result;
+            result.m_type = value_t::string;
+            result.m_value.string = create_in<std::string>(m_arena, std::move(s));
+            result.m_in_arena = m_arena != nullptr;
+            return result;
+        }
+
+        /// read the elements of a typed array into an array
+        json get_typed_array(const detail::typed_array &info, uint64_t len) {
+            json result = make_container(value_t::array);
+            result.m_value.array->reserve(
+                    static_cast<std::size_t>((std::min)(len / info.size, uint64_t{4096})));
+            get_typed_elements(info, len, [&](json &&el) {
+                result.m_value.array->push_back(std::move(el));
+                return true;
+            });
+            return result;
+        }
+
+        /// report the elements of a typed array to @a sax as an array
+        bool sax_typed_array(json_sax *sax, const detail::typed_array &info,
+                             uint64_t len) {
+            if (not sax->start_array()) {
+                return false;
+            }
+            json_sax *target = sax_target(sax);
+            return get_typed_elements(info, len, [&](json &&el) {
+                       return sax_scalar(target, el);
+                   }) and sax->end_array();
+        }
+
+        /*!
+        @brief where to report the value announced by the last event
+
+        Returns a handler that ignores everything if @a sax asked for the value
+        to be skipped, and @a sax otherwise.
+        */
+        static json_sax *sax_target(json_sax *sax) {
+            static json_sax ignore;
+            if (not sax->m_skip) {
+                return sax;
+            }
+            sax->m_skip = false;
+            return &ignore;
+        }
 
         /*!
         @param[in] get_char  whether a new character should be retrieved from the
@@ -248,7 +486,7 @@ namespace wpi {
 
         template<typename NumberType>
         json get_cbor_array(const NumberType len) {
-            json result = value_t::array;
+            json result = make_container(value_t::array);
             std::generate_n(std::back_inserter(*result.m_value.array), len, [this]() {
                 return parse_cbor_internal();
             });
@@ -257,11 +495,12 @@ namespace wpi {
 
         template<typename NumberType>
         json get_cbor_object(const NumberType len) {
-            json result = value_t::object;
+            json result = make_container(value_t::object);
             for (NumberType i = 0; i < len; ++i) {
                 get();
                 auto key = get_cbor_string();
-                (*result.m_value.object)[key] = parse_cbor_internal();
+                emplace_member(m_keys, *result.m_value.object, key).first->second =
+                        parse_cbor_internal();
             }
             return result;
         }
@@ -281,7 +520,7 @@ namespace wpi {
 
         template<typename NumberType>
         json get_msgpack_array(const NumberType len) {
-            json result = value_t::array;
+            json result = make_container(value_t::array);
             std::generate_n(std::back_inserter(*result.m_value.array), len, [this]() {
                 return parse_msgpack_internal();
             });
@@ -290,11 +529,12 @@ namespace wpi {
 
         template<typename NumberType>
         json get_msgpack_object(const NumberType len) {
-            json result = value_t::object;
+            json result = make_container(value_t::object);
             for (NumberType i = 0; i < len; ++i) {
                 get();
                 auto key = get_msgpack_string();
-                (*result.m_value.object)[key] = parse_msgpack_internal();
+                emplace_member(m_keys, *result.m_value.object, key).first->second =
+                        parse_msgpack_internal();
             }
             return result;
         }
@@ -357,6 +597,12 @@ namespace wpi {
         /// input adapter
         raw_istream &is;
 
+        /// where to allocate the payloads of values, or nullptr for the heap
+        json_arena *const m_arena;
+
+        /// where to intern long object keys, or nullptr
+        json_key_table *const m_keys;
+
         /// the current character
         int current = std::char_traits<char>::eof();
 
@@ -491,7 +737,7 @@ namespace wpi {
             case 0x7B: // UTF-8 string (eight-byte uint64_t for n follow)
             case 0x7F: // UTF-8 string (indefinite length)
             {
-                return get_cbor_string();
+                return make_string(get_cbor_string());
             }
 
                 // array (0x00..0x17 data items follow)
@@ -544,7 +790,7 @@ namespace wpi {
 
             case 0x9F: // array (indefinite length)
             {
-                json result = value_t::array;
+                json result = make_container(value_t::array);
                 while (get() != 0xFF) {
                     result.push_back(parse_cbor_internal(false));
                 }
@@ -601,10 +847,11 @@ namespace wpi {
 
             case 0xBF: // map (indefinite length)
             {
-                json result = value_t::object;
+                json result = make_container(value_t::object);
                 while (get() != 0xFF) {
                     auto key = get_cbor_string();
-                    result[key] = parse_cbor_internal();
+                    emplace_member(m_keys, *result.m_value.object, key).first->second =
+                            parse_cbor_internal();
                 }
                 return result;
             }
@@ -664,6 +911,18 @@ namespace wpi {
                 return get_number<double>();
             }
 
+            case 0xD8: // tag (one-byte uint8_t for tag follows)
+            case 0xD9: // tag (two-byte uint16_t for tag follow)
+            case 0xDA: // tag (four-byte uint32_t for tag follow)
+            case 0xDB: // tag (eight-byte uint64_t for tag follow)
+            {
+                // only typed arrays (RFC 8746) are supported
+                detail::typed_array info;
+                uint64_t len;
+                get_cbor_typed_array(info, len);
+                return get_typed_array(info, len);
+            }
+
             default: // anything else (0xFF is handled inside the other types)
             {
                 JSON_THROW(parse_error::create(112, chars_read,
@@ -673,8 +932,8 @@ namespace wpi {
         }
     }
 
-    json json::binary_reader::parse_msgpack_internal() {
-        switch (get()) {
+    json json::binary_reader::parse_msgpack_internal(const bool get_char) {
+        switch (get_char ? get() : current) {
             // EOF
             case std::char_traits<char>::eof():
                 JSON_THROW(parse_error::create(110, chars_read, "unexpected end of input"));
@@ -883,7 +1142,7 @@ namespace wpi {
             case 0xBD:
             case 0xBE:
             case 0xBF:
-                return get_msgpack_string();
+                return make_string(get_msgpack_string());
 
             case 0xC0: // nil
                 return value_t::null;
@@ -927,7 +1186,7 @@ namespace wpi {
             case 0xD9: // str 8
             case 0xDA: // str 16
             case 0xDB: // str 32
-                return get_msgpack_string();
+                return make_string(get_msgpack_string());
 
             case 0xDC: // array 16
             {
@@ -949,6 +1208,22 @@ namespace wpi {
                 return get_msgpack_object(get_number<uint32_t>());
             }
 
+            case 0xC7: // ext 8
+            case 0xC8: // ext 16
+            case 0xC9: // ext 32
+            case 0xD4: // fixext 1
+            case 0xD5: // fixext 2
+            case 0xD6: // fixext 4
+            case 0xD7: // fixext 8
+            case 0xD8: // fixext 16
+            {
+                // only typed arrays are supported
+                detail::typed_array info;
+                uint64_t len;
+                get_msgpack_typed_array(info, len);
+                return get_typed_array(info, len);
+            }
+
                 // positive fixint
             case 0xE0:
             case 0xE1:
@@ -993,6 +1268,232 @@ namespace wpi {
         }
     }
 
+    bool json::binary_reader::sax_cbor_internal(json_sax *sax, const bool get_char) {
+        if (get_char) {
+            get();
+        }
+
+        switch (current >> 5) {
+            case 3: // UTF-8 string
+                return sax->string(get_cbor_string());
+
+            case 4: // array
+            {
+                uint64_t len;
+                const bool definite = get_cbor_length(len);
+                if (not sax->start_array()) {
+                    return false;
+                }
+                json_sax *target = sax_target(sax);
+                if (definite) {
+                    for (uint64_t i = 0; i < len; ++i) {
+                        if (not sax_cbor_internal(target)) {
+                            return false;
+                        }
+                    }
+                } else {
+                    while (get() != 0xFF) {
+                        if (not sax_cbor_internal(target, false)) {
+                            return false;
+                        }
+                    }
+                }
+                return sax->end_array();
+            }
+
+            case 5: // map
+            {
+                uint64_t len;
+                const bool definite = get_cbor_length(len);
+                if (not sax->start_object()) {
+                    return false;
+                }
+                json_sax *target = sax_target(sax);
+                for (uint64_t i = 0; definite ? i < len : get() != 0xFF; ++i) {
+                    if (definite) {
+                        get();
+                    }
+                    if (not target->key(get_cbor_string()) or
+                        not sax_cbor_internal(sax_target(target))) {
+                        return false;
+                    }
+                }
+                return sax->end_object();
+            }
+
+            case 6: // tag
+            {
+                detail::typed_array info;
+                uint64_t len;
+                get_cbor_typed_array(info, len);
+                return sax_typed_array(sax, info, len);
+            }
+
+            default:
+                return sax_scalar(sax, parse_cbor_internal(false));
+        }
+    }
+
+    bool json::binary_reader::sax_msgpack_internal(json_sax *sax) {
+        get();
+
+        if (current >= 0x80 and current <= 0x8F) { // fixmap
+            return sax_msgpack_object(sax, current & 0x0F);
+        }
+        if (current >= 0x90 and current <= 0x9F) { // fixarray
+            return sax_msgpack_array(sax, current & 0x0F);
+        }
+        if (current >= 0xA0 and current <= 0xBF) { // fixstr
+            return sax->string(get_msgpack_string());
+        }
+
+        switch (current) {
+            case 0xD9: // str 8
+            case 0xDA: // str 16
+            case 0xDB: // str 32
+                return sax->string(get_msgpack_string());
+
+            case 0xDC: // array 16
+                return sax_msgpack_array(sax, get_number<uint16_t>());
+
+            case 0xDD: // array 32
+                return sax_msgpack_array(sax, get_number<uint32_t>());
+
+            case 0xDE: // map 16
+                return sax_msgpack_object(sax, get_number<uint16_t>());
+
+            case 0xDF: // map 32
+                return sax_msgpack_object(sax, get_number<uint32_t>());
+
+            case 0xC7: // ext 8
+            case 0xC8: // ext 16
+            case 0xC9: // ext 32
+            case 0xD4: // fixext 1
+            case 0xD5: // fixext 2
+            case 0xD6: // fixext 4
+            case 0xD7: // fixext 8
+            case 0xD8: // fixext 16
+            {
+                detail::typed_array info;
+                uint64_t len;
+                get_msgpack_typed_array(info, len);
+                return sax_typed_array(sax, info, len);
+            }
+
+            default:
+                return sax_scalar(sax, parse_msgpack_internal(false));
+        }
+    }
+
+    bool json::binary_reader::get_cbor_length(uint64_t &len) {
+        switch (current & 0x1F) {
+            case 0x18: // one-byte uint8_t for n follows
+                len = get_number<uint8_t>();
+                return true;
+
+            case 0x19: // two-byte uint16_t for n follow
+                len = get_number<uint16_t>();
+                return true;
+
+            case 0x1A: // four-byte uint32_t for n follow
+                len = get_number<uint32_t>();
+                return true;
+
+            case 0x1B: // eight-byte uint64_t for n follow
+                len = get_number<uint64_t>();
+                return true;
+
+            case 0x1F: // indefinite length
+                return false;
+
+            default: {
+                if (JSON_UNLIKELY((current & 0x1F) > 0x17)) {
+                    JSON_THROW(parse_error::create(112, chars_read,
+                                                   "error reading CBOR; last byte: 0x" +
+                                                   Twine::utohexstr(current)));
+                }
+                len = current & 0x1F;
+                return true;
+            }
+        }
+    }
+
+    void json::binary_reader::get_cbor_typed_array(detail::typed_array &info,
+                                                    uint64_t &len) {
+        const int tag_byte = current;
+        const std::size_t tag_pos = chars_read;
+        uint64_t tag;
+        if (JSON_UNLIKELY(not get_cbor_length(tag) or
+                          not detail::typed_array::describe(tag, info))) {
+            JSON_THROW(parse_error::create(112, tag_pos,
+                                           "error reading CBOR; last byte: 0x" +
+                                           Twine::utohexstr(tag_byte)));
+        }
+
+        get();
+        unexpect_eof();
+        if (JSON_UNLIKELY((current >> 5) != 2 or not get_cbor_length(len))) {
+            JSON_THROW(parse_error::create(112, chars_read,
+                                           "expected a CBOR byte string for typed array; last byte: 0x" +
+                                           Twine::utohexstr(current)));
+        }
+        if (JSON_UNLIKELY(len % info.size != 0)) {
+            JSON_THROW(parse_error::create(112, chars_read,
+                                           "CBOR typed array length " + Twine(len) +
+                                           " is not a multiple of " + Twine(static_cast<unsigned>(info.size))));
+        }
+    }
+
+    void json::binary_reader::get_msgpack_typed_array(detail::typed_array &info,
+                                                       uint64_t &len) {
+        switch (current) {
+            case 0xC7: // ext 8
+                len = get_number<uint8_t>();
+                break;
+            case 0xC8: // ext 16
+                len = get_number<uint16_t>();
+                break;
+            case 0xC9: // ext 32
+                len = get_number<uint32_t>();
+                break;
+            default: // fixext 1..16
+                len = uint64_t{1} << (current - 0xD4);
+                break;
+        }
+
+        get();
+        unexpect_eof();
+        if (JSON_UNLIKELY(not detail::typed_array::describe(current, info))) {
+            JSON_THROW(parse_error::create(112, chars_read,
+                                           "error reading MessagePack; unsupported ext type 0x" +
+                                           Twine::utohexstr(current)));
+        }
+        if (JSON_UNLIKELY(len % info.size != 0)) {
+            JSON_THROW(parse_error::create(112, chars_read,
+                                           "MessagePack typed array length " + Twine(len) +
+                                           " is not a multiple of " + Twine(static_cast<unsigned>(info.size))));
+        }
+    }
+
+    bool json::binary_reader::sax_scalar(json_sax *sax, const json &val) {
+        switch (val.m_type) {
+            case value_t::null:
+                return sax->null();
+            case value_t::boolean:
+                return sax->boolean(val.m_value.boolean);
+            case value_t::number_integer:
+                return sax->number_integer(val.m_value.number_integer);
+            case value_t::number_unsigned:
+                return sax->number_unsigned(val.m_value.number_unsigned);
+            case value_t::number_float:
+                return sax->number_float(val.m_value.number_float);
+            case value_t::string:
+                return sax->string(*val.m_value.string);
+            default:
+                return true;
+        }
+    }
+
     std::string json::binary_reader::get_cbor_string() {
         unexpect_eof();
 
@@ -1278,12 +1779,14 @@ namespace wpi {
             if (size_and_type.second != 0) {
                 for (size_t i = 0; i < size_and_type.first; ++i) {
                     auto key = get_ubjson_string();
-                    (*result.m_value.object)[key] = get_ubjson_value(size_and_type.second);
+                    emplace_member(m_keys, *result.m_value.object, key).first->second =
+                            get_ubjson_value(size_and_type.second);
                 }
             } else {
                 for (size_t i = 0; i < size_and_type.first; ++i) {
                     auto key = get_ubjson_string();
-                    (*result.m_value.object)[key] = parse_ubjson_internal();
+                    emplace_member(m_keys, *result.m_value.object, key).first->second =
+                            parse_ubjson_internal();
                 }
             }
         } else {
@@ -1306,6 +1809,22 @@ namespace wpi {
         return from_cbor(is, strict);
     }
 
+    json json::from_cbor(ArrayRef <uint8_t> arr, json_arena &arena, const bool strict) {
+        raw_mem_istream is(arr);
+        return binary_reader(is, &arena).parse_cbor(strict);
+    }
+
+    json json::from_cbor(ArrayRef <uint8_t> arr, json_key_table &keys, const bool strict) {
+        raw_mem_istream is(arr);
+        return binary_reader(is, nullptr, &keys).parse_cbor(strict);
+    }
+
+    json json::from_cbor(ArrayRef <uint8_t> arr, json_arena &arena,
+                         json_key_table &keys, const bool strict) {
+        raw_mem_istream is(arr);
+        return binary_reader(is, &arena, &keys).parse_cbor(strict);
+    }
+
     json json::from_msgpack(raw_istream &is, const bool strict) {
         return binary_reader(is).parse_msgpack(strict);
     }
@@ -1315,6 +1834,48 @@ namespace wpi {
         return from_msgpack(is, strict);
     }
 
+    json json::from_msgpack(ArrayRef <uint8_t> arr, json_arena &arena,
+                            const bool strict) {
+        raw_mem_istream is(arr);
+        return binary_reader(is, &arena).parse_msgpack(strict);
+    }
+
+    json json::from_msgpack(ArrayRef <uint8_t> arr, json_key_table &keys,
+                            const bool strict) {
+        raw_mem_istream is(arr);
+        return binary_reader(is, nullptr, &keys).parse_msgpack(strict);
+    }
+
+    json json::from_msgpack(ArrayRef <uint8_t> arr, json_arena &arena,
+                            json_key_table &keys, const bool strict) {
+        raw_mem_istream is(arr);
+        return binary_reader(is, &arena, &keys).parse_msgpack(strict);
+    }
+
+    bool json::sax_parse_cbor(ArrayRef <uint8_t> arr, json_sax *sax,
+                              const bool strict) {
+        raw_mem_istream is(arr);
+        JSON_TRY {
+            return binary_reader(is).sax_parse_cbor(sax, strict);
+        }
+        JSON_CATCH(parse_error & e) {
+            sax->parse_error(e.byte, StringRef(), e);
+            return false;
+        }
+    }
+
+    bool json::sax_parse_msgpack(ArrayRef <uint8_t> arr, json_sax *sax,
+                                 const bool strict) {
+        raw_mem_istream is(arr);
+        JSON_TRY {
+            return binary_reader(is).sax_parse_msgpack(sax, strict);
+        }
+        JSON_CATCH(parse_error & e) {
+            sax->parse_error(e.byte, StringRef(), e);
+            return false;
+        }
+    }
+
     json json::from_ubjson(raw_istream &is, const bool strict) {
         return binary_reader(is).parse_ubjson(strict);
     }
@@ -0,0 +1,824 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#define WPI_JSON_IMPLEMENTATION
+
+#include "wpi/json_binary_view.h"
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#include "wpi/Endian.h"
+#include "wpi/SmallString.h"
+#include "wpi/SmallVector.h"
+
+#include "json_typed_array.h"
+
+using namespace wpi;
+
+namespace {
+
+    using value_t = json::value_t;
+    using namespace support::endian;
+
+    /// remaining-items marker for CBOR containers of indefinite length
+    constexpr uint64_t kIndefinite = std::numeric_limits<uint64_t>::max();
+
+    /// throw unless @a n bytes are available at @a p
+    void need(const uint8_t *base, const uint8_t *p, const uint8_t *end,
+              uint64_t n) {
+        if (JSON_UNLIKELY(static_cast<uint64_t>(end - p) < n)) {
+            JSON_THROW(detail::parse_error::create(110, end - base + 1,
+                                                   "unexpected end of input"));
+        }
+    }
+
+    [[noreturn]] void unsupported(const uint8_t *base, const uint8_t *p,
+                                  const char *format_name) {
+        JSON_THROW(detail::parse_error::create(
+                112, p - base + 1,
+                Twine("error reading ") + format_name + "; last byte: 0x" +
+                Twine::utohexstr(*p)));
+    }
+
+    /*!
+    @brief read the argument of the CBOR header at @a pos: the count, length
+           or value it describes
+
+    @return the position after the header
+    */
+    const uint8_t *cbor_argument(const uint8_t *base, const uint8_t *pos,
+                                 const uint8_t *end, uint64_t &arg,
+                                 bool &indefinite) {
+        const uint8_t *p = pos + 1;
+        arg = *pos & 0x1F;
+        indefinite = false;
+        switch (arg) {
+            case 24:
+                need(base, p, end, 1);
+                arg = *p;
+                return p + 1;
+            case 25:
+                need(base, p, end, 2);
+                arg = read16be(p);
+                return p + 2;
+            case 26:
+                need(base, p, end, 4);
+                arg = read32be(p);
+                return p + 4;
+            case 27:
+                need(base, p, end, 8);
+                arg = read64be(p);
+                return p + 8;
+            case 31:
+                indefinite = true;
+                return p;
+            default:
+                if (arg > 23) {
+                    unsupported(base, pos, "CBOR");
+                }
+                return p;
+        }
+    }
+
+    /// the element type of a typed array read by decode()
+    detail::typed_array typed_info(uint8_t tag) {
+        detail::typed_array info;
+        detail::typed_array::describe(tag, info);
+        return info;
+    }
+
+    float read_float(const uint8_t *p) {
+        uint32_t bits = read32be(p);
+        float val;
+        std::memcpy(&val, &bits, sizeof(val));
+        return val;
+    }
+
+    double read_double(const uint8_t *p) {
+        uint64_t bits = read64be(p);
+        double val;
+        std::memcpy(&val, &bits, sizeof(val));
+        return val;
+    }
+
+    const char *type_name(value_t t) {
+        switch (t) {
+            case value_t::null:
+                return "null";
+            case value_t::object:
+                return "object";
+            case value_t::array:
+                return "array";
+            case value_t::string:
+                return "string";
+            case value_t::boolean:
+                return "boolean";
+            case value_t::discarded:
+                return "discarded";
+            default:
+                return "number";
+        }
+    }
+
+}  // namespace
+
+json_binary_view::scalar json_binary_view::decode(const uint8_t *pos) const {
+    scalar s;
+    s.type = value_t::discarded;
+    s.length = 0;
+    s.indefinite = false;
+    s.typed = 0;
+    s.data = pos;
+    s.unsigned_integer = 0;
+    if (not pos) {
+        return s;
+    }
+
+    if (m_element != 0) {
+        // an element of a typed array
+        detail::typed_array info = typed_info(m_element);
+        json val = info.element(pos);
+        s.type = val.type();
+        switch (s.type) {
+            case value_t::number_integer:
+                s.integer = val.get<int64_t>();
+                break;
+            case value_t::number_unsigned:
+                s.unsigned_integer = val.get<uint64_t>();
+                break;
+            default:
+                s.floating = val.get<double>();
+                break;
+        }
+        s.data = pos + info.size;
+        return s;
+    }
+
+    need(m_base, pos, m_end, 1);
+    const uint8_t byte = *pos;
+
+    if (m_format == format::cbor) {
+        uint64_t arg;
+        const uint8_t *p = cbor_argument(m_base, pos, m_end, arg, s.indefinite);
+
+        switch (byte >> 5) {
+            case 0: // unsigned integer
+                if (s.indefinite) {
+                    unsupported(m_base, pos, "CBOR");
+                }
+                s.type = value_t::number_unsigned;
+                s.unsigned_integer = arg;
+                break;
+
+            case 1: // negative integer
+                if (s.indefinite) {
+                    unsupported(m_base, pos, "CBOR");
+                }
+                s.type = value_t::number_integer;
+                s.integer = static_cast<int64_t>(-1) - static_cast<int64_t>(arg);
+                break;
+
+            case 3: // UTF-8 string
+                s.type = value_t::string;
+                if (not s.indefinite) {
+                    need(m_base, p, m_end, arg);
+                    s.length = arg;
+                }
+                break;
+
+            case 4: // array
+                s.type = value_t::array;
+                s.length = s.indefinite ? 0 : arg;
+                break;
+
+            case 5: // map
+                s.type = value_t::object;
+                s.length = s.indefinite ? 0 : arg;
+                break;
+
+            case 7: // simple values and floats
+                switch (byte) {
+                    case 0xF4:
+                        s.type = value_t::boolean;
+                        s.boolean = false;
+                        break;
+                    case 0xF5:
+                        s.type = value_t::boolean;
+                        s.boolean = true;
+                        break;
+                    case 0xF6:
+                        s.type = value_t::null;
+                        break;
+                    case 0xF9:
+                        s.type = value_t::number_float;
+                        s.floating = detail::typed_array::half(static_cast<uint16_t>(arg));
+                        break;
+                    case 0xFA: {
+                        s.type = value_t::number_float;
+                        uint32_t bits = static_cast<uint32_t>(arg);
+                        float val;
+                        std::memcpy(&val, &bits, sizeof(val));
+                        s.floating = val;
+                        break;
+                    }
+                    case 0xFB:
+                        s.type = value_t::number_float;
+                        std::memcpy(&s.floating, &arg, sizeof(s.floating));
+                        break;
+                    default:
+                        unsupported(m_base, pos, "CBOR");
+                }
+                break;
+
+            case 6: { // tag; only typed arrays (RFC 8746) are supported
+                detail::typed_array info;
+                if (s.indefinite or not detail::typed_array::describe(arg, info)) {
+                    unsupported(m_base, pos, "CBOR");
+                }
+                need(m_base, p, m_end, 1);
+                const uint8_t *str = p;
+                p = cbor_argument(m_base, str, m_end, arg, s.indefinite);
+                if (JSON_UNLIKELY((*str >> 5) != 2 or s.indefinite)) {
+                    JSON_THROW(detail::parse_error::create(
+                            112, str - m_base + 1,
+                            "expected a CBOR byte string for typed array; last byte: 0x" +
+                            Twine::utohexstr(*str)));
+                }
+                if (JSON_UNLIKELY(arg % info.size != 0)) {
+                    JSON_THROW(detail::parse_error::create(
+                            112, p - m_base,
+                            "CBOR typed array length " + Twine(arg) +
+                            " is not a multiple of " + Twine(static_cast<unsigned>(info.size))));
+                }
+                need(m_base, p, m_end, arg);
+                s.type = value_t::array;
+                s.length = arg / info.size;
+                s.typed = info.tag;
+                break;
+            }
+
+            default: // byte strings
+                unsupported(m_base, pos, "CBOR");
+        }
+        s.data = p;
+        return s;
+    }
+
+    // MessagePack
+    const uint8_t *p = pos + 1;
+    if (byte <= 0x7F) { // positive fixint
+        s.type = value_t::number_unsigned;
+        s.unsigned_integer = byte;
+    } else if (byte <= 0x8F) { // fixmap
+        s.type = value_t::object;
+        s.length = byte & 0x0F;
+    } else if (byte <= 0x9F) { // fixarray
+        s.type = value_t::array;
+        s.length = byte & 0x0F;
+    } else if (byte <= 0xBF) { // fixstr
+        s.type = value_t::string;
+        s.length = byte & 0x1F;
+    } else if (byte >= 0xE0) { // negative fixint
+        s.type = value_t::number_integer;
+        s.integer = static_cast<int8_t>(byte);
+    } else {
+        // the size of the big-endian field following the type byte
+        static const uint8_t kFieldSize[0x20] = {
+                0, 0, 0, 0, 0, 0, 0, 1, 2, 4, 4, 8, 1, 2, 4, 8,  // 0xC0..0xCF
+                1, 2, 4, 8, 0, 0, 0, 0, 0, 1, 2, 4, 2, 4, 2, 4   // 0xD0..0xDF
+        };
+        const uint8_t size = kFieldSize[byte - 0xC0];
+        need(m_base, p, m_end, size);
+        uint64_t field = 0;
+        switch (size) {
+            case 1:
+                field = *p;
+                break;
+            case 2:
+                field = read16be(p);
+                break;
+            case 4:
+                field = read32be(p);
+                break;
+            case 8:
+                field = read64be(p);
+                break;
+        }
+        p += size;
+
+        switch (byte) {
+            case 0xC0:
+                s.type = value_t::null;
+                break;
+            case 0xC2:
+            case 0xC3:
+                s.type = value_t::boolean;
+                s.boolean = byte == 0xC3;
+                break;
+            case 0xCA:
+                s.type = value_t::number_float;
+                s.floating = read_float(p - 4);
+                break;
+            case 0xCB:
+                s.type = value_t::number_float;
+                s.floating = read_double(p - 8);
+                break;
+            case 0xCC:
+            case 0xCD:
+            case 0xCE:
+            case 0xCF:
+                s.type = value_t::number_unsigned;
+                s.unsigned_integer = field;
+                break;
+            case 0xD0:
+                s.type = value_t::number_integer;
+                s.integer = static_cast<int8_t>(field);
+                break;
+            case 0xD1:
+                s.type = value_t::number_integer;
+                s.integer = static_cast<int16_t>(field);
+                break;
+            case 0xD2:
+                s.type = value_t::number_integer;
+                s.integer = static_cast<int32_t>(field);
+                break;
+            case 0xD3:
+                s.type = value_t::number_integer;
+                s.integer = static_cast<int64_t>(field);
+                break;
+            case 0xD9:
+            case 0xDA:
+            case 0xDB:
+                s.type = value_t::string;
+                s.length = field;
+                break;
+            case 0xDC:
+            case 0xDD:
+                s.type = value_t::array;
+                s.length = field;
+                break;
+            case 0xDE:
+            case 0xDF:
+                s.type = value_t::object;
+                s.length = field;
+                break;
+            case 0xC7:
+            case 0xC8:
+            case 0xC9:
+            case 0xD4:
+            case 0xD5:
+            case 0xD6:
+            case 0xD7:
+            case 0xD8: { // ext; only typed arrays are supported
+                if (byte >= 0xD4) {
+                    field = uint64_t{1} << (byte - 0xD4);
+                }
+                need(m_base, p, m_end, 1);
+                detail::typed_array info;
+                if (JSON_UNLIKELY(not detail::typed_array::describe(*p, info))) {
+                    JSON_THROW(detail::parse_error::create(
+                            112, p - m_base + 1,
+                            "error reading MessagePack; unsupported ext type 0x" +
+                            Twine::utohexstr(*p)));
+                }
+                if (JSON_UNLIKELY(field % info.size != 0)) {
+                    JSON_THROW(detail::parse_error::create(
+                            112, p - m_base + 1,
+                            "MessagePack typed array length " + Twine(field) +
+                            " is not a multiple of " + Twine(static_cast<unsigned>(info.size))));
+                }
+                ++p;
+                need(m_base, p, m_end, field);
+                s.type = value_t::array;
+                s.length = field / info.size;
+                s.typed = info.tag;
+                break;
+            }
+            default: // bin and reserved
+                unsupported(m_base, pos, "MessagePack");
+        }
+    }
+    if (s.type == value_t::string) {
+        need(m_base, p, m_end, s.length);
+    }
+    s.data = p;
+    return s;
+}
+
+const uint8_t *json_binary_view::step(const uint8_t *pos,
+                                      uint64_t &children) const {
+    children = 0;
+    if (m_element != 0) {
+        return pos + typed_info(m_element).size;
+    }
+    need(m_base, pos, m_end, 1);
+    const uint8_t byte = *pos;
+    const uint8_t *p = pos + 1;
+
+    // the common encodings are measured without a full decode()
+    if (m_format == format::cbor) {
+        const uint8_t major = byte >> 5;
+        const uint8_t info = byte & 0x1F;
+        if (info <= 27 and major != 2 and major != 6 and
+            (major != 7 or (byte >= 0xF4 and byte <= 0xF6) or
+             (byte >= 0xF9 and byte <= 0xFB))) {
+            uint64_t arg = info;
+            if (info >= 24) {
+                const unsigned size = 1u << (info - 24);
+                need(m_base, p, m_end, size);
+                switch (size) {
+                    case 1:
+                        arg = *p;
+                        break;
+                    case 2:
+                        arg = read16be(p);
+                        break;
+                    case 4:
+                        arg = read32be(p);
+                        break;
+                    default:
+                        arg = read64be(p);
+                        break;
+                }
+                p += size;
+            }
+            switch (major) {
+                case 3:
+                    need(m_base, p, m_end, arg);
+                    return p + arg;
+                case 4:
+                case 5:
+                    // every item takes at least a byte; this also keeps the
+                    // doubled member count from overflowing
+                    need(m_base, p, m_end, arg);
+                    children = major == 5 ? arg * 2 : arg;
+                    return p;
+                default:
+                    return p;
+            }
+        }
+        if (info == 31 and major >= 3 and major <= 5) {
+            children = kIndefinite;
+            return p;
+        }
+    } else {
+        if (byte <= 0x7F or byte >= 0xE0) { // fixint
+            return p;
+        }
+        if (byte <= 0x8F) { // fixmap
+            children = (byte & 0x0F) * 2;
+            return p;
+        }
+        if (byte <= 0x9F) { // fixarray
+            children = byte & 0x0F;
+            return p;
+        }
+        if (byte <= 0xBF) { // fixstr
+            need(m_base, p, m_end, byte & 0x1F);
+            return p + (byte & 0x1F);
+        }
+    }
+
+    // everything else, including the errors
+    scalar s = decode(pos);
+    if (s.typed != 0) {
+        return s.data + s.length * typed_info(s.typed).size;
+    }
+    switch (s.type) {
+        case value_t::string:
+            return s.data + s.length;
+        case value_t::array:
+        case value_t::object:
+            need(m_base, s.data, m_end, s.length);
+            children = s.type == value_t::object ? s.length * 2 : s.length;
+            return s.data;
+        default:
+            return s.data;
+    }
+}
+
+const uint8_t *json_binary_view::skip(const uint8_t *pos) const {
+    // items left in the innermost open container, and in the ones around it;
+    // the value at pos is the one item of an outermost pseudo-container
+    uint64_t left = 1;
+    SmallVector<uint64_t, 16> outer;
+    const uint8_t *p = pos;
+    for (;;) {
+        if (left == kIndefinite) {
+            need(m_base, p, m_end, 1);
+            if (*p == 0xFF) {
+                ++p;
+                left = 0;
+            }
+        }
+        if (left == 0) {
+            if (outer.empty()) {
+                return p;
+            }
+            left = outer.pop_back_val();
+            continue;
+        }
+        if (left != kIndefinite) {
+            --left;
+        }
+
+        uint64_t children;
+        p = step(p, children);
+        if (children != 0) {
+            outer.push_back(left);
+            left = children;
+        }
+    }
+}
+
+const uint8_t *json_binary_view::match_key(const uint8_t *pos, StringRef key,
+                                           bool &match) const {
+    scalar s = decode(pos);
+    if (JSON_UNLIKELY(s.type != value_t::string)) {
+        JSON_THROW(detail::parse_error::create(
+                113, pos - m_base + 1,
+                Twine("expected a ") +
+                (m_format == format::cbor ? "CBOR" : "MessagePack") +
+                " string; last byte: 0x" + Twine::utohexstr(*pos)));
+    }
+    if (s.indefinite) {
+        match = view_at(pos).get_string() == key;
+        return skip(pos);
+    }
+    match = s.length == key.size() and
+            (key.empty() or std::memcmp(s.data, key.data(), key.size()) == 0);
+    return s.data + s.length;
+}
+
+json_binary_view json_binary_view::find(StringRef key) const {
+    scalar s = decode(m_pos);
+    if (s.type != value_t::object) {
+        return json_binary_view();
+    }
+    const uint8_t *p = s.data;
+    for (uint64_t i = 0; s.indefinite or i < s.length; ++i) {
+        if (s.indefinite) {
+            need(m_base, p, m_end, 1);
+            if (*p == 0xFF) {
+                break;
+            }
+        }
+        bool match;
+        p = match_key(p, key, match);
+        if (match) {
+            return view_at(p);
+        }
+        p = skip(p);
+    }
+    return json_binary_view();
+}
+
+json_binary_view json_binary_view::element(std::size_t index) const {
+    scalar s = decode(m_pos);
+    if (s.type != value_t::array or (not s.indefinite and index >= s.length)) {
+        return json_binary_view();
+    }
+    if (s.typed != 0) {
+        return json_binary_view(m_format, m_base,
+                                s.data + index * typed_info(s.typed).size, m_end,
+                                s.typed);
+    }
+    const uint8_t *p = s.data;
+    for (std::size_t i = 0;; ++i) {
+        if (s.indefinite) {
+            need(m_base, p, m_end, 1);
+            if (*p == 0xFF) {
+                return json_binary_view();
+            }
+        }
+        if (i == index) {
+            return view_at(p);
+        }
+        p = skip(p);
+    }
+}
+
+json::value_t json_binary_view::type() const { return decode(m_pos).type; }
+
+std::size_t json_binary_view::size() const {
+    scalar s = decode(m_pos);
+    switch (s.type) {
+        case value_t::null:
+        case value_t::discarded:
+            return 0;
+        case value_t::array:
+        case value_t::object:
+            if (s.indefinite) {
+                return std::distance(begin(), end());
+            }
+            return s.length;
+        default:
+            return 1;
+    }
+}
+
+json_binary_view json_binary_view::operator[](StringRef key) const {
+    return find(key);
+}
+
+json_binary_view json_binary_view::operator[](std::size_t index) const {
+    return element(index);
+}
+
+json_binary_view json_binary_view::at(StringRef key) const {
+    value_t t = type();
+    if (JSON_UNLIKELY(t != value_t::object)) {
+        JSON_THROW(detail::type_error::create(
+                304, Twine("cannot use at() with ") + type_name(t)));
+    }
+    json_binary_view result = find(key);
+    if (JSON_UNLIKELY(not result.valid())) {
+        JSON_THROW(detail::out_of_range::create(403, "key '" + Twine(key) +
+                                                     "' not found"));
+    }
+    return result;
+}
+
+json_binary_view json_binary_view::at(std::size_t index) const {
+    value_t t = type();
+    if (JSON_UNLIKELY(t != value_t::array)) {
+        JSON_THROW(detail::type_error::create(
+                304, Twine("cannot use at() with ") + type_name(t)));
+    }
+    json_binary_view result = element(index);
+    if (JSON_UNLIKELY(not result.valid())) {
+        JSON_THROW(detail::out_of_range::create(401, "array index " + Twine(index) +
+                                                     " is out of range"));
+    }
+    return result;
+}
+
+void json_binary_view::type_mismatch(const char *expected) const {
+    JSON_THROW(detail::type_error::create(302, Twine("type must be ") + expected +
+                                               ", but is " + type_name(type())));
+}
+
+bool json_binary_view::get_boolean() const {
+    scalar s = decode(m_pos);
+    if (JSON_UNLIKELY(s.type != value_t::boolean)) {
+        type_mismatch("boolean");
+    }
+    return s.boolean;
+}
+
+json_binary_view::scalar json_binary_view::get_number() const {
+    scalar s = decode(m_pos);
+    if (JSON_UNLIKELY(s.type != value_t::number_integer and
+                      s.type != value_t::number_unsigned and
+                      s.type != value_t::number_float)) {
+        type_mismatch("number");
+    }
+    return s;
+}
+
+StringRef json_binary_view::get_string_ref() const {
+    scalar s = decode(m_pos);
+    if (JSON_UNLIKELY(s.type != value_t::string)) {
+        type_mismatch("string");
+    }
+    if (JSON_UNLIKELY(s.indefinite)) {
+        type_mismatch("definite-length string");
+    }
+    return StringRef(reinterpret_cast<const char *>(s.data), s.length);
+}
+
+std::string json_binary_view::get_string() const {
+    scalar s = decode(m_pos);
+    if (JSON_UNLIKELY(s.type != value_t::string)) {
+        type_mismatch("string");
+    }
+    if (not s.indefinite) {
+        return std::string(reinterpret_cast<const char *>(s.data), s.length);
+    }
+    std::string result;
+    const uint8_t *p = s.data;
+    for (;;) {
+        need(m_base, p, m_end, 1);
+        if (*p == 0xFF) {
+            return result;
+        }
+        result += view_at(p).get_string_ref();
+        p = skip(p);
+    }
+}
+
+std::size_t json_binary_view::array_size() const {
+    scalar s = decode(m_pos);
+    if (JSON_UNLIKELY(s.type != value_t::array)) {
+        type_mismatch("array");
+    }
+    if (s.indefinite) {
+        return size();
+    }
+    // decode() has checked the bytes of typed arrays
+    if (s.typed == 0) {
+        need(m_base, s.data, m_end, s.length);
+    }
+    return s.length;
+}
+
+void json_binary_view::get_array(SmallVectorImpl<double> &out) const {
+    out.resize(array_size());
+    get_array(out.data());
+}
+
+void json_binary_view::get_array(std::vector<double> &out) const {
+    out.resize(array_size());
+    get_array(out.data());
+}
+
+void json_binary_view::get_array(double *out) const {
+    scalar s = decode(m_pos);
+    if (JSON_UNLIKELY(s.type != value_t::array)) {
+        type_mismatch("array");
+    }
+    if (s.typed != 0 and typed_info(s.typed).is_native_double()) {
+        // out may be null for an empty array
+        if (s.length != 0) {
+            std::memcpy(out, s.data, s.length * sizeof(double));
+        }
+        return;
+    }
+    for (auto el : *this) {
+        *out++ = el.get<double>();
+    }
+}
+
+json json_binary_view::materialize() const {
+    if (not valid()) {
+        return json(value_t::discarded);
+    }
+    if (m_element != 0) {
+        return typed_info(m_element).element(m_pos);
+    }
+    return m_format == format::cbor ? json::from_cbor(raw(), false)
+                                    : json::from_msgpack(raw(), false);
+}
+
+ArrayRef<uint8_t> json_binary_view::raw() const {
+    if (not valid()) {
+        return ArrayRef<uint8_t>();
+    }
+    return ArrayRef<uint8_t>(m_pos, skip(m_pos));
+}
+
+json_binary_view::iterator json_binary_view::begin() const {
+    scalar s = decode(m_pos);
+    if (s.type != value_t::array and s.type != value_t::object) {
+        return iterator();
+    }
+    return iterator(*this, s.data, s.length, s.indefinite,
+                    s.type == value_t::object, s.typed);
+}
+
+json_binary_view::iterator json_binary_view::end() const { return iterator(); }
+
+bool json_binary_view::iterator::at_end() const {
+    if (not m_pos) {
+        return true;
+    }
+    if (m_indefinite) {
+        need(m_container.m_base, m_pos, m_container.m_end, 1);
+        return *m_pos == 0xFF;
+    }
+    return m_left == 0;
+}
+
+StringRef json_binary_view::iterator::key() const {
+    if (not m_object) {
+        return StringRef();
+    }
+    return m_container.view_at(m_pos).get<StringRef>();
+}
+
+json_binary_view json_binary_view::iterator::value() const {
+    if (m_element != 0) {
+        return json_binary_view(m_container.m_format, m_container.m_base, m_pos,
+                                m_container.m_end, m_element);
+    }
+    return m_container.view_at(m_object ? m_container.skip(m_pos) : m_pos);
+}
+
+json_binary_view::iterator &json_binary_view::iterator::operator++() {
+    if (m_element != 0) {
+        m_pos += typed_info(m_element).size;
+        --m_left;
+        return *this;
+    }
+    m_pos = m_container.skip(m_pos);
+    if (m_object) {
+        m_pos = m_container.skip(m_pos);
+    }
+    if (not m_indefinite) {
+        --m_left;
+    }
+    return *this;
+}
@@ -37,6 +37,8 @@ SOFTWARE.
 
 #include "wpi/raw_ostream.h"
 
+#include "json_typed_array.h"
+
 namespace wpi {
 
 /*!
@@ -50,8 +52,11 @@ namespace wpi {
         @brief create a binary writer
 
         @param[in] adapter  output adapter to write to
+        @param[in] typed_arrays  whether to write arrays of floats as CBOR
+                                 typed arrays or MessagePack ext values
         */
-        explicit binary_writer(raw_ostream &s) : o(s) {
+        explicit binary_writer(raw_ostream &s, const bool typed_arrays = false)
+                : o(s), use_typed_arrays(typed_arrays) {
         }
 
         /*!
@@ -78,6 +83,18 @@ namespace wpi {
 
         void write_msgpack_string(StringRef str);
 
+        /*!
+        @brief whether to write @a arr as a typed array
+
+        Only arrays of at least two floats are packed: smaller ones are not
+        larger unpacked, and arrays mixing in integers would read back with
+        the integers turned into floats.
+        */
+        bool is_typed_array(const array_t &arr) const;
+
+        /// write the elements of a float array as little endian float64s
+        void write_typed_array(const array_t &arr);
+
         /*
         @brief write a number to output input
 
@@ -160,6 +177,9 @@ namespace wpi {
 
         /// the output
         raw_ostream &o;
+
+        /// whether to pack arrays of floats
+        const bool use_typed_arrays;
     };
 
     void json::binary_writer::write_cbor(const json &j) {
@@ -248,6 +268,30 @@ namespace wpi {
             }
 
             case value_t::array: {
+                if (is_typed_array(*j.m_value.array)) {
+                    // tag 86 (float64, little endian) on a byte string
+                    o << static_cast<CharType>(0xD8);
+                    write_number(detail::typed_array::float64_le);
+                    const uint64_t size = j.m_value.array->size() * sizeof(double);
+                    if (size <= 0x17) {
+                        write_number(static_cast<uint8_t>(0x40 + size));
+                    } else if (size <= (std::numeric_limits<uint8_t>::max)()) {
+                        o << static_cast<CharType>(0x58);
+                        write_number(static_cast<uint8_t>(size));
+                    } else if (size <= (std::numeric_limits<uint16_t>::max)()) {
+                        o << static_cast<CharType>(0x59);
+                        write_number(static_cast<uint16_t>(size));
+                    } else if (size <= (std::numeric_limits<uint32_t>::max)()) {
+                        o << static_cast<CharType>(0x5A);
+                        write_number(static_cast<uint32_t>(size));
+                    } else {
+                        o << static_cast<CharType>(0x5B);
+                        write_number(size);
+                    }
+                    write_typed_array(*j.m_value.array);
+                    break;
+                }
+
                 // step 1: write control byte and the array size
                 const auto N = j.m_value.array->size();
                 if (N <= 0x17) {
@@ -419,6 +463,32 @@ namespace wpi {
             }
 
             case value_t::array: {
+                if (is_typed_array(*j.m_value.array) and
+                    j.m_value.array->size() * sizeof(double) <=
+                    (std::numeric_limits<uint32_t>::max)()) {
+                    // ext value with the RFC 8746 tag as its type
+                    const auto size = j.m_value.array->size() * sizeof(double);
+                    if (size == 16) {
+                        // fixext 16
+                        o << static_cast<CharType>(0xD8);
+                    } else if (size <= (std::numeric_limits<uint8_t>::max)()) {
+                        // ext 8
+                        o << static_cast<CharType>(0xC7);
+                        write_number(static_cast<uint8_t>(size));
+                    } else if (size <= (std::numeric_limits<uint16_t>::max)()) {
+                        // ext 16
+                        o << static_cast<CharType>(0xC8);
+                        write_number(static_cast<uint16_t>(size));
+                    } else {
+                        // ext 32
+                        o << static_cast<CharType>(0xC9);
+                        write_number(static_cast<uint32_t>(size));
+                    }
+                    write_number(detail::typed_array::float64_le);
+                    write_typed_array(*j.m_value.array);
+                    break;
+                }
+
                 // step 1: write control byte and the array size
                 const auto N = j.m_value.array->size();
                 if (N <= 15) {
@@ -643,6 +713,29 @@ namespace wpi {
         o << str;
     }
 
+    bool json::binary_writer::is_typed_array(const array_t &arr) const {
+        return use_typed_arrays and arr.size() >= 2 and
+               std::all_of(arr.begin(), arr.end(), [](const json &el) {
+                   return el.m_type == value_t::number_float;
+               });
+    }
+
+    void json::binary_writer::write_typed_array(const array_t &arr) {
+        // stage the elements in chunks so they reach the stream in bulk;
+        // only big endian systems need to swap them
+        double chunk[64];
+        std::size_t n = 0;
+        for (const auto &el : arr) {
+            chunk[n++] = support::endian::byte_swap<double, support::little>(
+                    el.m_value.number_float);
+            if (n == 64) {
+                o.write(reinterpret_cast<const char *>(chunk), sizeof(chunk));
+                n = 0;
+            }
+        }
+        o.write(reinterpret_cast<const char *>(chunk), n * sizeof(double));
+    }
+
     template<typename NumberType>
     void json::binary_writer::write_number(const NumberType n) {
         // step 1: write number to array of length NumberType
@@ -797,54 +890,58 @@ namespace wpi {
         }
     }
 
-    std::vector <uint8_t> json::to_cbor(const json &j) {
+    std::vector <uint8_t> json::to_cbor(const json &j, const bool use_typed_arrays) {
         std::vector <uint8_t> result;
         raw_uvector_ostream os(result);
-        to_cbor(os, j);
+        to_cbor(os, j, use_typed_arrays);
         return result;
     }
 
-    ArrayRef <uint8_t> json::to_cbor(const json &j, std::vector <uint8_t> &buf) {
+    ArrayRef <uint8_t> json::to_cbor(const json &j, std::vector <uint8_t> &buf,
+                                    const bool use_typed_arrays) {
         buf.clear();
         raw_uvector_ostream os(buf);
-        to_cbor(os, j);
+        to_cbor(os, j, use_typed_arrays);
         return os.array();
     }
 
-    ArrayRef <uint8_t> json::to_cbor(const json &j, SmallVectorImpl <uint8_t> &buf) {
+    ArrayRef <uint8_t> json::to_cbor(const json &j, SmallVectorImpl <uint8_t> &buf,
+                                    const bool use_typed_arrays) {
         buf.clear();
         raw_usvector_ostream os(buf);
-        to_cbor(os, j);
+        to_cbor(os, j, use_typed_arrays);
         return os.array();
     }
 
-    void json::to_cbor(raw_ostream &os, const json &j) {
-        binary_writer(os).write_cbor(j);
+    void json::to_cbor(raw_ostream &os, const json &j, const bool use_typed_arrays) {
+        binary_writer(os, use_typed_arrays).write_cbor(j);
     }
 
-    std::vector <uint8_t> json::to_msgpack(const json &j) {
+    std::vector <uint8_t> json::to_msgpack(const json &j, const bool use_typed_arrays) {
         std::vector <uint8_t> result;
         raw_uvector_ostream os(result);
-        to_msgpack(os, j);
+        to_msgpack(os, j, use_typed_arrays);
         return result;
     }
 
-    ArrayRef <uint8_t> json::to_msgpack(const json &j, std::vector <uint8_t> &buf) {
+    ArrayRef <uint8_t> json::to_msgpack(const json &j, std::vector <uint8_t> &buf,
+                                    const bool use_typed_arrays) {
         buf.clear();
         raw_uvector_ostream os(buf);
-        to_msgpack(os, j);
+        to_msgpack(os, j, use_typed_arrays);
         return os.array();
     }
 
-    ArrayRef <uint8_t> json::to_msgpack(const json &j, SmallVectorImpl <uint8_t> &buf) {
+    ArrayRef <uint8_t> json::to_msgpack(const json &j, SmallVectorImpl <uint8_t> &buf,
+                                    const bool use_typed_arrays) {
         buf.clear();
         raw_usvector_ostream os(buf);
-        to_msgpack(os, j);
+        to_msgpack(os, j, use_typed_arrays);
         return os.array();
     }
 
-    void json::to_msgpack(raw_ostream &os, const json &j) {
-        binary_writer(os).write_msgpack(j);
+    void json::to_msgpack(raw_ostream &os, const json &j, const bool use_typed_arrays) {
+        binary_writer(os, use_typed_arrays).write_msgpack(j);
     }
 
     std::vector <uint8_t> json::to_ubjson(const json &j,
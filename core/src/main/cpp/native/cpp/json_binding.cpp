@@ -0,0 +1,257 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#define WPI_JSON_IMPLEMENTATION
+
+#include "wpi/json_binding.h"
+
+using namespace wpi;
+using detail::json_binding_reader;
+
+void detail::json_bind_out_of_range(std::size_t index) {
+    JSON_THROW(out_of_range::create(401, "array index " + Twine(index) +
+                                         " is out of range"));
+}
+
+void json_binding_reader::next_target(void **obj, const json_bind_ops **ops) {
+    if (m_stack.empty()) {
+        *obj = m_root;
+        *ops = m_root_ops;
+        return;
+    }
+    frame &top = m_stack.back();
+    if (top.ops->member) {
+        *obj = top.child;
+        *ops = top.child_ops;
+    } else {
+        *obj = top.ops->element(top.obj, top.count++, ops);
+    }
+}
+
+void json_binding_reader::build(json &&val) {
+    json *top = m_build.back();
+    if (top->is_object()) {
+        (*top)[m_key] = std::move(val);
+    } else {
+        top->push_back(std::move(val));
+    }
+}
+
+void json_binding_reader::build_container(json &&val) {
+    if (m_build.empty()) {
+        m_value = std::move(val);
+        m_build.push_back(&m_value);
+        return;
+    }
+    json *top = m_build.back();
+    if (top->is_object()) {
+        json &child = (*top)[m_key];
+        child = std::move(val);
+        m_build.push_back(&child);
+    } else {
+        top->push_back(std::move(val));
+        m_build.push_back(&top->back());
+    }
+}
+
+void json_binding_reader::build_end() {
+    m_build.pop_back();
+    if (m_build.empty()) {
+        m_build_ops->assign(m_build_obj, std::move(m_value));
+    }
+}
+
+void json_binding_reader::type_mismatch(const json_bind_ops *ops,
+                                        const char *actual) {
+    JSON_THROW(type_error::create(302, Twine("type must be ") + ops->type_name +
+                                       ", but is " + actual));
+}
+
+bool json_binding_reader::null() {
+    if (not m_build.empty()) {
+        build(nullptr);
+        return true;
+    }
+    void *obj;
+    const json_bind_ops *ops;
+    next_target(&obj, &ops);
+    if (not ops->assign) {
+        type_mismatch(ops, "null");
+    }
+    ops->assign(obj, nullptr);
+    return true;
+}
+
+bool json_binding_reader::boolean(bool val) {
+    if (not m_build.empty()) {
+        build(val);
+        return true;
+    }
+    void *obj;
+    const json_bind_ops *ops;
+    next_target(&obj, &ops);
+    if (ops->boolean) {
+        ops->boolean(obj, val);
+    } else if (ops->assign) {
+        ops->assign(obj, val);
+    } else {
+        type_mismatch(ops, "boolean");
+    }
+    return true;
+}
+
+bool json_binding_reader::number_integer(int64_t val) {
+    if (not m_build.empty()) {
+        build(val);
+        return true;
+    }
+    void *obj;
+    const json_bind_ops *ops;
+    next_target(&obj, &ops);
+    if (ops->number_integer) {
+        ops->number_integer(obj, val);
+    } else if (ops->assign) {
+        ops->assign(obj, val);
+    } else {
+        type_mismatch(ops, "number");
+    }
+    return true;
+}
+
+bool json_binding_reader::number_unsigned(uint64_t val) {
+    if (not m_build.empty()) {
+        build(val);
+        return true;
+    }
+    void *obj;
+    const json_bind_ops *ops;
+    next_target(&obj, &ops);
+    if (ops->number_unsigned) {
+        ops->number_unsigned(obj, val);
+    } else if (ops->assign) {
+        ops->assign(obj, val);
+    } else {
+        type_mismatch(ops, "number");
+    }
+    return true;
+}
+
+bool json_binding_reader::number_float(double val) {
+    if (not m_build.empty()) {
+        build(val);
+        return true;
+    }
+    void *obj;
+    const json_bind_ops *ops;
+    next_target(&obj, &ops);
+    if (ops->number_float) {
+        ops->number_float(obj, val);
+    } else if (ops->assign) {
+        ops->assign(obj, val);
+    } else {
+        type_mismatch(ops, "number");
+    }
+    return true;
+}
+
+bool json_binding_reader::string(StringRef val) {
+    if (not m_build.empty()) {
+        build(val);
+        return true;
+    }
+    void *obj;
+    const json_bind_ops *ops;
+    next_target(&obj, &ops);
+    if (ops->string) {
+        ops->string(obj, val);
+    } else if (ops->assign) {
+        ops->assign(obj, val);
+    } else {
+        type_mismatch(ops, "string");
+    }
+    return true;
+}
+
+bool json_binding_reader::start_object() {
+    if (not m_build.empty()) {
+        build_container(json::value_t::object);
+        return true;
+    }
+    void *obj;
+    const json_bind_ops *ops;
+    next_target(&obj, &ops);
+    if (ops->member) {
+        m_stack.push_back(frame{obj, ops, 0, nullptr, nullptr});
+    } else if (ops->assign) {
+        m_build_obj = obj;
+        m_build_ops = ops;
+        build_container(json::value_t::object);
+    } else {
+        type_mismatch(ops, "object");
+    }
+    return true;
+}
+
+bool json_binding_reader::key(StringRef val) {
+    if (not m_build.empty()) {
+        m_key.assign(val.data(), val.size());
+        return true;
+    }
+    frame &top = m_stack.back();
+    if (not top.ops->member(top.obj, val, &top.child, &top.child_ops)) {
+        skip_value();
+    }
+    return true;
+}
+
+bool json_binding_reader::end_object() {
+    if (not m_build.empty()) {
+        build_end();
+    } else {
+        m_stack.pop_back();
+    }
+    return true;
+}
+
+bool json_binding_reader::start_array() {
+    if (not m_build.empty()) {
+        build_container(json::value_t::array);
+        return true;
+    }
+    void *obj;
+    const json_bind_ops *ops;
+    next_target(&obj, &ops);
+    if (ops->element) {
+        if (ops->start_array) {
+            ops->start_array(obj);
+        }
+        m_stack.push_back(frame{obj, ops, 0, nullptr, nullptr});
+    } else if (ops->assign) {
+        m_build_obj = obj;
+        m_build_ops = ops;
+        build_container(json::value_t::array);
+    } else {
+        type_mismatch(ops, "array");
+    }
+    return true;
+}
+
+bool json_binding_reader::end_array() {
+    if (not m_build.empty()) {
+        build_end();
+    } else {
+        m_stack.pop_back();
+    }
+    return true;
+}
+
+void json_binding_reader::parse_error(std::size_t, StringRef,
+                                      const detail::exception &ex) {
+    // the parsers report syntax errors as parse_error and number overflow as
+    // out_of_range.406; rethrow with the dynamic type intact
+    if (ex.id >= 400) {
+        JSON_THROW(static_cast<const out_of_range &>(ex));
+    }
+    JSON_THROW(static_cast<const detail::parse_error &>(ex));
+}
@@ -0,0 +1,18 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#include "wpi/json.h"
+
+using namespace wpi;
+
+StringRef json_key_table::intern(StringRef key) {
+    auto it = m_keys.find(key);
+    if (it != m_keys.end()) return it->getKey();
+    if (m_keys.size() >= m_max_keys || key.size() > m_max_bytes - m_bytes)
+        return StringRef();
+    m_bytes += key.size();
+    // StringMap entries are allocated individually, so the key storage stays
+    // put as the table grows
+    return m_keys.try_emplace(key, 0).first->getKey();
+}
@@ -35,6 +35,7 @@ SOFTWARE.
 
 #include "wpi/json.h"
 
+#include <limits>
 #include <numeric> // accumulate
 
 #include "wpi/SmallString.h"
@@ -464,35 +465,166 @@ namespace wpi {
             JSON_THROW(detail::type_error::create(314, "only objects can be unflattened"));
         }
 
-        // we need to iterate over the object values in sorted key order
-        SmallVector<StringMapConstIterator<json>, 64> sorted;
-        for (auto i = value.m_value.object->begin(),
-                     end = value.m_value.object->end(); i != end; ++i) {
-            if (!i->second.is_primitive()) {
-                JSON_THROW(detail::type_error::create(315, "values in object must be primitive"));
-            }
-            sorted.push_back(i);
-        }
-        std::sort(sorted.begin(), sorted.end(),
-                  [](const StringMapConstIterator <json> &a,
-                     const StringMapConstIterator <json> &b) {
-                      return a->getKey() < b->getKey();
-                  });
-
         json result;
 
-        // iterate the sorted JSON object values
-        for (const auto &element : sorted) {
+        // iterate the JSON object values in the order they were flattened
+        for (const auto &element : *value.m_value.object) {
+            if (!element.second.is_primitive()) {
+                JSON_THROW(detail::type_error::create(315, "values in object must be primitive"));
+            }
 
             // assign value to reference pointed to by JSON pointer; Note
             // that if the JSON pointer is "" (i.e., points to the whole
             // value), function get_and_create returns a reference to
             // result itself. An assignment will then create a primitive
             // value.
-            json_pointer(element->first()).get_and_create(result) = element->second;
+            json_pointer(element.first()).get_and_create(result) = element.second;
         }
 
         return result;
     }
 
+    json_compiled_pointer::json_compiled_pointer(const json_pointer &ptr) {
+        m_tokens.reserve(ptr.reference_tokens.size());
+        for (const auto &reference_token : ptr.reference_tokens) {
+            token tok;
+            tok.key = reference_token;
+            tok.hash = json::object_t::hash(reference_token);
+            tok.index = 0;
+            if (reference_token == "-") {
+                tok.kind = index_kind::end;
+            } else if (reference_token.empty() or
+                       not std::all_of(reference_token.begin(), reference_token.end(),
+                                       [](const char x) {
+                                           return (x >= '0' and x <= '9');
+                                       })) {
+                tok.kind = index_kind::not_a_number;
+            } else if (reference_token.size() > 1 and reference_token[0] == '0') {
+                // error condition (cf. RFC 6901, Sect. 4)
+                tok.kind = index_kind::leading_zero;
+            } else {
+                tok.kind = index_kind::index;
+                // indices too large for any array saturate
+                for (const char x : reference_token) {
+                    const std::size_t next = tok.index * 10 + (x - '0');
+                    if (next / 10 != tok.index) {
+                        tok.index = (std::numeric_limits<std::size_t>::max)();
+                        break;
+                    }
+                    tok.index = next;
+                }
+            }
+            m_tokens.push_back(std::move(tok));
+        }
+    }
+
+    json &json_compiled_pointer::get(json &doc) const {
+        return const_cast<json &>(get(static_cast<const json &>(doc)));
+    }
+
+    const json &json_compiled_pointer::get(const json &doc) const {
+        const json *ptr = &doc;
+        for (const auto &tok : m_tokens) {
+            switch (ptr->m_type) {
+                case detail::value_t::object: {
+                    auto it = ptr->m_value.object->find(tok.key, tok.hash);
+                    if (JSON_UNLIKELY(it == ptr->m_value.object->end())) {
+                        JSON_THROW(detail::out_of_range::create(403, "key '" + Twine(tok.key) +
+                                                                     "' not found"));
+                    }
+                    ptr = &it->second;
+                    break;
+                }
+
+                case detail::value_t::array: {
+                    switch (tok.kind) {
+                        case index_kind::end:
+                            // "-" always fails the range check
+                            JSON_THROW(detail::out_of_range::create(402,
+                                                                    "array index '-' (" +
+                                                                    Twine(ptr->m_value.array->size()) +
+                                                                    ") is out of range"));
+                        case index_kind::leading_zero:
+                            JSON_THROW(detail::parse_error::create(106, 0,
+                                                                   "array index '" + Twine(tok.key) +
+                                                                   "' must not begin with '0'"));
+                        case index_kind::not_a_number:
+                            JSON_THROW(detail::parse_error::create(109, 0,
+                                                                   "array index '" + Twine(tok.key) +
+                                                                   "' is not a number"));
+                        default:
+                            break;
+                    }
+                    if (JSON_UNLIKELY(tok.index >= ptr->m_value.array->size())) {
+                        JSON_THROW(detail::out_of_range::create(401, "array index " +
+                                                                     Twine(tok.key) +
+                                                                     " is out of range"));
+                    }
+                    ptr = &(*ptr->m_value.array)[tok.index];
+                    break;
+                }
+
+                default:
+                    JSON_THROW(detail::out_of_range::create(404, "unresolved reference token '" +
+                                                                 Twine(tok.key) + "'"));
+            }
+        }
+
+        return *ptr;
+    }
+
+    json *json_compiled_pointer::find(json &doc) const noexcept {
+        return const_cast<json *>(resolve(&doc));
+    }
+
+    const json *json_compiled_pointer::find(const json &doc) const noexcept {
+        return resolve(&doc);
+    }
+
+    const json *json_compiled_pointer::find(const json &doc,
+                                            uint64_t generation) const noexcept {
+        if (m_memo_doc != &doc or m_memo_generation != generation) {
+            m_memo_node = resolve(&doc);
+            m_memo_doc = &doc;
+            m_memo_generation = generation;
+        }
+        return m_memo_node;
+    }
+
+    const json *json_compiled_pointer::resolve(const json *ptr) const noexcept {
+        for (const auto &tok : m_tokens) {
+            switch (ptr->m_type) {
+                case detail::value_t::object: {
+                    auto it = ptr->m_value.object->find(tok.key, tok.hash);
+                    if (it == ptr->m_value.object->end()) {
+                        return nullptr;
+                    }
+                    ptr = &it->second;
+                    break;
+                }
+
+                case detail::value_t::array:
+                    if (tok.kind != index_kind::index or
+                        tok.index >= ptr->m_value.array->size()) {
+                        return nullptr;
+                    }
+                    ptr = &(*ptr->m_value.array)[tok.index];
+                    break;
+
+                default:
+                    return nullptr;
+            }
+        }
+        return ptr;
+    }
+
+    std::string json_compiled_pointer::to_string() const {
+        std::string result;
+        for (const auto &tok : m_tokens) {
+            result += '/';
+            result += json_pointer::escape(tok.key);
+        }
+        return result;
+    }
+
 }  // namespace wpi
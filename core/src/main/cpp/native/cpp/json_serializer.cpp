@@ -35,9 +35,18 @@ SOFTWARE.
 
 #include "wpi/json.h"
 
+#include <atomic>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <thread>
+#include <vector>
+
 #include "wpi/Format.h"
 #include "wpi/SmallString.h"
 #include "wpi/StringExtras.h"
+#include "wpi/condition_variable.h"
+#include "wpi/mutex.h"
 #include "wpi/raw_os_ostream.h"
 
 #include "json_serializer.h"
@@ -1078,6 +1087,69 @@ format. Returns an iterator pointing past-the-end of the decimal representation.
             return dtoa_impl::format_buffer(first, len, decimal_exponent, kMinExp, kMaxExp);
         }
 
+/*!
+@brief worker threads shared by all json::dump_parallel() calls
+
+Threads are started as calls ask for more of them and are kept until the
+process exits, so serializing many large documents does not pay for thread
+creation each time.
+*/
+        class dump_pool {
+        public:
+            static dump_pool &instance() {
+                static dump_pool pool;
+                return pool;
+            }
+
+            ~dump_pool() {
+                {
+                    std::lock_guard<wpi::mutex> lock(m_mutex);
+                    m_stop = true;
+                }
+                m_cv.notify_all();
+                for (auto &thread : m_threads) {
+                    thread.join();
+                }
+            }
+
+            /*!
+            @brief run @a task on a worker thread
+
+            Starts another thread first if fewer than @a workers exist. If that
+            or queueing the task throws, the task will not run.
+            */
+            void submit(std::function<void()> task, std::size_t workers) {
+                std::lock_guard<wpi::mutex> lock(m_mutex);
+                if (m_threads.size() < workers) {
+                    m_threads.emplace_back([this] { main(); });
+                }
+                m_tasks.push_back(std::move(task));
+                m_cv.notify_one();
+            }
+
+        private:
+            void main() {
+                std::unique_lock<wpi::mutex> lock(m_mutex);
+                for (;;) {
+                    m_cv.wait(lock, [&] { return m_stop or not m_tasks.empty(); });
+                    if (m_tasks.empty()) {
+                        return;
+                    }
+                    auto task = std::move(m_tasks.front());
+                    m_tasks.pop_front();
+                    lock.unlock();
+                    task();
+                    lock.lock();
+                }
+            }
+
+            wpi::mutex m_mutex;
+            wpi::condition_variable m_cv;
+            std::deque<std::function<void()>> m_tasks;
+            std::vector<std::thread> m_threads;
+            bool m_stop = false;
+        };
+
     }  // namespace
 
     void json::serializer::dump(const json &val, const bool pretty_print,
@@ -1091,17 +1163,7 @@ format. Returns an iterator pointing past-the-end of the decimal representation.
                     return;
                 }
 
-                // we need to iterate over the object values in sorted key order
-                SmallVector<StringMapConstIterator<json>, 64> sorted;
-                for (auto i = val.m_value.object->begin(),
-                             end = val.m_value.object->end(); i != end; ++i) {
-                    sorted.push_back(i);
-                }
-                std::sort(sorted.begin(), sorted.end(),
-                          [](const StringMapConstIterator <json> &a,
-                             const StringMapConstIterator <json> &b) {
-                              return a->getKey() < b->getKey();
-                          });
+                const auto &object = *val.m_value.object;
 
                 if (pretty_print) {
                     o << "{\n";
@@ -1113,24 +1175,24 @@ format. Returns an iterator pointing past-the-end of the decimal representation.
                     }
 
                     // first n-1 elements
-                    auto i = sorted.begin();
-                    for (std::size_t cnt = 0; cnt < sorted.size() - 1; ++cnt, ++i) {
+                    auto i = object.begin();
+                    for (std::size_t cnt = 0; cnt < object.size() - 1; ++cnt, ++i) {
                         o.write(indent_string.c_str(), new_indent);
                         o << '\"';
-                        dump_escaped((*i)->first(), ensure_ascii);
+                        dump_escaped(o, i->first(), ensure_ascii);
                         o << "\": ";
-                        dump((*i)->second, true, ensure_ascii, indent_step, new_indent);
+                        dump(i->second, true, ensure_ascii, indent_step, new_indent);
                         o << ",\n";
                     }
 
                     // last element
-                    assert(i != sorted.end());
-                    //assert(std::next(i) == val.m_value.object->end());
+                    assert(i != object.end());
+                    assert(std::next(i) == object.end());
                     o.write(indent_string.c_str(), new_indent);
                     o << '\"';
-                    dump_escaped((*i)->first(), ensure_ascii);
+                    dump_escaped(o, i->first(), ensure_ascii);
                     o << "\": ";
-                    dump((*i)->second, true, ensure_ascii, indent_step, new_indent);
+                    dump(i->second, true, ensure_ascii, indent_step, new_indent);
 
                     o << '\n';
                     o.write(indent_string.c_str(), current_indent);
@@ -1139,22 +1201,22 @@ format. Returns an iterator pointing past-the-end of the decimal representation.
                     o << '{';
 
                     // first n-1 elements
-                    auto i = sorted.begin();
-                    for (std::size_t cnt = 0; cnt < sorted.size() - 1; ++cnt, ++i) {
+                    auto i = object.begin();
+                    for (std::size_t cnt = 0; cnt < object.size() - 1; ++cnt, ++i) {
                         o << '\"';
-                        dump_escaped((*i)->first(), ensure_ascii);
+                        dump_escaped(o, i->first(), ensure_ascii);
                         o << "\":";
-                        dump((*i)->second, false, ensure_ascii, indent_step, current_indent);
+                        dump(i->second, false, ensure_ascii, indent_step, current_indent);
                         o << ',';
                     }
 
                     // last element
-                    assert(i != sorted.end());
-                    //assert(std::next(i) == val.m_value.object->end());
+                    assert(i != object.end());
+                    assert(std::next(i) == object.end());
                     o << '\"';
-                    dump_escaped((*i)->first(), ensure_ascii);
+                    dump_escaped(o, i->first(), ensure_ascii);
                     o << "\":";
-                    dump((*i)->second, false, ensure_ascii, indent_step, current_indent);
+                    dump(i->second, false, ensure_ascii, indent_step, current_indent);
 
                     o << '}';
                 }
@@ -1216,7 +1278,7 @@ format. Returns an iterator pointing past-the-end of the decimal representation.
 
             case value_t::string: {
                 o << '\"';
-                dump_escaped(*val.m_value.string, ensure_ascii);
+                dump_escaped(o, *val.m_value.string, ensure_ascii);
                 o << '\"';
                 return;
             }
@@ -1231,17 +1293,17 @@ format. Returns an iterator pointing past-the-end of the decimal representation.
             }
 
             case value_t::number_integer: {
-                dump_integer(val.m_value.number_integer);
+                dump_integer(o, val.m_value.number_integer);
                 return;
             }
 
             case value_t::number_unsigned: {
-                dump_integer(val.m_value.number_unsigned);
+                dump_integer(o, val.m_value.number_unsigned);
                 return;
             }
 
             case value_t::number_float: {
-                dump_float(val.m_value.number_float);
+                dump_float(o, val.m_value.number_float);
                 return;
             }
 
@@ -1257,7 +1319,190 @@ format. Returns an iterator pointing past-the-end of the decimal representation.
         }
     }
 
-    void json::serializer::dump_escaped(StringRef s, const bool ensure_ascii) {
+    void json::serializer::dump_parallel(const json &val, const bool pretty_print,
+                                         const bool ensure_ascii,
+                                         const unsigned int indent_step,
+                                         const unsigned int current_indent,
+                                         const unsigned int threads) {
+        if (not val.is_structured() or val.empty()) {
+            dump(val, pretty_print, ensure_ascii, indent_step, current_indent);
+            return;
+        }
+
+        const bool is_object = val.is_object();
+        const std::size_t size = val.size();
+        const auto new_indent = current_indent + indent_step;
+        if (pretty_print) {
+            o << (is_object ? "{\n" : "[\n");
+            if (JSON_UNLIKELY(indent_string.size() < new_indent)) {
+                indent_string.resize(indent_string.size() * 2, indent_char);
+            }
+        } else {
+            o << (is_object ? '{' : '[');
+        }
+
+        if (size < parallel_min_elements) {
+            // write directly; large containers among the elements are split
+            dump_elements(val, 0, size, pretty_print, ensure_ascii, indent_step,
+                          new_indent, threads);
+        } else {
+            // a few runs per thread, so that one run of expensive elements
+            // does not hold up the others
+            const std::size_t runs =
+                    (std::min)(std::size_t{threads} * 4, size / 256);
+            std::vector<std::string> out(runs);
+            std::vector<std::exception_ptr> errors(runs);
+            std::vector<char> done(runs, 0);
+            std::atomic<std::size_t> next{0};
+            wpi::mutex done_mutex;
+            wpi::condition_variable done_cv;
+
+            const auto run = [&](std::size_t i) {
+                raw_string_ostream os(out[i]);
+                JSON_TRY
+                {
+                    serializer s(os, indent_char);
+                    while (s.indent_string.size() < new_indent) {
+                        s.indent_string.resize(s.indent_string.size() * 2, indent_char);
+                    }
+                    s.dump_elements(val, size * i / runs, size * (i + 1) / runs,
+                                    pretty_print, ensure_ascii, indent_step,
+                                    new_indent, 1);
+                }
+                JSON_CATCH(...)
+                {
+                    errors[i] = std::current_exception();
+                }
+                os.flush();
+                {
+                    std::lock_guard<wpi::mutex> lock(done_mutex);
+                    done[i] = 1;
+                }
+                done_cv.notify_all();
+            };
+
+            // runs are taken in order, so the first ones complete first. The
+            // helpers use this frame, so every one that was queued is waited
+            // for before leaving; if queueing fails, the calling thread takes
+            // over the missing helpers' share of the runs.
+            std::size_t helpers = 0;
+            const auto help = [&] {
+                for (std::size_t i; (i = next++) < runs;) {
+                    run(i);
+                }
+                std::lock_guard<wpi::mutex> lock(done_mutex);
+                --helpers;
+                done_cv.notify_all();
+            };
+            for (unsigned int t = 1; t < threads; ++t) {
+                {
+                    std::lock_guard<wpi::mutex> lock(done_mutex);
+                    ++helpers;
+                }
+                JSON_TRY
+                {
+                    dump_pool::instance().submit(help, threads - 1);
+                }
+                JSON_CATCH(...)
+                {
+                    std::lock_guard<wpi::mutex> lock(done_mutex);
+                    --helpers;
+                    break;
+                }
+            }
+
+            // the calling thread helps until the next run to write out is
+            // done, then writes it
+            std::exception_ptr error;
+            JSON_TRY
+            {
+                for (std::size_t i = 0; i < runs; ++i) {
+                    for (;;) {
+                        {
+                            std::lock_guard<wpi::mutex> lock(done_mutex);
+                            if (done[i]) {
+                                break;
+                            }
+                        }
+                        const std::size_t j = next++;
+                        if (j < runs) {
+                            run(j);
+                        } else {
+                            std::unique_lock<wpi::mutex> lock(done_mutex);
+                            done_cv.wait(lock, [&] { return done[i] != 0; });
+                            break;
+                        }
+                    }
+                    if (errors[i]) {
+                        // stop the helpers; the output so far matches dump()
+                        // up to the run that failed
+                        error = errors[i];
+                        next = runs;
+                        break;
+                    }
+                    o.write(out[i].data(), out[i].size());
+                    std::string().swap(out[i]);
+                }
+            }
+            JSON_CATCH(...)
+            {
+                error = std::current_exception();
+                next = runs;
+            }
+            {
+                std::unique_lock<wpi::mutex> lock(done_mutex);
+                done_cv.wait(lock, [&] { return helpers == 0; });
+            }
+            if (error) {
+                std::rethrow_exception(error);
+            }
+        }
+
+        if (pretty_print) {
+            o << '\n';
+            o.write(indent_string.c_str(), current_indent);
+        }
+        o << (is_object ? '}' : ']');
+    }
+
+    void json::serializer::dump_elements(const json &val, std::size_t first,
+                                         std::size_t last, const bool pretty_print,
+                                         const bool ensure_ascii,
+                                         const unsigned int indent_step,
+                                         const unsigned int new_indent,
+                                         const unsigned int threads) {
+        const std::size_t size = val.size();
+        for (std::size_t i = first; i < last; ++i) {
+            if (pretty_print) {
+                o.write(indent_string.c_str(), new_indent);
+            }
+
+            const json *element;
+            if (val.is_object()) {
+                const auto &member = val.m_value.object->begin()[i];
+                o << '\"';
+                dump_escaped(o, member.first(), ensure_ascii);
+                o << (pretty_print ? "\": " : "\":");
+                element = &member.second;
+            } else {
+                element = &(*val.m_value.array)[i];
+            }
+
+            if (threads > 1) {
+                dump_parallel(*element, pretty_print, ensure_ascii, indent_step,
+                              new_indent, threads);
+            } else {
+                dump(*element, pretty_print, ensure_ascii, indent_step, new_indent);
+            }
+
+            if (i + 1 != size) {
+                o << (pretty_print ? ",\n" : ",");
+            }
+        }
+    }
+
+    void json::serializer::dump_escaped(raw_ostream &o, StringRef s,
+                                        const bool ensure_ascii) {
         uint32_t codepoint;
         uint8_t state = UTF8_ACCEPT;
 
@@ -1357,7 +1602,7 @@ format. Returns an iterator pointing past-the-end of the decimal representation.
         }
     }
 
-    void json::serializer::dump_float(double x) {
+    void json::serializer::dump_float(raw_ostream &o, double x) {
         // NaN / inf
         if (not std::isfinite(x)) {
             o << "null";
@@ -1366,6 +1611,7 @@ format. Returns an iterator pointing past-the-end of the decimal representation.
 
         // use the Grisu2 algorithm to produce short numbers which are
         // guaranteed to round-trip, using strtof and strtod, resp.
+        std::array<char, 64> number_buffer;
         char *begin = number_buffer.data();
         char *end = to_chars(begin, begin + number_buffer.size(), x);
 
@@ -1403,6 +1649,97 @@ format. Returns an iterator pointing past-the-end of the decimal representation.
         return state;
     }
 
+    void json_writer::separator() {
+        if (m_need_comma) {
+            m_os << ',';
+        }
+    }
+
+    bool json_writer::null() {
+        separator();
+        m_os << "null";
+        m_need_comma = true;
+        return true;
+    }
+
+    bool json_writer::boolean(bool val) {
+        separator();
+        m_os << (val ? StringRef("true") : StringRef("false"));
+        m_need_comma = true;
+        return true;
+    }
+
+    bool json_writer::number_integer(int64_t val) {
+        separator();
+        json::serializer::dump_integer(m_os, val);
+        m_need_comma = true;
+        return true;
+    }
+
+    bool json_writer::number_unsigned(uint64_t val) {
+        separator();
+        json::serializer::dump_integer(m_os, val);
+        m_need_comma = true;
+        return true;
+    }
+
+    bool json_writer::number_float(double val) {
+        separator();
+        json::serializer::dump_float(m_os, val);
+        m_need_comma = true;
+        return true;
+    }
+
+    bool json_writer::string(StringRef val) {
+        separator();
+        m_os << '\"';
+        json::serializer::dump_escaped(m_os, val, m_ensure_ascii);
+        m_os << '\"';
+        m_need_comma = true;
+        return true;
+    }
+
+    bool json_writer::start_object() {
+        separator();
+        m_os << '{';
+        m_need_comma = false;
+        return true;
+    }
+
+    bool json_writer::key(StringRef val) {
+        separator();
+        m_os << '\"';
+        json::serializer::dump_escaped(m_os, val, m_ensure_ascii);
+        m_os << "\":";
+        m_need_comma = false;
+        return true;
+    }
+
+    bool json_writer::end_object() {
+        m_os << '}';
+        m_need_comma = true;
+        return true;
+    }
+
+    bool json_writer::start_array() {
+        separator();
+        m_os << '[';
+        m_need_comma = false;
+        return true;
+    }
+
+    bool json_writer::end_array() {
+        m_os << ']';
+        m_need_comma = true;
+        return true;
+    }
+
+    void json_writer::value(const json &val) {
+        separator();
+        json::serializer(m_os, ' ').dump(val, false, m_ensure_ascii, 0);
+        m_need_comma = true;
+    }
+
     std::string json::dump(const int indent, const char indent_char,
                            const bool ensure_ascii) const {
         std::string result;
@@ -1424,6 +1761,28 @@ format. Returns an iterator pointing past-the-end of the decimal representation.
         os.flush();
     }
 
+    void json::dump_parallel(raw_ostream &os, int indent, const char indent_char,
+                             const bool ensure_ascii, unsigned int threads) const {
+        if (threads == 0) {
+            threads = std::thread::hardware_concurrency();
+        }
+        if (threads <= 1) {
+            dump(os, indent, indent_char, ensure_ascii);
+            return;
+        }
+
+        serializer s(os, indent_char);
+
+        if (indent >= 0) {
+            s.dump_parallel(*this, true, ensure_ascii,
+                            static_cast<unsigned int>(indent), 0, threads);
+        } else {
+            s.dump_parallel(*this, false, ensure_ascii, 0, 0, threads);
+        }
+
+        os.flush();
+    }
+
     raw_ostream &operator<<(raw_ostream &o, const json &j) {
         j.dump(o, 0);
         return o;
@@ -82,7 +82,29 @@ namespace wpi {
                   const unsigned int indent_step,
                   const unsigned int current_indent = 0);
 
-    private:
+        /*!
+        @brief serialize large arrays and objects on several threads
+
+        Same output as dump(). Arrays and objects with at least
+        parallel_min_elements elements are split into runs of elements that
+        are serialized concurrently into separate strings and written out in
+        order as they complete; smaller containers are written directly, with
+        their elements checked the same way.
+
+        @param[in] threads  the number of threads to use, including the
+                            calling thread
+        */
+        void dump_parallel(const json &val, const bool pretty_print,
+                           const bool ensure_ascii,
+                           const unsigned int indent_step,
+                           const unsigned int current_indent,
+                           const unsigned int threads);
+
+        /// containers with fewer elements are not split by dump_parallel()
+        static constexpr std::size_t parallel_min_elements = 2048;
+
+        // the primitive writers are static so that json_writer can share them
+
         /*!
         @brief dump escaped string
 
@@ -91,32 +113,33 @@ namespace wpi {
         characters by a sequence of "\u" followed by a four-digit hex
         representation. The escaped string is written to output stream @a o.
 
+        @param[in] o  the stream to write to
         @param[in] s  the string to escape
         @param[in] ensure_ascii  whether to escape non-ASCII characters with
                                  \uXXXX sequences
 
         @complexity Linear in the length of string @a s.
         */
-        void dump_escaped(StringRef s, const bool ensure_ascii);
+        static void dump_escaped(raw_ostream &o, StringRef s, const bool ensure_ascii);
 
         template<typename NumberType,
                 detail::enable_if_t<std::is_same_v<NumberType, uint64_t>, int> = 0>
-        bool is_negative_integer(NumberType x) {
+        static bool is_negative_integer(NumberType x) {
             return false;
         }
 
         template<typename NumberType,
                 detail::enable_if_t<std::is_same_v<NumberType, int64_t>, int> = 0>
-        bool is_negative_integer(NumberType x) {
+        static bool is_negative_integer(NumberType x) {
             return x < 0;
         }
 
         /*!
         @brief dump an integer
 
-        Dump a given integer to output stream @a o. Works internally with
-        @a number_buffer.
+        Dump a given integer to output stream @a o.
 
+        @param[in] o  the stream to write to
         @param[in] x  integer number (signed or unsigned) to dump
         @tparam NumberType either @a int64_t or @a uint64_t
         */
@@ -124,7 +147,7 @@ namespace wpi {
                 std::is_same<NumberType, uint64_t>::value or
                 std::is_same<NumberType, int64_t>::value,
                 int> = 0>
-        void dump_integer(NumberType x) {
+        static void dump_integer(raw_ostream &o, NumberType x) {
             // special case for "0"
             if (x == 0) {
                 o << '0';
@@ -132,6 +155,7 @@ namespace wpi {
             }
 
             const bool is_negative = is_negative_integer(x);  // see issue #755
+            std::array<char, 64> number_buffer;
             std::size_t i = 0;
 
             while (x != 0) {
@@ -156,12 +180,30 @@ namespace wpi {
         /*!
         @brief dump a floating-point number
 
-        Dump a given floating-point number to output stream @a o. Works internally
-        with @a number_buffer.
+        Dump a given floating-point number to output stream @a o.
 
+        @param[in] o  the stream to write to
         @param[in] x  floating-point number to dump
         */
-        void dump_float(double x);
+        static void dump_float(raw_ostream &o, double x);
+
+    private:
+        /*!
+        @brief dump the elements [first, last) of an array or object
+
+        Writes each element as dump() does for the whole container: the
+        indentation and key before it and the separator after it, except
+        after the last element of the container.
+
+        @param[in] new_indent  the indent level of the elements
+        @param[in] threads  if greater than 1, elements are written by
+                            dump_parallel()
+        */
+        void dump_elements(const json &val, std::size_t first, std::size_t last,
+                           const bool pretty_print, const bool ensure_ascii,
+                           const unsigned int indent_step,
+                           const unsigned int new_indent,
+                           const unsigned int threads);
 
         /*!
         @brief check whether a string is UTF-8 encoded
@@ -190,9 +232,6 @@ namespace wpi {
         /// the output of the serializer
         raw_ostream &o;
 
-        /// a (hopefully) large enough character buffer
-        std::array<char, 64> number_buffer{{}};
-
         /// the locale
         const std::lconv *loc = nullptr;
 
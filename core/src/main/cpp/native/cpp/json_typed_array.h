@@ -0,0 +1,124 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#ifndef WPIUTIL_JSON_TYPED_ARRAY_H_
+#define WPIUTIL_JSON_TYPED_ARRAY_H_
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+#include "wpi/Endian.h"
+#include "wpi/json.h"
+
+namespace wpi {
+    namespace detail {
+
+/*!
+@brief element type of a packed numeric array
+
+CBOR typed arrays (RFC 8746) are a byte string tagged 64..87, where the bits
+of the tag 0b010fsell give the element type: f for floating point, s for
+signed integers, e for little endian, and ll for the size (1 << ll bytes for
+integers, 2 << ll for floats). MessagePack has no typed arrays; they are
+written as an ext value whose ext type is the RFC 8746 tag, so both formats
+share this description.
+*/
+        struct typed_array {
+            /// RFC 8746 tag of little endian float64 arrays, used when writing
+            static constexpr uint8_t float64_le = 86;
+
+            uint8_t tag;
+            /// bytes per element
+            uint8_t size;
+            bool is_float;
+            bool is_signed;
+            bool little_endian;
+
+            /*!
+            @brief describe the array with tag (or ext type) @a tag
+
+            @return false if @a tag is not a typed array this library reads;
+                    float128 and the reserved tag 76 are not
+            */
+            static bool describe(uint64_t tag, typed_array &info) {
+                if (tag < 64 or tag > 86 or tag == 76 or tag == 83) {
+                    return false;
+                }
+                const unsigned ll = tag & 0x03;
+                info.tag = static_cast<uint8_t>(tag);
+                info.is_float = (tag & 0x10) != 0;
+                info.is_signed = not info.is_float and (tag & 0x08) != 0;
+                // for uint8, bit e marks clamped arithmetic instead
+                info.little_endian = (tag & 0x04) != 0;
+                info.size = static_cast<uint8_t>(info.is_float ? 2u << ll : 1u << ll);
+                return true;
+            }
+
+            /// whether elements can be copied as doubles without conversion
+            bool is_native_double() const {
+                return is_float and size == 8 and
+                       little_endian == (support::endian::system_endianness() ==
+                                         support::little);
+            }
+
+            /// decode the element at @a p
+            json element(const uint8_t *p) const {
+                using namespace support;
+                const endianness order = little_endian ? little : big;
+                if (is_float) {
+                    switch (size) {
+                        case 2:
+                            return half(endian::read<uint16_t, unaligned>(p, order));
+                        case 4:
+                            return endian::read<float, unaligned>(p, order);
+                        default:
+                            return endian::read<double, unaligned>(p, order);
+                    }
+                }
+                if (is_signed) {
+                    switch (size) {
+                        case 1:
+                            return static_cast<int8_t>(*p);
+                        case 2:
+                            return endian::read<int16_t, unaligned>(p, order);
+                        case 4:
+                            return endian::read<int32_t, unaligned>(p, order);
+                        default:
+                            return endian::read<int64_t, unaligned>(p, order);
+                    }
+                }
+                switch (size) {
+                    case 1:
+                        return *p;
+                    case 2:
+                        return endian::read<uint16_t, unaligned>(p, order);
+                    case 4:
+                        return endian::read<uint32_t, unaligned>(p, order);
+                    default:
+                        return endian::read<uint64_t, unaligned>(p, order);
+                }
+            }
+
+            /// decode a float16, as in RFC 7049, Appendix D, Figure 3
+            static double half(uint16_t bits) {
+                const int exp = (bits >> 10) & 0x1F;
+                const int mant = bits & 0x3FF;
+                double val;
+                if (exp == 0) {
+                    val = std::ldexp(mant, -24);
+                } else if (exp != 31) {
+                    val = std::ldexp(mant + 1024, exp - 25);
+                } else {
+                    val = (mant == 0) ? std::numeric_limits<double>::infinity()
+                                      : std::numeric_limits<double>::quiet_NaN();
+                }
+                return (bits & 0x8000) != 0 ? -val : val;
+            }
+        };
+
+    }  // namespace detail
+}  // namespace wpi
+
+#endif  // WPIUTIL_JSON_TYPED_ARRAY_H_
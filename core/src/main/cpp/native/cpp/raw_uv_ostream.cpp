@@ -37,3 +37,57 @@ uint64_t raw_uv_ostream::current_pos() const {
     }
     return size;
 }
+
+void raw_uv_pool_ostream::write_impl(const char *data, size_t len) {
+    if (m_capacity != 0 && data == getBufferStart()) {
+        // flushing the stream buffer; the data is already in place
+        m_bufs.back().len += len;
+        // the stream keeps writing to its buffer after a flush, so a full
+        // buffer must be replaced right away
+        if (m_bufs.back().len == m_capacity) {
+            AllocateBuffer();
+        }
+    } else {
+        // unbuffered, or a write larger than the stream buffer; copy it in
+        while (len > 0) {
+            if (m_capacity == 0 || m_bufs.back().len == m_capacity) {
+                AllocateBuffer();
+            }
+
+            auto &buf = m_bufs.back();
+            size_t amt = (std::min)(m_capacity - buf.len, len);
+            std::memcpy(buf.base + buf.len, data, amt);
+            data += amt;
+            len -= amt;
+            buf.len += amt;
+        }
+    }
+
+    // use the unwritten part of the current buffer as the stream buffer; the
+    // stream is unbuffered while it is full, so the next write allocates
+    if (m_capacity != 0) {
+        auto &buf = m_bufs.back();
+        if (buf.len < m_capacity) {
+            SetBuffer(buf.base + buf.len, m_capacity - buf.len);
+        } else {
+            SetUnbuffered();
+        }
+    }
+}
+
+void raw_uv_pool_ostream::AllocateBuffer() {
+    m_bufs.emplace_back(m_alloc());
+    // as with raw_uv_ostream, keep bufs() valid by tracking the allocated
+    // size separately
+    m_capacity = m_bufs.back().len;
+    m_bufs.back().len = 0;
+    assert(m_capacity != 0);
+}
+
+uint64_t raw_uv_pool_ostream::current_pos() const {
+    uint64_t size = 0;
+    for (auto &&buf : m_bufs) {
+        size += buf.len;
+    }
+    return size;
+}
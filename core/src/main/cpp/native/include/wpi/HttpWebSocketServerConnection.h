@@ -79,6 +79,13 @@ namespace wpi {
          */
         WebSocket *m_websocket = nullptr;
 
+        /**
+         * Compression to accept on WebSocket upgrades if the client offers it.
+         * Set this in the derived class constructor; by default messages are
+         * not compressed.
+         */
+        WebSocket::DeflateOptions m_deflateOptions;
+
     private:
         WebSocketServerHelper m_helper;
         SmallVector<std::string, 2> m_protocols;
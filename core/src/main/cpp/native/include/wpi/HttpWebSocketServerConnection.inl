@@ -37,7 +37,7 @@ namespace wpi {
             auto self = this->shared_from_this();
 
             // Accept the upgrade
-            auto ws = m_helper.Accept(m_stream, protocol);
+            auto ws = m_helper.Accept(m_stream, protocol, m_deflateOptions);
 
             // Set this as the websocket user data to keep it around
             ws->SetData(self);
@@ -0,0 +1,423 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#ifndef WPIUTIL_WPI_ORDEREDSTRINGMAP_H_
+#define WPIUTIL_WPI_ORDEREDSTRINGMAP_H_
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "wpi/MathExtras.h"
+#include "wpi/SmallVector.h"
+#include "wpi/StringExtras.h"
+#include "wpi/StringRef.h"
+
+namespace wpi {
+
+/// OrderedStringMapKey - The key of an OrderedStringMap entry, in 16 bytes.
+/// Keys of up to 15 bytes are held inline, longer ones are copied to the
+/// heap. A long external key instead refers to storage owned by someone
+/// else, such as a table of interned keys, which must outlive it; copies own
+/// their key, while moves keep referring to the external storage.
+    class OrderedStringMapKey {
+    public:
+        explicit OrderedStringMapKey(StringRef Key, bool External = false) {
+            if (Key.size() <= MaxInline) {
+                setInline(Key);
+            } else if (External) {
+                setOutOfLine(Key.data(), Key.size(), ExternalTag);
+            } else {
+                char *Heap = new char[Key.size()];
+                std::memcpy(Heap, Key.data(), Key.size());
+                setOutOfLine(Heap, Key.size(), HeapTag);
+            }
+        }
+
+        OrderedStringMapKey(const OrderedStringMapKey &Other)
+                : OrderedStringMapKey(Other.str()) {}
+
+        OrderedStringMapKey(OrderedStringMapKey &&Other) noexcept {
+            std::memcpy(Bytes, Other.Bytes, sizeof(Bytes));
+            Other.setInline(StringRef());
+        }
+
+        OrderedStringMapKey &operator=(const OrderedStringMapKey &Other) {
+            if (this != &Other) *this = OrderedStringMapKey(Other);
+            return *this;
+        }
+
+        OrderedStringMapKey &operator=(OrderedStringMapKey &&Other) noexcept {
+            if (this != &Other) {
+                release();
+                std::memcpy(Bytes, Other.Bytes, sizeof(Bytes));
+                Other.setInline(StringRef());
+            }
+            return *this;
+        }
+
+        ~OrderedStringMapKey() { release(); }
+
+        StringRef str() const {
+            if (isInline()) return StringRef(Bytes, MaxInline - Bytes[MaxInline]);
+            uint32_t Size;
+            std::memcpy(&Size, Bytes + sizeof(const char *), sizeof(Size));
+            return StringRef(outOfLineData(), Size);
+        }
+
+        /// isExternal - Whether the key refers to storage it does not own.
+        bool isExternal() const { return Bytes[MaxInline] == ExternalTag; }
+
+        /// Longest key held inline; such keys are never external.
+        static constexpr unsigned MaxInline = 15;
+
+    private:
+        // Inline keys fill the bytes from the start and keep MaxInline minus
+        // their length in the last byte; out of line keys hold a pointer and
+        // a 32-bit length and mark the last byte with a tag above MaxInline.
+        static constexpr char HeapTag = 0x40;
+        static constexpr char ExternalTag = 0x41;
+
+        bool isInline() const { return Bytes[MaxInline] <= char(MaxInline); }
+
+        const char *outOfLineData() const {
+            const char *Data;
+            std::memcpy(&Data, Bytes, sizeof(Data));
+            return Data;
+        }
+
+        void setInline(StringRef Key) {
+            if (!Key.empty()) std::memcpy(Bytes, Key.data(), Key.size());
+            Bytes[MaxInline] = static_cast<char>(MaxInline - Key.size());
+        }
+
+        void setOutOfLine(const char *Data, size_t Size, char Tag) {
+            assert(Size <= UINT32_MAX && "key too long");
+            uint32_t Size32 = static_cast<uint32_t>(Size);
+            std::memcpy(Bytes, &Data, sizeof(Data));
+            std::memcpy(Bytes + sizeof(Data), &Size32, sizeof(Size32));
+            Bytes[MaxInline] = Tag;
+        }
+
+        void release() {
+            if (Bytes[MaxInline] == HeapTag) delete[] outOfLineData();
+        }
+
+        alignas(const char *) char Bytes[MaxInline + 1];
+    };
+
+/// OrderedStringMapEntry - One key/value pair stored in an OrderedStringMap.
+    template<typename ValueTy>
+    class OrderedStringMapEntry {
+    public:
+        template<typename... InitTy>
+        explicit OrderedStringMapEntry(StringRef Key, InitTy &&... InitVals)
+                : Key(Key), second(std::forward<InitTy>(InitVals)...) {}
+
+        template<typename... InitTy>
+        OrderedStringMapEntry(OrderedStringMapKey &&Key, InitTy &&... InitVals)
+                : Key(std::move(Key)), second(std::forward<InitTy>(InitVals)...) {}
+
+        StringRef getKey() const { return Key.str(); }
+
+        StringRef first() const { return Key.str(); }
+
+        /// isKeyExternal - Whether the key refers to storage outside the map.
+        bool isKeyExternal() const { return Key.isExternal(); }
+
+        const ValueTy &getValue() const { return second; }
+
+        ValueTy &getValue() { return second; }
+
+    private:
+        OrderedStringMapKey Key;
+
+    public:
+        ValueTy second;
+    };
+
+/// OrderedStringMap - A string-keyed map that iterates in insertion order.
+///
+/// Entries live in a flat vector, the first InlineEntries of them inside the
+/// map itself, and small maps are searched linearly; for the handful of keys
+/// typical of a message that beats hashing. Once a map grows past
+/// IndexThreshold entries a hash index of entry positions is built alongside
+/// the vector. Inserting may invalidate iterators and references; erasing is
+/// linear in the size of the map.
+    template<typename ValueTy, unsigned InlineEntries = 4>
+    class OrderedStringMap {
+    public:
+        using key_type = StringRef;
+        using mapped_type = ValueTy;
+        using value_type = OrderedStringMapEntry<ValueTy>;
+        using size_type = size_t;
+
+        using iterator = value_type *;
+        using const_iterator = const value_type *;
+
+        /// Number of entries above which lookups go through the hash index.
+        static constexpr unsigned IndexThreshold = 8;
+
+        OrderedStringMap() = default;
+
+        OrderedStringMap(std::initializer_list <std::pair<StringRef, ValueTy>> List) {
+            reserve(List.size());
+            for (const auto &P : List) {
+                insert(P);
+            }
+        }
+
+        iterator begin() { return Entries.begin(); }
+
+        iterator end() { return Entries.end(); }
+
+        const_iterator begin() const { return Entries.begin(); }
+
+        const_iterator end() const { return Entries.end(); }
+
+        bool empty() const { return Entries.empty(); }
+
+        size_type size() const { return Entries.size(); }
+
+        size_type max_size() const { return Entries.max_size(); }
+
+        /// reserve - Make room for N entries without further reallocation.
+        void reserve(size_type N) {
+            Entries.reserve(N);
+        }
+
+        iterator find(StringRef Key) {
+            int I = FindKey(Key);
+            return I == -1 ? end() : begin() + I;
+        }
+
+        const_iterator find(StringRef Key) const {
+            int I = FindKey(Key);
+            return I == -1 ? end() : begin() + I;
+        }
+
+        /// hash - The hash of \p Key used by the index, for the find
+        /// overloads below.
+        static unsigned hash(StringRef Key) { return HashString(Key); }
+
+        /// find - Look up \p Key given its precomputed hash(Key), which saves
+        /// hashing it again on lookups that go through the index.
+        iterator find(StringRef Key, unsigned FullHashValue) {
+            int I = FindKey(Key, FullHashValue);
+            return I == -1 ? end() : begin() + I;
+        }
+
+        const_iterator find(StringRef Key, unsigned FullHashValue) const {
+            int I = FindKey(Key, FullHashValue);
+            return I == -1 ? end() : begin() + I;
+        }
+
+        /// lookup - Return the entry for the specified key, or a default
+        /// constructed value if no such entry exists.
+        ValueTy lookup(StringRef Key) const {
+            const_iterator it = find(Key);
+            if (it != end())
+                return it->second;
+            return ValueTy();
+        }
+
+        /// Lookup the ValueTy for the \p Key, or create a default constructed value
+        /// at the end of the map if the key is not in the map.
+        ValueTy &operator[](StringRef Key) { return try_emplace(Key).first->second; }
+
+        /// count - Return 1 if the element is in the map, 0 otherwise.
+        size_type count(StringRef Key) const { return FindKey(Key) == -1 ? 0 : 1; }
+
+        /// insert - Inserts the specified key/value pair at the end of the map if
+        /// the key isn't already in the map. The bool component of the returned
+        /// pair is true if and only if the insertion takes place, and the iterator
+        /// component of the pair points to the element with key equivalent to the
+        /// key of the pair.
+        std::pair<iterator, bool> insert(std::pair <StringRef, ValueTy> KV) {
+            return try_emplace(KV.first, std::move(KV.second));
+        }
+
+        /// Emplace a new element for the specified key at the end of the map if
+        /// the key isn't already in the map. The bool component of the returned
+        /// pair is true if and only if the insertion takes place, and the iterator
+        /// component of the pair points to the element with key equivalent to the
+        /// key of the pair.
+        template<typename... ArgsTy>
+        std::pair<iterator, bool> try_emplace(StringRef Key, ArgsTy &&... Args) {
+            return Emplace(Key, false, std::forward<ArgsTy>(Args)...);
+        }
+
+        /// Like try_emplace, but a new entry refers to the storage of \p Key
+        /// instead of copying it (see OrderedStringMapKey), so the storage
+        /// must outlive the entry. Used for keys from an interning table.
+        template<typename... ArgsTy>
+        std::pair<iterator, bool> try_emplace_external(StringRef Key,
+                                                       ArgsTy &&... Args) {
+            return Emplace(Key, true, std::forward<ArgsTy>(Args)...);
+        }
+
+        // clear - Empties out the OrderedStringMap
+        void clear() {
+            Entries.clear();
+            Index.clear();
+        }
+
+        /// erase - Remove the entry, shifting later entries down to keep their
+        /// order.
+        void erase(iterator I) {
+            Entries.erase(I);
+            RebuildIndex();
+        }
+
+        bool erase(StringRef Key) {
+            iterator I = find(Key);
+            if (I == end()) return false;
+            erase(I);
+            return true;
+        }
+
+    private:
+        template<typename... ArgsTy>
+        std::pair<iterator, bool> Emplace(StringRef Key, bool External,
+                                          ArgsTy &&... Args) {
+            int I = FindKey(Key);
+            if (I != -1) return std::make_pair(begin() + I, false);
+
+            if (Entries.size() < Entries.capacity()) {
+                Entries.emplace_back(OrderedStringMapKey(Key, External),
+                                     std::forward<ArgsTy>(Args)...);
+            } else {
+                // Key or Args may refer into this map; build the entry before
+                // growing invalidates them.
+                value_type Entry(OrderedStringMapKey(Key, External),
+                                 std::forward<ArgsTy>(Args)...);
+                Entries.push_back(std::move(Entry));
+            }
+            AddToIndex(Entries.size() - 1);
+            return std::make_pair(end() - 1, true);
+        }
+
+        static bool KeyEquals(const value_type &Entry, StringRef Key) {
+            StringRef EntryKey = Entry.getKey();
+            // keys from the same interning table compare by address
+            return EntryKey.size() == Key.size() &&
+                   (Key.empty() || EntryKey.data() == Key.data() ||
+                    std::memcmp(EntryKey.data(), Key.data(), Key.size()) == 0);
+        }
+
+        int FindKey(StringRef Key) const {
+            if (Index.empty()) {
+                for (unsigned I = 0, E = Entries.size(); I != E; ++I) {
+                    if (KeyEquals(Entries[I], Key)) return I;
+                }
+                return -1;
+            }
+            return FindKey(Key, HashString(Key));
+        }
+
+        int FindKey(StringRef Key, unsigned FullHashValue) const {
+            if (Index.empty()) return FindKey(Key);
+            unsigned Mask = Index.size() - 1;
+            for (unsigned Slot = FullHashValue & Mask;; Slot = (Slot + 1) & Mask) {
+                unsigned Pos = Index[Slot];
+                if (Pos == 0) return -1;
+                if (KeyEquals(Entries[Pos - 1], Key)) return Pos - 1;
+            }
+        }
+
+        // Index slots hold entry position + 1 so that zero marks an empty slot.
+        void InsertIntoIndex(unsigned Pos) {
+            unsigned Mask = Index.size() - 1;
+            unsigned Slot = HashString(Entries[Pos].getKey()) & Mask;
+            while (Index[Slot] != 0) Slot = (Slot + 1) & Mask;
+            Index[Slot] = Pos + 1;
+        }
+
+        void AddToIndex(unsigned Pos) {
+            // keep the load factor at or below one half
+            if (Entries.size() <= IndexThreshold) return;
+            if (Index.size() < Entries.size() * 2) {
+                RebuildIndex();
+            } else {
+                InsertIntoIndex(Pos);
+            }
+        }
+
+        void RebuildIndex() {
+            if (Entries.size() <= IndexThreshold) {
+                Index.clear();
+                return;
+            }
+            Index.assign(NextPowerOf2(Entries.size() * 2 - 1), 0);
+            for (unsigned I = 0, E = Entries.size(); I != E; ++I) InsertIntoIndex(I);
+        }
+
+        SmallVector<value_type, InlineEntries> Entries;
+        std::vector<unsigned> Index;
+    };
+
+/// Maps are equal if they hold the same keys with equal values, in any order.
+    template<typename ValueTy, unsigned N>
+    bool operator==(const OrderedStringMap<ValueTy, N> &lhs,
+                    const OrderedStringMap<ValueTy, N> &rhs) {
+        if (&lhs == &rhs) return true;
+        if (lhs.size() != rhs.size()) return false;
+        for (const auto &Entry : lhs) {
+            auto it = rhs.find(Entry.getKey());
+            if (it == rhs.end() || !(it->second == Entry.second)) return false;
+        }
+        return true;
+    }
+
+    template<typename ValueTy, unsigned N>
+    inline bool operator!=(const OrderedStringMap<ValueTy, N> &lhs,
+                           const OrderedStringMap<ValueTy, N> &rhs) {
+        return !(lhs == rhs);
+    }
+
+/// Orders maps by their sorted key sets, like StringMap.
+    template<typename ValueTy, unsigned N>
+    bool operator<(const OrderedStringMap<ValueTy, N> &lhs,
+                   const OrderedStringMap<ValueTy, N> &rhs) {
+        if (&lhs == &rhs) return false;
+
+        SmallVector<StringRef, 16> lhs_keys;
+        lhs_keys.reserve(lhs.size());
+        for (const auto &Entry : lhs) lhs_keys.push_back(Entry.getKey());
+        std::sort(lhs_keys.begin(), lhs_keys.end());
+
+        SmallVector<StringRef, 16> rhs_keys;
+        rhs_keys.reserve(rhs.size());
+        for (const auto &Entry : rhs) rhs_keys.push_back(Entry.getKey());
+        std::sort(rhs_keys.begin(), rhs_keys.end());
+
+        return lhs_keys < rhs_keys;
+    }
+
+    template<typename ValueTy, unsigned N>
+    inline bool operator<=(const OrderedStringMap<ValueTy, N> &lhs,
+                           const OrderedStringMap<ValueTy, N> &rhs) {
+        return !(rhs < lhs);
+    }
+
+    template<typename ValueTy, unsigned N>
+    inline bool operator>(const OrderedStringMap<ValueTy, N> &lhs,
+                          const OrderedStringMap<ValueTy, N> &rhs) {
+        return !(lhs <= rhs);
+    }
+
+    template<typename ValueTy, unsigned N>
+    inline bool operator>=(const OrderedStringMap<ValueTy, N> &lhs,
+                           const OrderedStringMap<ValueTy, N> &rhs) {
+        return !(lhs < rhs);
+    }
+
+}  // namespace wpi
+
+#endif  // WPIUTIL_WPI_ORDEREDSTRINGMAP_H_
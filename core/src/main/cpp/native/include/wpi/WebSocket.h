@@ -32,6 +32,8 @@ namespace wpi {
  * RFC 6455 compliant WebSocket client and server implementation.
  */
     class WebSocket : public std::enable_shared_from_this<WebSocket> {
+        friend class WebSocketBroadcaster;
+
         struct private_init {
         };
 
@@ -43,6 +45,7 @@ namespace wpi {
         static constexpr uint8_t kOpPong = 0x0A;
         static constexpr uint8_t kOpMask = 0x0F;
         static constexpr uint8_t kFlagFin = 0x80;
+        static constexpr uint8_t kFlagCompressed = 0x40;  // RSV1
         static constexpr uint8_t kFlagMasking = 0x80;
         static constexpr uint8_t kLenMask = 0x7f;
 
@@ -75,6 +78,60 @@ namespace wpi {
             CLOSED
         };
 
+        /**
+         * permessage-deflate (RFC 7692) compression options.  Each connection
+         * that negotiates the extension has its own compression contexts.
+         */
+        struct DeflateOptions {
+            DeflateOptions()
+                    : enable{false},
+                      serverNoContextTakeover{false},
+                      clientNoContextTakeover{false},
+                      serverMaxWindowBits{15},
+                      clientMaxWindowBits{15},
+                      level{-1},
+                      minSize{64},
+                      offloadSize{64 * 1024} {}
+
+            /** Offer (client) or accept (server) the extension. */
+            bool enable;  // NOLINT
+
+            /**
+             * Reset the server's compression context after every message.  This
+             * lowers the compression ratio of similar messages, as each one is
+             * compressed on its own.  A server also honors a client's request.
+             */
+            bool serverNoContextTakeover;  // NOLINT
+
+            /** Reset the client's compression context after every message. */
+            bool clientNoContextTakeover;  // NOLINT
+
+            /**
+             * Base-2 logarithm of the server's LZ77 window size, 9 to 15.
+             * Smaller windows use less memory per connection and compress less.
+             */
+            int serverMaxWindowBits;  // NOLINT
+
+            /**
+             * Base-2 logarithm of the client's LZ77 window size, 9 to 15.  A
+             * server can only limit this if the client offers to accept a limit.
+             */
+            int clientMaxWindowBits;  // NOLINT
+
+            /** zlib compression level, 0 to 9, or -1 for zlib's default. */
+            int level;  // NOLINT
+
+            /** Smaller messages are sent uncompressed. */
+            size_t minSize;  // NOLINT
+
+            /**
+             * Messages at least this large are compressed on the loop's thread
+             * pool rather than the loop thread.  Messages sent while one is
+             * being compressed are queued behind it to keep them in order.
+             */
+            size_t offloadSize;  // NOLINT
+        };
+
         /**
          * Client connection options.
          */
@@ -86,6 +143,9 @@ namespace wpi {
 
             /** Additional headers to include in handshake. */
             ArrayRef <std::pair<StringRef, StringRef>> extraHeaders;
+
+            /** Compression to offer to the server. */
+            DeflateOptions deflate;
         };
 
         /**
@@ -134,10 +194,14 @@ namespace wpi {
          *                client request
          * @param protocol The subprotocol to send to the client (in the
          *                 Sec-WebSocket-Protocol header field).
+         * @param extensions The value of the Sec-WebSocket-Extensions header
+         *                   field(s) in the client request, comma separated
+         * @param deflate Compression to accept if the client offers it
          */
         static std::shared_ptr <WebSocket> CreateServer(
                 uv::Stream &stream, StringRef key, StringRef version,
-                StringRef protocol = StringRef{});
+                StringRef protocol = StringRef{}, StringRef extensions = StringRef{},
+                const DeflateOptions &deflate = DeflateOptions{});
 
         /**
          * Get connection state.
@@ -160,6 +224,12 @@ namespace wpi {
          */
         StringRef GetProtocol() const { return m_protocol; }
 
+        /**
+         * Get whether the permessage-deflate extension was negotiated.  Only
+         * valid in or after the open() event.
+         */
+        bool IsDeflateEnabled() const { return m_deflate != nullptr; }
+
         /**
          * Set the maximum message size.  Default is 128 KB.  If configured to combine
          * fragments this maximum applies to the entire message (all combined
@@ -176,6 +246,32 @@ namespace wpi {
          */
         void SetCombineFragments(bool combine) { m_combineFragments = combine; }
 
+        /**
+         * Set the write queue watermarks.  Once more than high bytes are waiting
+         * to be sent, IsWritable() returns false until the queue drains to low
+         * bytes, when the writable event is emitted.  Default is 1 MB high and
+         * 256 KB low.  Sends are not limited; callers should stop sending, or
+         * use the coalescing send functions, while the connection is not
+         * writable.
+         * @param high High watermark in bytes
+         * @param low Low watermark in bytes
+         */
+        void SetWriteWatermarks(size_t high, size_t low) {
+            m_highWatermark = high;
+            m_lowWatermark = low;
+        }
+
+        /**
+         * Get the number of bytes waiting to be sent, including messages waiting
+         * to be compressed.
+         */
+        size_t GetWriteQueueSize() const;
+
+        /**
+         * Get whether the write queue is below the high watermark.
+         */
+        bool IsWritable() const { return m_writable; }
+
         /**
          * Initiate a closing handshake.
          * @param code A numeric status code (defaults to 1005, no status code)
@@ -232,6 +328,30 @@ namespace wpi {
             Send(kOpBinary, data, callback);
         }
 
+        /**
+         * Send a text message, keeping only the latest message for each key
+         * while the connection is not writable.  Held messages are sent, in the
+         * order their keys were first held, when the write queue drains to the
+         * low watermark.  Useful for telemetry where only the current value of
+         * each topic matters.  The data is copied.  Messages are dropped if the
+         * connection is not open.
+         * @param key Key identifying the value, e.g. a topic name
+         * @param data UTF-8 encoded data to send
+         */
+        void SendTextCoalesced(StringRef key, ArrayRef <uv::Buffer> data) {
+            SendCoalesced(kFlagFin | kOpText, key, data);
+        }
+
+        /**
+         * Send a binary message, keeping only the latest message for each key
+         * while the connection is not writable.  See SendTextCoalesced().
+         * @param key Key identifying the value, e.g. a topic name
+         * @param data Data to send
+         */
+        void SendBinaryCoalesced(StringRef key, ArrayRef <uv::Buffer> data) {
+            SendCoalesced(kFlagFin | kOpBinary, key, data);
+        }
+
         /**
          * Send a continuation frame.  This is used to send additional parts of a
          * message started with SendTextFragment() or SendBinaryFragment().
@@ -337,14 +457,16 @@ namespace wpi {
         /**
          * Text message event.  Emitted when a text message is received.
          * The first parameter is the data, the second parameter is true if the
-         * data is the last fragment of the message.
+         * data is the last fragment of the message.  The data may point into
+         * the stream's read buffer and is only valid during the callback.
          */
         sig::Signal<StringRef, bool> text;
 
         /**
          * Binary message event.  Emitted when a binary message is received.
          * The first parameter is the data, the second parameter is true if the
-         * data is the last fragment of the message.
+         * data is the last fragment of the message.  The data may point into
+         * the stream's read buffer and is only valid during the callback.
          */
         sig::Signal<ArrayRef<uint8_t>, bool> binary;
 
@@ -358,6 +480,13 @@ namespace wpi {
          */
         sig::Signal <ArrayRef<uint8_t>> pong;
 
+        /**
+         * Writable event.  Emitted when the write queue has drained to the low
+         * watermark after going over the high watermark, once any coalesced
+         * messages have been sent.
+         */
+        sig::Signal<> writable;
+
     private:
         // user data
         std::shared_ptr<void> m_data;
@@ -372,9 +501,12 @@ namespace wpi {
         // user-settable configuration
         size_t m_maxMessageSize = 128 * 1024;
         bool m_combineFragments = true;
+        size_t m_highWatermark = 1024 * 1024;
+        size_t m_lowWatermark = 256 * 1024;
 
         // operating state
         State m_state = CONNECTING;
+        bool m_writable = true;
 
         // incoming message buffers/state
         SmallVector<uint8_t, 14> m_header;
@@ -389,10 +521,21 @@ namespace wpi {
 
         std::unique_ptr <ClientHandshakeData> m_clientHandshake;
 
+        // permessage-deflate contexts, if negotiated
+        class DeflateData;
+
+        std::unique_ptr <DeflateData> m_deflate;
+
+        // latest coalesced messages held while not writable
+        class CoalesceData;
+
+        std::unique_ptr <CoalesceData> m_coalesce;
+
         void StartClient(const Twine &uri, const Twine &host,
                          ArrayRef <StringRef> protocols, const ClientOptions &options);
 
-        void StartServer(StringRef key, StringRef version, StringRef protocol);
+        void StartServer(StringRef key, StringRef version, StringRef protocol,
+                         StringRef extensions, const DeflateOptions &deflate);
 
         void SendClose(uint16_t code, const Twine &reason);
 
@@ -405,6 +548,35 @@ namespace wpi {
         void Send(
                 uint8_t opcode, ArrayRef <uv::Buffer> data,
                 std::function<void(MutableArrayRef < uv::Buffer > , uv::Error)> callback);
+
+        void SendDeflated(
+                uint8_t opcode, ArrayRef <uv::Buffer> data,
+                std::function<void(MutableArrayRef < uv::Buffer > , uv::Error)> callback);
+
+        void SendPending();
+
+        void SendCoalesced(uint8_t opcode, StringRef key, ArrayRef <uv::Buffer> data);
+
+        // Update the writable state after the write queue grew or shrank
+        void UpdateWritable();
+
+        // Write a frame encoded by EncodeHeader(), in order with other messages
+        void SendEncoded(
+                ArrayRef <uv::Buffer> frame,
+                std::function<void(MutableArrayRef < uv::Buffer > , uv::Error)> callback);
+
+        /**
+         * Encode a frame header into out, which must have room for 10 bytes.
+         * The masking key, if any, is not included.
+         * @return Header size
+         */
+        static size_t EncodeHeader(uint8_t *out, uint8_t opcode, bool masking,
+                                   uint64_t size);
+
+        void SendFrame(
+                uint8_t opcode, ArrayRef <uv::Buffer> data,
+                MutableArrayRef <uv::Buffer> compressed,
+                std::function<void(MutableArrayRef < uv::Buffer > , uv::Error)> callback);
     };
 
 }  // namespace wpi
@@ -0,0 +1,136 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#ifndef WPIUTIL_WPI_WEBSOCKETBROADCASTER_H_
+#define WPIUTIL_WPI_WEBSOCKETBROADCASTER_H_
+
+#include <stdint.h>
+
+#include <memory>
+#include <vector>
+
+#include "wpi/ArrayRef.h"
+#include "wpi/StringRef.h"
+#include "wpi/WebSocket.h"
+#include "wpi/uv/Buffer.h"
+
+namespace wpi {
+
+/**
+ * Sends the same messages to a set of WebSockets.  Each message is encoded
+ * once into a reference-counted frame that is written to every server-side
+ * connection as is, so the cost per connection is a single write.  Client-side
+ * connections must mask their frames, so they are sent a masked copy.
+ *
+ * Connections whose write queue is over a limit are handled according to the
+ * overflow policy.  Connections are removed when they close.  All functions
+ * must be called from the loop thread.
+ */
+    class WebSocketBroadcaster {
+    public:
+        /**
+         * What to do with a message for a connection whose write queue is over
+         * the limit.
+         */
+        enum Overflow {
+            /** Drop the message for that connection. */
+            kDrop = 0,
+            /**
+             * Keep the latest message only while the connection is not
+             * writable (see WebSocket::SetWriteWatermarks()), and send it on
+             * the connection's writable event.
+             */
+            kCoalesce,
+            /**
+             * Fail the connection with close code 1008.  The close frame is
+             * sent after the messages already queued to it; if they have not
+             * been sent within a second, e.g. because the peer has stopped
+             * reading, the stream is closed without waiting further.
+             */
+            kDisconnect
+        };
+
+        /**
+         * Constructor.
+         * @param overflow Overflow policy
+         * @param maxQueued Write queue limit in bytes for kDrop and kDisconnect;
+         *                  a message is sent to a connection if fewer bytes are
+         *                  waiting to be sent
+         */
+        explicit WebSocketBroadcaster(Overflow overflow = kDrop,
+                                      size_t maxQueued = 256 * 1024);
+
+        ~WebSocketBroadcaster();
+
+        WebSocketBroadcaster(const WebSocketBroadcaster &) = delete;
+
+        WebSocketBroadcaster &operator=(const WebSocketBroadcaster &) = delete;
+
+        /**
+         * Add a connection.  It is removed again when it closes.  Connections
+         * that are not open are ignored.
+         * @param ws WebSocket
+         */
+        void Add(WebSocket &ws);
+
+        /**
+         * Remove a connection.  Messages already queued to it are still sent.
+         * @param ws WebSocket
+         */
+        void Remove(WebSocket &ws);
+
+        /**
+         * Get the number of connections.
+         */
+        size_t GetSize() const;
+
+        /**
+         * Send a text message to all connections.  The data is copied, so the
+         * buffers can be reused as soon as this returns.
+         * @param data UTF-8 encoded data to send
+         */
+        void SendText(ArrayRef <uv::Buffer> data) {
+            Send(WebSocket::kFlagFin | WebSocket::kOpText, data);
+        }
+
+        /**
+         * Send a text message to all connections.
+         * @param data UTF-8 encoded data to send
+         */
+        void SendText(StringRef data) { SendText(uv::Buffer{data}); }
+
+        /**
+         * Send a binary message to all connections.  The data is copied, so the
+         * buffers can be reused as soon as this returns.
+         * @param data Data to send
+         */
+        void SendBinary(ArrayRef <uv::Buffer> data) {
+            Send(WebSocket::kFlagFin | WebSocket::kOpBinary, data);
+        }
+
+        /**
+         * Send a binary message to all connections.
+         * @param data Data to send
+         */
+        void SendBinary(ArrayRef <uint8_t> data) { SendBinary(uv::Buffer{data}); }
+
+    private:
+        class Frame;
+
+        class Client;
+
+        void Send(uint8_t opcode, ArrayRef <uv::Buffer> data);
+
+        void Deliver(Client &client, const std::shared_ptr <Frame> &frame);
+
+        Overflow m_overflow;
+        size_t m_maxQueued;
+        std::vector <std::shared_ptr<Client>> m_clients;
+        // Remove() only marks clients while Send() iterates over them
+        bool m_sending = false;
+    };
+
+}  // namespace wpi
+
+#endif  // WPIUTIL_WPI_WEBSOCKETBROADCASTER_H_
@@ -73,10 +73,13 @@ namespace wpi {
          * reader) before calling this.  See also WebSocket::CreateServer().
          * @param stream Connection stream
          * @param protocol The subprotocol to send to the client
+         * @param deflate Compression to accept if the client offers it
          */
-        std::shared_ptr <WebSocket> Accept(uv::Stream &stream,
-                                           StringRef protocol = StringRef{}) {
-            return WebSocket::CreateServer(stream, m_key, m_version, protocol);
+        std::shared_ptr <WebSocket> Accept(
+                uv::Stream &stream, StringRef protocol = StringRef{},
+                const WebSocket::DeflateOptions &deflate = WebSocket::DeflateOptions{}) {
+            return WebSocket::CreateServer(stream, m_key, m_version, protocol,
+                                           m_extensions, deflate);
         }
 
         bool IsUpgrade() const { return m_gotHost && m_websocket; }
@@ -90,6 +93,7 @@ namespace wpi {
         bool m_gotHost = false;
         bool m_websocket = false;
         SmallVector<std::string, 2> m_protocols;
+        std::string m_extensions;
         SmallString<64> m_key;
         SmallString<16> m_version;
     };
@@ -117,6 +121,12 @@ namespace wpi {
              * default all hosts are accepted.
              */
             std::function<bool(StringRef)> checkHost;
+
+            /**
+             * Compression to accept if the client offers it.  By default
+             * messages are not compressed.
+             */
+            WebSocket::DeflateOptions deflate;
         };
 
         /**
@@ -60,6 +60,8 @@ SOFTWARE.
 #include <vector> // vector
 
 #include "wpi/ArrayRef.h"
+#include "wpi/OrderedStringMap.h"
+#include "wpi/SmallVector.h"
 #include "wpi/StringMap.h"
 #include "wpi/StringRef.h"
 #include "wpi/Twine.h"
@@ -95,6 +97,19 @@ within a JSON document. It can be used with functions `at` and
 */
     class json_pointer;
 
+    class json_compiled_pointer;
+
+/*!
+@brief SAX interface
+
+@sa json::sax_parse
+*/
+    class json_sax;
+
+    class json_writer;
+
+    class json_stream_parser;
+
 /*!
 @brief default JSON class
 
@@ -2155,10 +2170,459 @@ create @ref const_reverse_iterator).
         };
     }  // namespace detail
 
+/*!
+@brief monotonic arena for JSON documents
+
+Passed to json::parse(), json::from_cbor() or json::from_msgpack(), an arena
+provides the object, array and string payloads of the values being parsed:
+the object_t, array_t and string_t instances that each such value points to.
+They are bump-allocated instead of coming from the heap one by one, and are
+not freed individually; the arena hands all of its memory back at once when
+it is destroyed or reset.
+
+That is all an arena provides. The containers keep their standard
+allocators, so the element storage of arrays, the members of objects and the
+contents of long strings still come from the heap, and destroying the
+document still visits every value and frees those buffers. Teardown is
+therefore not O(1): an arena removes roughly a third of the allocations of a
+typical message, not all of them.
+
+No other value is ever allocated from an arena: members added to the document
+later, and copies taken from it, are ordinary heap values. The arena must
+outlive the document and every value moved out of it. An arena must not be
+shared between threads.
+
+@sa json::parse(StringRef, json_arena&, const parser_callback_t, const bool)
+*/
+    class json_arena {
+    public:
+        /// @param[in] block_size  size of each block requested from the heap
+        explicit json_arena(std::size_t block_size = 4096) noexcept
+                : m_block_size(block_size) {}
+
+        ~json_arena();
+
+        json_arena(const json_arena &) = delete;
+
+        json_arena &operator=(const json_arena &) = delete;
+
+        /// allocate memory aligned for any type; never fails
+        void *allocate(std::size_t size);
+
+        /// release all memory; nothing allocated from the arena may be used after
+        void reset() noexcept;
+
+        /// total number of bytes handed out since construction or reset()
+        std::size_t bytes_allocated() const noexcept { return m_bytes; }
+
+    private:
+        struct block {
+            block *next;
+        };
+
+        block *m_blocks = nullptr;
+        char *m_cur = nullptr;
+        char *m_end = nullptr;
+        std::size_t m_block_size;
+        std::size_t m_bytes = 0;
+    };
+
+/*!
+@brief table of interned object keys
+
+Passed to json::parse(), json::from_cbor(), json::from_msgpack() or a
+json_stream_parser, a key table is used for the object keys that parser reads:
+each is looked up in the table, and the object refers to the table's copy of
+the key instead of allocating its own. Messages that share the same key names
+then share the key storage, and looking up a key through the table's copy
+compares addresses rather than characters. Keys of up to
+OrderedStringMapKey::MaxInline bytes are stored inline in objects anyway and
+are not interned. Keys added any other way, e.g. by json::operator[], are
+owned by their object.
+
+The table must outlive every object with keys from it, including objects
+moved out of the document; copies of objects own their keys. A table must not
+be shared between threads. Once it holds @a max_keys keys or @a max_bytes
+bytes of key text, new keys are no longer interned, which bounds its size for
+untrusted input.
+*/
+    class json_key_table {
+    public:
+        /**
+         * @param[in] max_keys   the number of keys to intern at most
+         * @param[in] max_bytes  the total length of the keys to intern at most
+         */
+        explicit json_key_table(std::size_t max_keys = 4096,
+                                std::size_t max_bytes = 256 * 1024) noexcept
+                : m_max_keys(max_keys), m_max_bytes(max_bytes) {}
+
+        json_key_table(const json_key_table &) = delete;
+
+        json_key_table &operator=(const json_key_table &) = delete;
+
+        /*!
+        @brief intern a key
+
+        @return the table's copy of @a key, or a null StringRef if @a key is
+                not in the table and adding it would exceed a limit
+        */
+        StringRef intern(StringRef key);
+
+        /// number of interned keys
+        std::size_t size() const noexcept { return m_keys.size(); }
+
+        /// total length of the interned keys
+        std::size_t bytes() const noexcept { return m_bytes; }
+
+    private:
+        StringMap<char> m_keys;
+        std::size_t m_bytes = 0;
+        std::size_t m_max_keys;
+        std::size_t m_max_bytes;
+    };
+
+/*!
+@brief SAX interface
+
+Receives the values of a JSON text as a sequence of events from
+@ref json::sax_parse, without a DOM being built. Each event returns whether
+parsing should continue; returning `false` stops the parse, which is how a
+handler that has found what it needs avoids reading the rest of the input.
+
+The default implementations accept and ignore everything, so a handler only
+overrides the events it cares about.
+*/
+    class json_sax {
+        friend class json;
+
+        friend class json_stream_parser;
+
+    public:
+        virtual ~json_sax() = default;
+
+        /// a null value was read
+        virtual bool null() { return true; }
+
+        /// a boolean value was read
+        virtual bool boolean(bool /*val*/) { return true; }
+
+        /// a negative integer number was read
+        virtual bool number_integer(int64_t /*val*/) { return true; }
+
+        /// a non-negative integer number was read
+        virtual bool number_unsigned(uint64_t /*val*/) { return true; }
+
+        /// a floating-point number was read
+        virtual bool number_float(double /*val*/) { return true; }
+
+        /// a string was read; @a val is only valid during the call
+        virtual bool string(StringRef /*val*/) { return true; }
+
+        /// the beginning of an object was read
+        virtual bool start_object() { return true; }
+
+        /// an object key was read; @a val is only valid during the call
+        virtual bool key(StringRef /*val*/) { return true; }
+
+        /// the end of an object was read
+        virtual bool end_object() { return true; }
+
+        /// the beginning of an array was read
+        virtual bool start_array() { return true; }
+
+        /// the end of an array was read
+        virtual bool end_array() { return true; }
+
+        /*!
+        @brief a parse error occurred; parsing stops after this call
+
+        @param[in] position    the position in the input where the error occurs
+        @param[in] last_token  the last read token
+        @param[in] ex          an exception object describing the error
+        */
+        virtual void parse_error(std::size_t /*position*/, StringRef /*last_token*/,
+                                 const detail::exception & /*ex*/) {}
+
+    protected:
+        /*!
+        @brief skip a value without reporting its contents
+
+        Called from key(), skips the member's value. Called from
+        start_object() or start_array(), skips the container's contents;
+        the matching end_object() or end_array() is still reported. The
+        skipped input is checked for syntax but produces no events and
+        allocates nothing.
+        */
+        void skip_value() { m_skip = true; }
+
+    private:
+        bool m_skip = false;
+    };
+
+/*!
+@brief streaming JSON writer
+
+Writes compact JSON text to a stream as a sequence of events, without
+building a @ref json value; the output is byte-for-byte what json::dump()
+produces for the same value. The events are those of @ref json_sax, so a
+writer can also be handed to json::sax_parse() to re-serialize input. The
+caller is responsible for emitting a well-formed sequence of events.
+
+@sa json_binding.h for writing structs directly
+*/
+    class json_writer final : public json_sax {
+    public:
+        /*!
+        @param[in] os            stream to write to
+        @param[in] ensure_ascii  whether to escape non-ASCII characters with
+                                 \uXXXX sequences
+        */
+        explicit json_writer(raw_ostream &os, bool ensure_ascii = false)
+                : m_os(os), m_ensure_ascii(ensure_ascii) {}
+
+        bool null() override;
+
+        bool boolean(bool val) override;
+
+        bool number_integer(int64_t val) override;
+
+        bool number_unsigned(uint64_t val) override;
+
+        /// non-finite values are written as null, as by json::dump()
+        bool number_float(double val) override;
+
+        /// @throw type_error.316 if @a val is not valid UTF-8
+        bool string(StringRef val) override;
+
+        bool start_object() override;
+
+        /// @throw type_error.316 if @a val is not valid UTF-8
+        bool key(StringRef val) override;
+
+        bool end_object() override;
+
+        bool start_array() override;
+
+        bool end_array() override;
+
+        /// write a complete JSON value as one event
+        void value(const json &val);
+
+    private:
+        /// write a comma if a value precedes this one in its container
+        void separator();
+
+        raw_ostream &m_os;
+        const bool m_ensure_ascii;
+        bool m_need_comma = false;
+    };
+
+/*!
+@brief incremental JSON parser
+
+Parses JSON text that arrives in pieces, such as the data read from a
+network stream, without first collecting the whole text. Each piece is
+handed to feed() as it arrives; events are reported to a @ref json_sax as
+soon as the input completing them has been fed, so parsing overlaps with
+receiving. Only a string, number or literal split across pieces is
+buffered, until its end arrives. Nesting is tracked on the heap, so deep
+input does not recurse.
+
+By default the input is a single JSON text. With @a multiple set, any
+number of values separated by whitespace is accepted, which covers
+newline-delimited JSON; memory use is then bounded by the largest value
+rather than the stream.
+
+@code
+json_stream_parser parser(
+    [](json &&val) { ... },  // called once per complete value
+    true);
+stream.data.connect([&](uv::Buffer &buf, size_t len) {
+  parser.feed(StringRef(buf.base, len));
+});
+stream.end.connect([&] { parser.finish(); });
+@endcode
+
+Events and errors follow json::sax_parse(): a UTF-8 byte order mark at the
+start of the input is skipped, a syntax error is reported by
+json_sax::parse_error(), and json_sax::skip_value() is honored. After an
+error, or after the handler returns false, the parser rejects all input
+until reset().
+*/
+    class json_stream_parser {
+    public:
+        /*!
+        @param[in] sax       handler to report events to
+        @param[in] multiple  whether to accept a sequence of values
+        */
+        explicit json_stream_parser(json_sax *sax, bool multiple = false);
+
+        /*!
+        @brief parse into json values
+
+        Builds each complete top-level value and passes it to @a on_value.
+        Syntax errors are thrown from feed() and finish() as by json::parse().
+
+        @param[in] on_value  called with each value read
+        @param[in] multiple  whether to accept a sequence of values
+        */
+        explicit json_stream_parser(std::function<void(json &&)> on_value,
+                                    bool multiple = false);
+
+        /*!
+        @brief parse into json values, interning object keys
+
+        Like json_stream_parser(std::function<void(json &&)>, bool), with long
+        object keys interned in @a keys; see @ref json_key_table.
+        */
+        json_stream_parser(std::function<void(json &&)> on_value,
+                           json_key_table &keys, bool multiple = false);
+
+        ~json_stream_parser();
+
+        json_stream_parser(const json_stream_parser &) = delete;
+
+        json_stream_parser &operator=(const json_stream_parser &) = delete;
+
+        /*!
+        @brief parse the next piece of input
+
+        @return false if the input is malformed or the handler stopped the
+                parse (now or before)
+        */
+        bool feed(StringRef data);
+
+        /// @copydoc feed(StringRef)
+        bool feed(ArrayRef <uint8_t> data) {
+            return feed(StringRef(reinterpret_cast<const char *>(data.data()),
+                                  data.size()));
+        }
+
+        /*!
+        @brief signal the end of the input
+
+        Completes a top-level number that was waiting for a delimiter, and
+        checks that no value was left incomplete.
+
+        @return whether the input was well-formed and completely parsed
+        */
+        bool finish();
+
+        /// discard all state to parse a new input
+        void reset();
+
+        /// whether a complete value was read and no other one is in progress
+        bool done() const noexcept {
+            return m_state == state::done or
+                   (m_state == state::value and m_stack.empty() and
+                    m_token == token::none and m_values != 0);
+        }
+
+        /// the number of bytes fed so far, after any byte order mark
+        std::size_t get_position() const noexcept { return m_position; }
+
+    private:
+        class value_builder;
+
+        /// what the parser expects next, outside of a token
+        enum class state : uint8_t {
+            value,         ///< a value
+            array_first,   ///< a value or `]`
+            object_first,  ///< a key or `}`
+            key,           ///< a key
+            colon,         ///< a `:`
+            next,          ///< a `,` or the end of the container
+            done,          ///< nothing but whitespace
+            failed         ///< nothing; an error occurred or the parse was stopped
+        };
+
+        /// the kind of token being read
+        enum class token : uint8_t {
+            none, string, key, number, literal
+        };
+
+        /// find the end of a string token; returns the position after it
+        const char *scan_string(const char *p, const char *end, bool &complete);
+
+        /*!
+        @brief find the end of a number token
+
+        Follows the number grammar so that the token ends exactly where the
+        lexer would end it. A byte the grammar rejects is taken into the token
+        for the lexer to report.
+        */
+        const char *scan_number(const char *p, const char *end, bool &complete);
+
+        /// find the end of a `true`, `false` or `null` token
+        const char *scan_literal(const char *p, const char *end, bool &complete);
+
+        /// report the token ending at @a end, which may have begun in an
+        /// earlier piece
+        bool end_token(const char *begin, const char *end);
+
+        /// lex and report a whole token
+        bool emit_token(const char *begin, const char *end);
+
+        bool emit_key(StringRef key);
+
+        /// a value was read; move on to what may follow it
+        bool value_done();
+
+        bool start_container(bool object);
+
+        bool end_container();
+
+        /*!
+        @brief report input that does not fit the current state
+
+        @param[in] position  offset of the input in the stream
+        @param[in] c         the offending byte, or EOF for the end of input
+        */
+        bool unexpected(std::size_t position, int c);
+
+        /// report an error to the handler and reject further input
+        bool fail(std::size_t position, StringRef last_token,
+                  const detail::exception &ex);
+
+        /// the handler stopped the parse; reject further input
+        bool stop();
+
+        json_sax *m_sax;
+        std::unique_ptr<value_builder> m_builder;
+        const bool m_multiple;
+
+        state m_state = state::value;
+        token m_token = token::none;
+        /// whether the last string byte fed was an unpaired backslash
+        bool m_escape = false;
+        /// number grammar state, or bytes matched of m_literal
+        uint8_t m_substate = 0;
+        /// the literal being read
+        const char *m_literal = nullptr;
+        /// whether the handler asked to skip the next value
+        bool m_skip_next = false;
+        /// whether to report the end of the skipped container at m_quiet
+        bool m_quiet_end = false;
+        /// nesting depth whose contents are skipped, or 0
+        std::size_t m_quiet = 0;
+        /// open containers, true for objects
+        SmallVector<bool, 32> m_stack;
+        /// the start of a token split across pieces
+        std::string m_buffer;
+        std::size_t m_token_position = 0;
+        std::size_t m_position = 0;
+        std::size_t m_values = 0;
+        /// bytes of a byte order mark matched at the start of the input, or 3
+        /// once past it
+        uint8_t m_bom = 0;
+    };
+
     class json_pointer {
         // allow json to access private members
         friend class json;
 
+        friend class json_compiled_pointer;
+
         friend class JsonTest;
 
     public:
@@ -2380,6 +2844,107 @@ create @ref const_reverse_iterator).
         std::vector <std::string> reference_tokens;
     };
 
+/*!
+@brief JSON pointer prepared for repeated lookups
+
+A @ref json_pointer stores its reference tokens as strings, so each lookup
+hashes every key and parses every array index again. This form does that
+work once, when it is constructed: keys are stored with their hash and
+tokens that are array indices with their value. Lookups then cost a hash
+table probe (or, in small objects, a few key comparisons) and an index per
+level.
+
+@code
+static const json_compiled_pointer x("/pose/x");
+double val = doc.at(x).get<double>();
+@endcode
+
+Lookups can additionally be memoized with find(doc, generation): the node
+found is remembered with the document's address and the caller's
+generation number, and returned directly as long as both match. The caller
+must change the generation whenever the document may have been modified,
+as inserting into or erasing from any object or array on the path can move
+the node. The memo makes the const lookup functions unsafe to call on the
+same pointer from several threads at once.
+*/
+    class json_compiled_pointer {
+    public:
+        /// prepare @a ptr
+        explicit json_compiled_pointer(const json_pointer &ptr);
+
+        /*!
+        @brief prepare the JSON pointer @a s
+
+        @throw parse_error.107 if @a s is nonempty and does not begin with '/'
+        @throw parse_error.108 if a '~' is not followed by '0' or '1'
+        */
+        explicit json_compiled_pointer(const Twine &s = {})
+                : json_compiled_pointer(json_pointer(s)) {}
+
+        /*!
+        @brief the value at this pointer in @a doc, with the checks and
+               exceptions of json::at(const json_pointer&)
+
+        @throw parse_error.106   if an array index begins with '0'
+        @throw parse_error.109   if an array index is not a number
+        @throw out_of_range.401  if an array index is out of range
+        @throw out_of_range.402  if the array index '-' is used
+        @throw out_of_range.403  if a key is not found
+        @throw out_of_range.404  if the pointer cannot be resolved
+        */
+        json &get(json &doc) const;
+
+        /// @copydoc get(json&) const
+        const json &get(const json &doc) const;
+
+        /// the value at this pointer in @a doc, or nullptr if there is none
+        json *find(json &doc) const noexcept;
+
+        /// @copydoc find(json&) const
+        const json *find(const json &doc) const noexcept;
+
+        /*!
+        @brief the value at this pointer in @a doc, or nullptr if there is
+               none, remembering the result for @a generation of @a doc
+
+        @param[in] doc         the document to search
+        @param[in] generation  changed by the caller whenever @a doc may have
+                               been modified since the last call
+        */
+        const json *find(const json &doc, uint64_t generation) const noexcept;
+
+        /// forget the memoized lookup
+        void reset_memo() const noexcept { m_memo_doc = nullptr; }
+
+        /// return a string representation of the JSON pointer
+        std::string to_string() const;
+
+    private:
+        /// what a reference token means when applied to an array
+        enum class index_kind : uint8_t {
+            index,         ///< a valid array index
+            end,           ///< "-", one past the last element
+            leading_zero,  ///< digits with a leading zero
+            not_a_number   ///< anything else
+        };
+
+        struct token {
+            std::string key;
+            unsigned hash;
+            index_kind kind;
+            std::size_t index;
+        };
+
+        /// the value at @a ptr, or nullptr if there is none
+        const json *resolve(const json *ptr) const noexcept;
+
+        SmallVector<token, 4> m_tokens;
+
+        mutable const json *m_memo_doc = nullptr;
+        mutable uint64_t m_memo_generation = 0;
+        mutable const json *m_memo_node = nullptr;
+    };
+
     template<typename, typename>
     struct adl_serializer {
         /*!
@@ -2480,6 +3045,9 @@ Format](http://rfc7159.net/rfc7159)
         template<detail::value_t> friend
         struct detail::external_constructor;
         friend ::wpi::json_pointer;
+        friend ::wpi::json_compiled_pointer;
+        friend ::wpi::json_writer;
+        friend ::wpi::json_stream_parser;
 
         template<typename BasicJsonType>
         friend
@@ -2654,10 +3222,10 @@ Format](http://rfc7159.net/rfc7159)
       one of the values for a given key will be chosen. For instance,
       `{"key": 2, "key": 1}` could be equal to either `{"key": 1}` or
       `{"key": 2}`.
-    - Internally, name/value pairs are stored in lexicographical order of the
-      names. Objects will also be serialized (see @ref dump) in this order.
-      For instance, `{"b": 1, "a": 2}` and `{"a": 2, "b": 1}` will be stored
-      and serialized as `{"a": 2, "b": 1}`.
+    - Name/value pairs are stored in the order they were inserted, and
+      objects are serialized (see @ref dump) in that order. For instance,
+      `{"b": 1, "a": 2}` is stored and serialized as `{"b": 1, "a": 2}`.
+      Assigning to an existing name keeps its position.
     - When comparing objects, the order of the name/value pairs is irrelevant.
       This makes objects interoperable in the sense that they will not be
       affected by these differences. For instance, `{"b": 1, "a": 2}` and
@@ -2679,17 +3247,20 @@ Format](http://rfc7159.net/rfc7159)
     access to object values, a pointer of type `object_t*` must be
     dereferenced.
 
-    @since version 1.0.0
+    The pairs themselves are kept in a flat vector with room for a few of them
+    inline, which is searched linearly; larger objects add a hash index on top.
+    See @ref OrderedStringMap.
+
+    Because the pairs are stored contiguously, adding a member may move all of
+    them: any insertion into an object invalidates every reference, pointer
+    and iterator to its members, and erasing a member invalidates those to the
+    members after it. For example, `json& a = j["a"]; j["b"] = 1; a = 2;`
+    writes through a dangling reference. Look members up again after the
+    object has been modified.
 
-    @note The order name/value pairs are added to the object is *not*
-    preserved by the library. Therefore, iterating an object may return
-    name/value pairs in a different order than they were originally stored. In
-    fact, keys will be traversed in alphabetical order as `std::map` with
-    `std::less` is used by default. Please note this behavior conforms to [RFC
-    7159](http://rfc7159.net/rfc7159), because any order implements the
-    specified "unordered" nature of JSON objects.
+    @since version 1.0.0
     */
-        using object_t = StringMap<json>;
+        using object_t = OrderedStringMap<json>;
 
         /*!
     @brief a type for an array
@@ -2739,6 +3310,15 @@ Format](http://rfc7159.net/rfc7159)
             return object.release();
         }
 
+        /// like create(), but allocates from @a arena unless it is null
+        template<typename T, typename... Args>
+        static T *create_in(json_arena *arena, Args &&... args) {
+            if (!arena) {
+                return create<T>(std::forward<Args>(args)...);
+            }
+            return ::new(arena->allocate(sizeof(T))) T(std::forward<Args>(args)...);
+        }
+
         ////////////////////////
         // JSON value storage //
         ////////////////////////
@@ -2836,7 +3416,8 @@ Format](http://rfc7159.net/rfc7159)
                 array = create<array_t>(std::move(value));
             }
 
-            void destroy(value_t t) noexcept;
+            /// destroy the payload; arena payloads are not freed
+            void destroy(value_t t, bool in_arena) noexcept;
         };
 
         /*!
@@ -3454,12 +4035,14 @@ Format](http://rfc7159.net/rfc7159)
     */
         json(json &&other) noexcept
                 : m_type(std::move(other.m_type)),
+                  m_in_arena(other.m_in_arena),
                   m_value(std::move(other.m_value)) {
             // check that passed value is valid
             other.assert_invariant();
 
             // invalidate payload
             other.m_type = value_t::null;
+            other.m_in_arena = false;
             other.m_value = {};
 
             assert_invariant();
@@ -3499,6 +4082,7 @@ Format](http://rfc7159.net/rfc7159)
 
             using std::swap;
             swap(m_type, other.m_type);
+            swap(m_in_arena, other.m_in_arena);
             swap(m_value, other.m_value);
 
             assert_invariant();
@@ -3522,7 +4106,7 @@ Format](http://rfc7159.net/rfc7159)
     */
         ~json() noexcept {
             assert_invariant();
-            m_value.destroy(m_type);
+            m_value.destroy(m_type, m_in_arena);
         }
 
         /// @}
@@ -3578,6 +4162,35 @@ Format](http://rfc7159.net/rfc7159)
         void dump(raw_ostream &os, int indent = -1, const char indent_char = ' ',
                   const bool ensure_ascii = false) const;
 
+        /*!
+    @brief serialization on several threads
+
+    Writes the same bytes as dump(), but arrays and objects with many
+    elements, at the top level or nested in smaller containers, are split
+    into runs of elements that are serialized concurrently. Each run is
+    written to @a os once it and the runs before it are complete, so @a os
+    can forward the output as it arrives, e.g. as an HTTP chunked body.
+    Everything else is serialized on the calling thread.
+
+    @param[in] os  the stream to write to
+    @param[in] indent  as dump()
+    @param[in] indent_char  as dump()
+    @param[in] ensure_ascii  as dump()
+    @param[in] threads  number of threads to use, including the calling
+    thread; 0 (the default) for std::thread::hardware_concurrency()
+
+    @throw type_error.316 if a string stored inside the JSON value is not
+                          UTF-8 encoded; the output written before ends at
+                          a run boundary at or before the invalid string
+
+    @complexity Linear. The helper threads come from a pool that is shared by
+    all calls and started on first use.
+    */
+        void dump_parallel(raw_ostream &os, int indent = -1,
+                           const char indent_char = ' ',
+                           const bool ensure_ascii = false,
+                           unsigned int threads = 0) const;
+
         /*!
     @brief return the type of the JSON value (explicit)
 
@@ -4576,6 +5189,9 @@ Format](http://rfc7159.net/rfc7159)
 
     @return reference to the element at key @a key
 
+    @post If a member was added, references, pointers and iterators to the
+    members of this object are invalidated; see @ref object_t.
+
     @throw type_error.305 if the JSON value is not an object or null; in that
     cases, using the [] operator with a key makes no sense.
 
@@ -4637,6 +5253,9 @@ Format](http://rfc7159.net/rfc7159)
 
     @return reference to the element at key @a key
 
+    @post If a member was added, references, pointers and iterators to the
+    members of this object are invalidated; see @ref object_t.
+
     @throw type_error.305 if the JSON value is not an object or null; in that
     cases, using the [] operator with a key makes no sense.
 
@@ -4995,11 +5614,7 @@ Format](http://rfc7159.net/rfc7159)
                     }
 
                     if (is_string()) {
-                        std::allocator <std::string> alloc;
-                        std::allocator_traits<decltype(alloc)>::destroy(alloc, m_value.string);
-                        std::allocator_traits<decltype(alloc)>::deallocate(alloc, m_value.string,
-                                                                           1);
-                        m_value.string = nullptr;
+                        destroy_payload();
                     }
 
                     m_type = value_t::null;
@@ -5093,11 +5708,7 @@ Format](http://rfc7159.net/rfc7159)
                     }
 
                     if (is_string()) {
-                        std::allocator <std::string> alloc;
-                        std::allocator_traits<decltype(alloc)>::destroy(alloc, m_value.string);
-                        std::allocator_traits<decltype(alloc)>::deallocate(alloc, m_value.string,
-                                                                           1);
-                        m_value.string = nullptr;
+                        destroy_payload();
                     }
 
                     m_type = value_t::null;
@@ -5130,8 +5741,8 @@ Format](http://rfc7159.net/rfc7159)
     `std::map` type, the return value will always be `0` (@a key was not
     found) or `1` (@a key was found).
 
-    @post References and iterators to the erased elements are invalidated.
-    Other references and iterators are not affected.
+    @post References and iterators to the erased element and to the members
+    after it are invalidated; see @ref object_t.
 
     @throw type_error.307 when called on a type other than JSON object;
     example: `"cannot use erase() with null"`
@@ -5816,6 +6427,9 @@ Format](http://rfc7159.net/rfc7159)
 
     @param[in] val the value to add to the JSON object
 
+    @post If a member was added, references, pointers and iterators to the
+    members of this object are invalidated; see @ref object_t.
+
     @throw type_error.308 when called on a type other than JSON object or
     null; example: `"cannot use push_back() with number"`
 
@@ -5947,6 +6561,9 @@ Format](http://rfc7159.net/rfc7159)
             already-existing element if no insertion happened, and a bool
             denoting whether the insertion took place.
 
+    @post If the insertion took place, references, pointers and iterators to
+    the other members of this object are invalidated; see @ref object_t.
+
     @throw type_error.311 when called on a type other than JSON object or
     null; example: `"cannot use emplace() with number"`
 
@@ -6108,6 +6725,9 @@ Format](http://rfc7159.net/rfc7159)
     @param[in] first begin of the range of elements to insert
     @param[in] last end of the range of elements to insert
 
+    @post If any member was added, references, pointers and iterators to the
+    members of this object are invalidated; see @ref object_t.
+
     @throw type_error.309 if called on JSON values other than objects; example:
     `"cannot use insert() with string"`
     @throw invalid_iterator.202 if iterator @a first or @a last does does not
@@ -6132,6 +6752,9 @@ Format](http://rfc7159.net/rfc7159)
 
     @param[in] j  JSON object to read values from
 
+    @post If any member was added, references, pointers and iterators to the
+    members of this object are invalidated; see @ref object_t.
+
     @throw type_error.312 if called on JSON values other than objects; example:
     `"cannot use update() with string"`
 
@@ -6155,6 +6778,9 @@ Format](http://rfc7159.net/rfc7159)
     @param[in] first begin of the range of elements to insert
     @param[in] last end of the range of elements to insert
 
+    @post If any member was added, references, pointers and iterators to the
+    members of this object are invalidated; see @ref object_t.
+
     @throw type_error.312 if called on JSON values other than objects; example:
     `"cannot use update() with string"`
     @throw invalid_iterator.202 if iterator @a first or @a last does does not
@@ -6198,6 +6824,7 @@ Format](http://rfc7159.net/rfc7159)
         std::is_nothrow_move_assignable<json_value>::value
         ) {
             std::swap(m_type, other.m_type);
+            std::swap(m_in_arena, other.m_in_arena);
             std::swap(m_value, other.m_value);
             assert_invariant();
         }
@@ -6708,12 +7335,79 @@ Format](http://rfc7159.net/rfc7159)
                           const parser_callback_t cb = nullptr,
                           const bool allow_exceptions = true);
 
+        /*!
+    @brief deserialize into an arena
+
+    Like @ref parse, but the object, array and string payloads of the parsed
+    values are allocated from @a arena. Their element storage is not; see
+    @ref json_arena for what this saves and for the lifetime rules.
+    */
+        static json parse(StringRef s, json_arena &arena,
+                          const parser_callback_t cb = nullptr,
+                          const bool allow_exceptions = true);
+
+        static json parse(ArrayRef <uint8_t> arr, json_arena &arena,
+                          const parser_callback_t cb = nullptr,
+                          const bool allow_exceptions = true);
+
+        /*!
+    @brief deserialize, interning object keys
+
+    Like @ref parse, but long object keys are interned in @a keys; see
+    @ref json_key_table for the lifetime rules.
+    */
+        static json parse(StringRef s, json_key_table &keys,
+                          const parser_callback_t cb = nullptr,
+                          const bool allow_exceptions = true);
+
+        static json parse(ArrayRef <uint8_t> arr, json_key_table &keys,
+                          const parser_callback_t cb = nullptr,
+                          const bool allow_exceptions = true);
+
+        /*!
+    @brief deserialize into an arena, interning object keys
+
+    Combines parse(StringRef, json_arena&, const parser_callback_t, const bool)
+    and parse(StringRef, json_key_table&, const parser_callback_t, const bool).
+    */
+        static json parse(StringRef s, json_arena &arena, json_key_table &keys,
+                          const parser_callback_t cb = nullptr,
+                          const bool allow_exceptions = true);
+
+        static json parse(ArrayRef <uint8_t> arr, json_arena &arena,
+                          json_key_table &keys,
+                          const parser_callback_t cb = nullptr,
+                          const bool allow_exceptions = true);
+
         static bool accept(StringRef s);
 
         static bool accept(ArrayRef <uint8_t> arr);
 
         static bool accept(raw_istream &i);
 
+        /*!
+    @brief parse input and report its contents as SAX events
+
+    Drives @a sax with the same lexer as @ref parse, but builds no DOM. The
+    handler can stop the parse early or skip subtrees; see @ref json_sax.
+
+    @param[in] s       input to read from
+    @param[in] sax     handler receiving the events
+    @param[in] strict  whether the input must end after the first value; when
+                       false and reading from a stream, input after the value
+                       is left in the stream
+
+    @return whether the parse ran to completion: false after a parse error
+            (reported through json_sax::parse_error) or when the handler
+            stopped it
+    */
+        static bool sax_parse(StringRef s, json_sax *sax, const bool strict = true);
+
+        static bool sax_parse(ArrayRef <uint8_t> arr, json_sax *sax,
+                              const bool strict = true);
+
+        static bool sax_parse(raw_istream &i, json_sax *sax, const bool strict = true);
+
         /*!
     @brief deserialize from stream
 
@@ -6788,9 +7482,38 @@ Format](http://rfc7159.net/rfc7159)
         /// the type of the current element
         value_t m_type = value_t::null;
 
+        /// whether the payload of m_value was allocated from a json_arena
+        bool m_in_arena = false;
+
         /// the value of the current element
         json_value m_value = {};
 
+        /// destroy the payload of a string, array or object, leaving no payload
+        void destroy_payload() noexcept {
+            m_value.destroy(m_type, m_in_arena);
+            m_value = {};
+            m_in_arena = false;
+        }
+
+        /*!
+        @brief add a member to @a obj unless it has one with key @a key
+
+        Long keys are interned in @a keys, if it is not null and not full.
+
+        @return as OrderedStringMap::try_emplace()
+        */
+        template<typename... Args>
+        static auto emplace_member(json_key_table *keys, object_t &obj, StringRef key,
+                                   Args &&... args) {
+            if (keys and key.size() > OrderedStringMapKey::MaxInline) {
+                StringRef interned = keys->intern(key);
+                if (interned.data() != nullptr) {
+                    return obj.try_emplace_external(interned, std::forward<Args>(args)...);
+                }
+            }
+            return obj.try_emplace(key, std::forward<Args>(args)...);
+        }
+
         //////////////////////////////////////////
         // binary serialization/deserialization //
         //////////////////////////////////////////
@@ -6870,8 +7593,17 @@ Format](http://rfc7159.net/rfc7159)
           - half and single-precision floats (0xF9-0xFA)
           - break (0xFF)
 
+    @note With @a use_typed_arrays, arrays of two or more floats (and nothing
+          else) are written as an RFC 8746 typed array instead: tag 86
+          (0xD8 0x56) on a byte string of little endian float64s. This saves
+          a byte per element and lets readers copy the elements in bulk, but
+          only readers that know RFC 8746 understand it. @ref from_cbor
+          reads all integer and float16/32/64 typed arrays back into arrays.
+
     @param[in] j  JSON value to serialize
-    @return MessagePack serialization as byte vector
+    @param[in] use_typed_arrays  whether to write arrays of floats as typed
+                                 arrays
+    @return CBOR serialization as byte vector
 
     @complexity Linear in the size of the JSON value @a j.
 
@@ -6887,13 +7619,17 @@ Format](http://rfc7159.net/rfc7159)
 
     @since version 2.0.9
     */
-        static std::vector <uint8_t> to_cbor(const json &j);
+        static std::vector <uint8_t> to_cbor(const json &j,
+                                             const bool use_typed_arrays = false);
 
-        static ArrayRef <uint8_t> to_cbor(const json &j, std::vector <uint8_t> &buf);
+        static ArrayRef <uint8_t> to_cbor(const json &j, std::vector <uint8_t> &buf,
+                                          const bool use_typed_arrays = false);
 
-        static ArrayRef <uint8_t> to_cbor(const json &j, SmallVectorImpl <uint8_t> &buf);
+        static ArrayRef <uint8_t> to_cbor(const json &j, SmallVectorImpl <uint8_t> &buf,
+                                          const bool use_typed_arrays = false);
 
-        static void to_cbor(raw_ostream &os, const json &j);
+        static void to_cbor(raw_ostream &os, const json &j,
+                            const bool use_typed_arrays = false);
 
         /*!
     @brief create a MessagePack serialization of a given JSON value
@@ -6958,7 +7694,15 @@ Format](http://rfc7159.net/rfc7159)
           serialized properly. This behavior differs from the @ref dump()
           function which serializes NaN or Infinity to `null`.
 
+    @note With @a use_typed_arrays, arrays of two or more floats (and nothing
+          else) are packed into an ext value (fixext 16 or ext 8..32) of ext
+          type 86 holding little endian float64s. MessagePack has no typed
+          arrays, so this library uses the RFC 8746 tag numbers as ext types;
+          other readers see an opaque ext value. @ref from_msgpack reads ext
+          types 64..86 back into arrays as @ref from_cbor does the tags.
+
     @param[in] j  JSON value to serialize
+    @param[in] use_typed_arrays  whether to pack arrays of floats
     @return MessagePack serialization as byte vector
 
     @complexity Linear in the size of the JSON value @a j.
@@ -6975,13 +7719,17 @@ Format](http://rfc7159.net/rfc7159)
 
     @since version 2.0.9
     */
-        static std::vector <uint8_t> to_msgpack(const json &j);
+        static std::vector <uint8_t> to_msgpack(const json &j,
+                                                const bool use_typed_arrays = false);
 
-        static ArrayRef <uint8_t> to_msgpack(const json &j, std::vector <uint8_t> &buf);
+        static ArrayRef <uint8_t> to_msgpack(const json &j, std::vector <uint8_t> &buf,
+                                             const bool use_typed_arrays = false);
 
-        static ArrayRef <uint8_t> to_msgpack(const json &j, SmallVectorImpl <uint8_t> &buf);
+        static ArrayRef <uint8_t> to_msgpack(const json &j, SmallVectorImpl <uint8_t> &buf,
+                                             const bool use_typed_arrays = false);
 
-        static void to_msgpack(raw_ostream &os, const json &j);
+        static void to_msgpack(raw_ostream &os, const json &j,
+                               const bool use_typed_arrays = false);
 
         /*!
     @brief create a UBJSON serialization of a given JSON value
@@ -7179,6 +7927,45 @@ Format](http://rfc7159.net/rfc7159)
     */
         static json from_cbor(ArrayRef <uint8_t> arr, const bool strict = true);
 
+        /*!
+    @brief create a JSON value from CBOR, allocating it from @a arena
+
+    @sa json_arena
+    */
+        static json from_cbor(ArrayRef <uint8_t> arr, json_arena &arena,
+                              const bool strict = true);
+
+        /*!
+    @brief create a JSON value from CBOR, interning object keys in @a keys
+
+    @sa json_key_table
+    */
+        static json from_cbor(ArrayRef <uint8_t> arr, json_key_table &keys,
+                              const bool strict = true);
+
+        /*!
+    @brief create a JSON value from CBOR, allocating it from @a arena and
+    interning object keys in @a keys
+    */
+        static json from_cbor(ArrayRef <uint8_t> arr, json_arena &arena,
+                              json_key_table &keys, const bool strict = true);
+
+        /*!
+    @brief read CBOR input and report its contents as SAX events
+
+    Scalars are decoded as by @ref from_cbor; strings, arrays and maps are
+    reported to @a sax without building JSON values. Values skipped with
+    json_sax::skip_value() are still decoded, but not reported.
+
+    @return whether the input was read to completion: false after a parse
+            error (reported through json_sax::parse_error) or when the handler
+            stopped it
+
+    @sa sax_parse(StringRef, json_sax*, const bool)
+    */
+        static bool sax_parse_cbor(ArrayRef <uint8_t> arr, json_sax *sax,
+                                   const bool strict = true);
+
         /*!
     @brief create a JSON value from an input in MessagePack format
 
@@ -7260,6 +8047,38 @@ Format](http://rfc7159.net/rfc7159)
     */
         static json from_msgpack(ArrayRef <uint8_t> arr, const bool strict = true);
 
+        /*!
+    @brief create a JSON value from MessagePack, allocating it from @a arena
+
+    @sa json_arena
+    */
+        static json from_msgpack(ArrayRef <uint8_t> arr, json_arena &arena,
+                                 const bool strict = true);
+
+        /*!
+    @brief create a JSON value from MessagePack, interning object keys in @a keys
+
+    @sa json_key_table
+    */
+        static json from_msgpack(ArrayRef <uint8_t> arr, json_key_table &keys,
+                                 const bool strict = true);
+
+        /*!
+    @brief create a JSON value from MessagePack, allocating it from @a arena and
+    interning object keys in @a keys
+    */
+        static json from_msgpack(ArrayRef <uint8_t> arr, json_arena &arena,
+                                 json_key_table &keys, const bool strict = true);
+
+        /*!
+    @brief read MessagePack input and report its contents as SAX events
+
+    Scalars are decoded as by @ref from_msgpack; otherwise this behaves like
+    @ref sax_parse_cbor.
+    */
+        static bool sax_parse_msgpack(ArrayRef <uint8_t> arr, json_sax *sax,
+                                      const bool strict = true);
+
         /*!
     @brief create a JSON value from an input in UBJSON format
 
@@ -7475,6 +8294,23 @@ Format](http://rfc7159.net/rfc7159)
             return ptr.get_checked(this);
         }
 
+        /*!
+    @brief access specified element via a prepared JSON Pointer
+
+    As @ref at(const json_pointer&), without parsing array indices or hashing
+    keys again.
+
+    @sa json_compiled_pointer
+    */
+        reference at(const json_compiled_pointer &ptr) {
+            return ptr.get(*this);
+        }
+
+        /// @copydoc at(const json_compiled_pointer&)
+        const_reference at(const json_compiled_pointer &ptr) const {
+            return ptr.get(*this);
+        }
+
         /*!
     @brief return flattened JSON value
 
@@ -7587,6 +8423,7 @@ Format](http://rfc7159.net/rfc7159)
     value.,patch}
 
     @sa @ref diff -- create a JSON patch by comparing two JSON values
+    @sa @ref patch_inplace -- apply a JSON patch without copying the value
 
     @sa [RFC 6902 (JSON Patch)](https://tools.ietf.org/html/rfc6902)
     @sa [RFC 6901 (JSON Pointer)](https://tools.ietf.org/html/rfc6901)
@@ -7595,6 +8432,30 @@ Format](http://rfc7159.net/rfc7159)
     */
         json patch(const json &json_patch) const;
 
+        /*!
+    @brief applies a JSON patch to this value
+
+    Same as @ref patch, but changes the current value instead of returning a
+    patched copy of it, so applying a small patch to a large document costs
+    only the operations themselves. Values moved by a "move" operation are
+    moved rather than copied.
+
+    @param[in] json_patch  JSON patch document
+
+    @note The application of the patch is not atomic: if an operation fails,
+          the exception is thrown with the operations before it applied. Use
+          @ref patch where the value must be left unchanged on errors.
+
+    @throw parse_error.104, parse_error.105, out_of_range.401,
+    out_of_range.403, out_of_range.405, other_error.501 as @ref patch
+
+    @complexity Linear in the length of the JSON patch and the size of the
+    values it adds, replaces, copies, or tests.
+
+    @sa @ref patch -- apply a JSON patch to a copy of the value
+    */
+        void patch_inplace(const json &json_patch);
+
         /*!
     @brief creates a diff as a JSON patch
 
@@ -7608,7 +8469,9 @@ Format](http://rfc7159.net/rfc7159)
     @endcode
 
     @note Currently, only `remove`, `add`, and `replace` operations are
-          generated.
+          generated. Objects are compared member by member, so only changed
+          leaves (and added or removed members and elements) produce
+          operations; equal subtrees produce none.
 
     @param[in] source  JSON value to compare from
     @param[in] target  JSON value to compare against
@@ -7631,6 +8494,13 @@ Format](http://rfc7159.net/rfc7159)
         static json diff(const json &source, const json &target,
                          const std::string &path = "");
 
+    private:
+        /// append the operations of diff(source, target) to @a result;
+        /// @a path is extended for the children and restored on return
+        static void diff_into(const json &source, const json &target,
+                              std::string &path, json &result);
+
+    public:
         /// @}
 
         ////////////////////////////////
@@ -7678,12 +8548,47 @@ Format](http://rfc7159.net/rfc7159)
     a JSON document.,merge_patch}
 
     @sa @ref patch -- apply a JSON patch
+    @sa @ref merge_diff -- create a JSON Merge Patch by comparing two values
     @sa [RFC 7396 (JSON Merge Patch)](https://tools.ietf.org/html/rfc7396)
 
     @since version 3.0.0
     */
         void merge_patch(const json &patch);
 
+        /*!
+    @brief creates a diff as a JSON Merge Patch
+
+    Creates a [JSON Merge Patch](https://tools.ietf.org/html/rfc7396) so that
+    value @a source can be changed into the value @a target by calling
+    @ref merge_patch. Unchanged members are left out, nested objects are
+    diffed recursively, and removed members are set to null; arrays and
+    other values that changed are included as a whole. For objects whose
+    members mostly stay the same, this is usually smaller than @ref diff.
+
+    @invariant For two JSON values @a source and @a target where @a target
+    has no null members, the following code yields always `true`:
+    @code {.cpp}
+    auto result = source;
+    result.merge_patch(merge_diff(source, target));
+    result == target;
+    @endcode
+
+    @note A merge patch cannot set a member to null; null members of
+          @a target are removed from the patched value instead.
+
+    @param[in] source  JSON value to compare from
+    @param[in] target  JSON value to compare against
+
+    @return a JSON Merge Patch to convert the @a source to @a target; an
+            empty object if both are equal objects
+
+    @complexity Linear in the lengths of @a source and @a target.
+
+    @sa @ref merge_patch -- apply a JSON Merge Patch
+    @sa @ref diff -- create a JSON patch by comparing two JSON values
+    */
+        static json merge_diff(const json &source, const json &target);
+
         /// @}
     };
 } // namespace wpi
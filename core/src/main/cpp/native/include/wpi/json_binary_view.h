@@ -0,0 +1,356 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#ifndef WPIUTIL_WPI_JSON_BINARY_VIEW_H_
+#define WPIUTIL_WPI_JSON_BINARY_VIEW_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "wpi/ArrayRef.h"
+#include "wpi/SmallVector.h"
+#include "wpi/StringRef.h"
+#include "wpi/json.h"
+
+namespace wpi {
+
+/*!
+@brief read-only view of a CBOR or MessagePack value, decoded on access
+
+Navigates an encoded value in place instead of building a @ref json value
+from it: looking up a key or index skips over the values before it without
+decoding them, scalars are decoded when read, and strings are returned as
+StringRef pointing into the buffer. Nothing is allocated, so reading a few
+fields of a large message costs only the bytes walked over.
+
+@code
+auto frame = json_binary_view::cbor(data);
+double x = frame["pose"]["x"].get<double>();
+StringRef id = frame["id"].get<StringRef>();
+@endcode
+
+Lookups that fail return an invalid view, whose type() is
+value_t::discarded, so lookups can be chained and checked once at the end.
+CBOR typed arrays and the MessagePack ext values json::to_cbor() and
+json::to_msgpack() pack them into are arrays of numbers; get_array() copies
+them out in one piece.
+The buffer must outlive all views and iterators into it. Malformed input is
+only noticed where it is walked over, and throws the exceptions
+json::from_cbor() and json::from_msgpack() would.
+*/
+    class json_binary_view {
+    public:
+        using value_t = json::value_t;
+
+        /// the encoding of the viewed bytes
+        enum class format : uint8_t {
+            cbor, msgpack
+        };
+
+        class iterator;
+
+        /// an invalid view
+        json_binary_view() = default;
+
+        /// view the CBOR value at the start of @a data
+        static json_binary_view cbor(ArrayRef <uint8_t> data) {
+            return json_binary_view(format::cbor, data.begin(), data.begin(),
+                                    data.end());
+        }
+
+        /// view the MessagePack value at the start of @a data
+        static json_binary_view msgpack(ArrayRef <uint8_t> data) {
+            return json_binary_view(format::msgpack, data.begin(), data.begin(),
+                                    data.end());
+        }
+
+        /*!
+        @brief the type of the value
+
+        @return value_t::discarded for an invalid view
+        @throw parse_error.110 if the input ends within the value's header
+        @throw parse_error.112 if the value's encoding is not supported
+        */
+        value_t type() const;
+
+        bool valid() const noexcept { return m_pos != nullptr; }
+
+        explicit operator bool() const noexcept { return valid(); }
+
+        bool is_null() const { return type() == value_t::null; }
+
+        bool is_boolean() const { return type() == value_t::boolean; }
+
+        bool is_number() const {
+            value_t t = type();
+            return t == value_t::number_integer or t == value_t::number_unsigned or
+                   t == value_t::number_float;
+        }
+
+        bool is_string() const { return type() == value_t::string; }
+
+        bool is_array() const { return type() == value_t::array; }
+
+        bool is_object() const { return type() == value_t::object; }
+
+        /*!
+        @brief the number of elements of an array or members of an object
+
+        @return as json::size(): 0 for null, 1 for other scalars, and 0 for
+                invalid views
+        */
+        std::size_t size() const;
+
+        /*!
+        @brief the member with key @a key
+
+        @return the member, or an invalid view if there is none or this is
+                not an object
+        */
+        json_binary_view operator[](StringRef key) const;
+
+        /*!
+        @brief the element at @a index
+
+        @return the element, or an invalid view if there is none or this is
+                not an array
+        */
+        json_binary_view operator[](std::size_t index) const;
+
+        /*!
+        @brief the member with key @a key
+
+        @throw type_error.304 if this is not an object
+        @throw out_of_range.403 if there is no such member
+        */
+        json_binary_view at(StringRef key) const;
+
+        /*!
+        @brief the element at @a index
+
+        @throw type_error.304 if this is not an array
+        @throw out_of_range.401 if there is no such element
+        */
+        json_binary_view at(std::size_t index) const;
+
+        /// whether this is an object with a member with key @a key
+        bool contains(StringRef key) const { return (*this)[key].valid(); }
+
+        /*!
+        @brief the value, converted as by json::get()
+
+        Numbers convert to any arithmetic type; strings are read as StringRef
+        (pointing into the buffer) or std::string.
+
+        @throw type_error.302 if the value does not have a compatible type
+        @throw type_error.302 for a CBOR string of indefinite length read as
+               StringRef, as it is not contiguous in the buffer
+        */
+        template<typename T>
+        T get() const {
+            if constexpr (std::is_same<T, bool>::value) {
+                return get_boolean();
+            } else if constexpr (std::is_arithmetic<T>::value) {
+                scalar s = get_number();
+                switch (s.type) {
+                    case value_t::number_integer:
+                        return static_cast<T>(s.integer);
+                    case value_t::number_unsigned:
+                        return static_cast<T>(s.unsigned_integer);
+                    default:
+                        return static_cast<T>(s.floating);
+                }
+            } else if constexpr (std::is_same<T, StringRef>::value) {
+                return get_string_ref();
+            } else if constexpr (std::is_same<T, std::string>::value) {
+                return get_string();
+            } else {
+                static_assert(std::is_same<T, json>::value,
+                              "type cannot be read from a json_binary_view");
+                return materialize();
+            }
+        }
+
+        /*!
+        @brief read an array of numbers into @a out
+
+        Typed arrays of float64 in host byte order are copied with a single
+        memcpy; other arrays are converted element by element.
+
+        @throw type_error.302 if this is not an array of numbers
+        */
+        void get_array(SmallVectorImpl<double> &out) const;
+
+        /// @copydoc get_array(SmallVectorImpl<double>&) const
+        void get_array(std::vector<double> &out) const;
+
+        /// decode the value into a json value
+        json materialize() const;
+
+        /*!
+        @brief the encoded bytes of the value
+
+        For an element of a typed array, these are its packed bytes rather
+        than a CBOR or MessagePack value.
+        */
+        ArrayRef <uint8_t> raw() const;
+
+        /// iterate over the elements of an array or the members of an object
+        iterator begin() const;
+
+        iterator end() const;
+
+    private:
+        friend class iterator;
+
+        json_binary_view(format fmt, const uint8_t *base, const uint8_t *pos,
+                         const uint8_t *end, uint8_t element = 0)
+                : m_base(base), m_pos(pos), m_end(end), m_format(fmt),
+                  m_element(element) {}
+
+        /// a decoded header, with the value of scalars
+        struct scalar {
+            value_t type;
+            /// length of strings, element or member count of containers
+            uint64_t length;
+            /// CBOR strings and containers of indefinite length
+            bool indefinite;
+            /// the RFC 8746 tag of typed arrays, 0 for other values
+            uint8_t typed;
+            /// after the header: the string bytes, the first element, or the
+            /// next value for other scalars
+            const uint8_t *data;
+            union {
+                bool boolean;
+                int64_t integer;
+                uint64_t unsigned_integer;
+                double floating;
+            };
+        };
+
+        scalar decode(const uint8_t *pos) const;
+
+        /*!
+        @brief the position after the header of the item at @a pos, and
+               after the bytes of a string
+
+        @param[out] children  the number of items nested in a container
+                              (twice the member count for objects), or
+                              ~0 for indefinite length
+        */
+        const uint8_t *step(const uint8_t *pos, uint64_t &children) const;
+
+        /// the position after the value at @a pos
+        const uint8_t *skip(const uint8_t *pos) const;
+
+        /*!
+        @brief compare the member key at @a pos with @a key
+
+        @return the position after the key
+        @throw parse_error.113 if the key is not a string
+        */
+        const uint8_t *match_key(const uint8_t *pos, StringRef key,
+                                 bool &match) const;
+
+        json_binary_view find(StringRef key) const;
+
+        json_binary_view element(std::size_t index) const;
+
+        json_binary_view view_at(const uint8_t *pos) const {
+            return json_binary_view(m_format, m_base, pos, m_end);
+        }
+
+        bool get_boolean() const;
+
+        scalar get_number() const;
+
+        StringRef get_string_ref() const;
+
+        std::string get_string() const;
+
+        /*!
+        @brief the element count of an array, checked against the bytes left
+               (at least one per element) so a corrupt header cannot make
+               get_array() allocate more than the input could hold
+
+        @throw type_error.302 if this is not an array
+        @throw parse_error.110 if the input is too short for the count
+        */
+        std::size_t array_size() const;
+
+        /// read the numbers of an array of array_size() elements into @a out
+        void get_array(double *out) const;
+
+        [[noreturn]] void type_mismatch(const char *expected) const;
+
+        const uint8_t *m_base = nullptr;
+        const uint8_t *m_pos = nullptr;
+        const uint8_t *m_end = nullptr;
+        format m_format = format::cbor;
+        /// for elements of a typed array, the tag of the array
+        uint8_t m_element = 0;
+    };
+
+/*!
+@brief iterator over the elements of an array or members of an object
+
+Dereferences to the element or member value; key() gives the member key.
+*/
+    class json_binary_view::iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = json_binary_view;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const json_binary_view *;
+        using reference = json_binary_view;
+
+        iterator() = default;
+
+        /// the member key; StringRef() for arrays
+        StringRef key() const;
+
+        json_binary_view value() const;
+
+        json_binary_view operator*() const { return value(); }
+
+        iterator &operator++();
+
+        iterator operator++(int) {
+            iterator tmp = *this;
+            ++(*this);
+            return tmp;
+        }
+
+        bool operator==(const iterator &rhs) const {
+            return at_end() ? rhs.at_end() : m_pos == rhs.m_pos;
+        }
+
+        bool operator!=(const iterator &rhs) const { return not(*this == rhs); }
+
+    private:
+        friend class json_binary_view;
+
+        iterator(const json_binary_view &container, const uint8_t *pos,
+                 uint64_t left, bool indefinite, bool object, uint8_t element)
+                : m_container(container), m_pos(pos), m_left(left),
+                  m_indefinite(indefinite), m_object(object), m_element(element) {}
+
+        bool at_end() const;
+
+        json_binary_view m_container;
+        const uint8_t *m_pos = nullptr;
+        uint64_t m_left = 0;
+        bool m_indefinite = false;
+        bool m_object = false;
+        /// the tag of typed arrays
+        uint8_t m_element = 0;
+    };
+
+}  // namespace wpi
+
+#endif  // WPIUTIL_WPI_JSON_BINARY_VIEW_H_
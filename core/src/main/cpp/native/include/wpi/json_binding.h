@@ -0,0 +1,549 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#ifndef WPIUTIL_WPI_JSON_BINDING_H_
+#define WPIUTIL_WPI_JSON_BINDING_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "wpi/ArrayRef.h"
+#include "wpi/SmallVector.h"
+#include "wpi/StringRef.h"
+#include "wpi/json.h"
+
+/*
+ * Compile-time binding between structs and JSON.
+ *
+ * A struct is bound by specializing json_binding with a constexpr table of
+ * its fields:
+ *
+ *   struct Pose { double x, y, theta; std::string frame; };
+ *
+ *   template <>
+ *   struct wpi::json_binding<Pose> {
+ *     static constexpr auto fields = wpi::json_fields(
+ *         WPI_JSON_FIELD(Pose, x), WPI_JSON_FIELD(Pose, y),
+ *         WPI_JSON_FIELD(Pose, theta), WPI_JSON_FIELD(Pose, frame));
+ *   };
+ *
+ * write_json() then serializes a Pose straight to a raw_ostream, and
+ * read_json(), read_cbor() and read_msgpack() fill one in straight from the
+ * parser's SAX events; neither direction builds a json value. Field keys are
+ * looked up with a perfect hash computed at compile time.
+ *
+ * Fields may be bool, arithmetic types, std::string, std::vector and
+ * std::array of supported types, or other bound structs. Any other type goes
+ * through its to_json()/from_json() conversion, which does build a json value
+ * for that field only.
+ */
+namespace wpi {
+
+/*!
+@brief field table of a struct; specialize with a static constexpr member
+`fields` created by json_fields()
+*/
+    template<typename T>
+    struct json_binding;
+
+/*!
+@brief descriptor of one struct field: its JSON key and member pointer
+*/
+    template<typename Class, typename Member>
+    struct json_field {
+        using class_type = Class;
+        using member_type = Member;
+
+        const char *name;
+        std::size_t name_len;
+        Member Class::*member;
+    };
+
+/// create a field descriptor with key @a name
+    template<typename Class, typename Member, std::size_t N>
+    constexpr json_field<Class, Member> make_json_field(const char (&name)[N],
+                                                        Member Class::*member) {
+        return {name, N - 1, member};
+    }
+
+/// create a field descriptor keyed by the member's own name
+#define WPI_JSON_FIELD(Type, member) ::wpi::make_json_field(#member, &Type::member)
+
+    namespace detail {
+/*!
+@brief seeded FNV-1a hash of a field key
+
+Usable at compile time to build the perfect hash of a field table and at
+run time to look keys up in it.
+*/
+        constexpr uint32_t json_key_hash(const char *s, std::size_t len,
+                                         uint32_t seed) {
+            uint32_t h = 2166136261u ^ (seed * 0x9E3779B9u);
+            for (std::size_t i = 0; i < len; ++i) {
+                h ^= static_cast<uint8_t>(s[i]);
+                h *= 16777619u;
+            }
+            return h ^ (h >> 15);
+        }
+
+        constexpr std::size_t json_key_slots(std::size_t fields) {
+            std::size_t slots = 1;
+            while (slots < fields * 4) {
+                slots *= 2;
+            }
+            return slots;
+        }
+    }  // namespace detail
+
+/*!
+@brief the fields of a bound struct, with a perfect hash over their keys
+
+The hash seed is searched for at compile time such that every key lands in a
+slot of its own, so a lookup costs one hash and one key comparison.
+*/
+    template<typename... Fields>
+    class json_field_table {
+    public:
+        static constexpr std::size_t size = sizeof...(Fields);
+
+        static_assert(size < 255, "too many fields");
+
+        constexpr explicit json_field_table(Fields... fields)
+                : m_fields(fields...), m_names{{fields.name...}},
+                  m_lens{{fields.name_len...}} {
+            for (std::size_t i = 0; i < size; ++i) {
+                for (std::size_t j = 0; j < i; ++j) {
+                    if (equal(i, j)) {
+                        throw std::logic_error("duplicate JSON field name");
+                    }
+                }
+            }
+            for (uint32_t seed = 0; seed < 0x10000; ++seed) {
+                if (try_seed(seed)) {
+                    return;
+                }
+            }
+            throw std::logic_error("no perfect hash found for JSON field names");
+        }
+
+        /// index of the field with key @a key, or -1
+        int find(StringRef key) const {
+            unsigned slot =
+                    m_slots[detail::json_key_hash(key.data(), key.size(), m_seed) &
+                            (kSlots - 1)];
+            if (slot == 0) {
+                return -1;
+            }
+            --slot;
+            if (m_lens[slot] != key.size() or
+                (key.size() != 0 and
+                 std::memcmp(m_names[slot], key.data(), key.size()) != 0)) {
+                return -1;
+            }
+            return static_cast<int>(slot);
+        }
+
+        /// call @a f with the descriptor of field @a index
+        template<typename F>
+        void visit(std::size_t index, F &&f) const {
+            visit_impl(index, f, std::index_sequence_for<Fields...>{});
+        }
+
+        /// call @a f with each field descriptor, in declaration order
+        template<typename F>
+        void for_each(F &&f) const {
+            std::apply([&](const Fields &... field) { (f(field), ...); }, m_fields);
+        }
+
+    private:
+        static constexpr std::size_t kSlots = detail::json_key_slots(size);
+
+        constexpr bool equal(std::size_t i, std::size_t j) const {
+            if (m_lens[i] != m_lens[j]) {
+                return false;
+            }
+            for (std::size_t k = 0; k < m_lens[i]; ++k) {
+                if (m_names[i][k] != m_names[j][k]) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        constexpr bool try_seed(uint32_t seed) {
+            std::array<uint8_t, kSlots> slots{};
+            for (std::size_t i = 0; i < size; ++i) {
+                auto h = detail::json_key_hash(m_names[i], m_lens[i], seed) &
+                         (kSlots - 1);
+                if (slots[h] != 0) {
+                    return false;
+                }
+                slots[h] = static_cast<uint8_t>(i + 1);
+            }
+            m_slots = slots;
+            m_seed = seed;
+            return true;
+        }
+
+        template<typename F, std::size_t... I>
+        void visit_impl(std::size_t index, F &f, std::index_sequence<I...>) const {
+            ((index == I ? (f(std::get<I>(m_fields)), 0) : 0), ...);
+        }
+
+        std::tuple<Fields...> m_fields;
+        std::array<const char *, size> m_names;
+        std::array<std::size_t, size> m_lens;
+        /// field index + 1 per slot, 0 for empty slots
+        std::array<uint8_t, kSlots> m_slots{};
+        uint32_t m_seed = 0;
+    };
+
+/// create the field table of a bound struct
+    template<typename... Fields>
+    constexpr json_field_table<Fields...> json_fields(Fields... fields) {
+        return json_field_table<Fields...>(fields...);
+    }
+
+    namespace detail {
+        template<typename T, typename = void>
+        struct is_json_bound : std::false_type {
+        };
+
+        template<typename T>
+        struct is_json_bound<T, std::void_t<decltype(json_binding<T>::fields)>>
+                : std::true_type {
+        };
+
+/*!
+@brief how the binding reader stores values into an object of some type
+
+Entries for JSON values the type cannot hold are null; @a type_name names the
+JSON type it expects in error messages. Types without a direct binding set
+@a assign and receive a json value instead.
+*/
+        struct json_bind_ops {
+            const char *type_name;
+            void (*boolean)(void *obj, bool val);
+            void (*number_integer)(void *obj, int64_t val);
+            void (*number_unsigned)(void *obj, uint64_t val);
+            void (*number_float)(void *obj, double val);
+            void (*string)(void *obj, StringRef val);
+            /// objects: locate the member for @a key; false if there is none
+            bool (*member)(void *obj, StringRef key, void **child,
+                           const json_bind_ops **child_ops);
+            /// arrays: called before the first element
+            void (*start_array)(void *obj);
+            /// arrays: storage for element @a index
+            void *(*element)(void *obj, std::size_t index,
+                             const json_bind_ops **child_ops);
+            void (*assign)(void *obj, json &&val);
+        };
+
+/*!
+@brief SAX handler that stores what it reads into a bound object
+
+Unknown object keys are skipped; members missing from the input keep their
+previous values. Errors are thrown: type_error.302 for a value of the wrong
+JSON type, out_of_range.401 for too many elements in a std::array, and the
+parser's own exception for malformed input. On error the object may be
+partially updated.
+*/
+        class json_binding_reader final : public json_sax {
+        public:
+            json_binding_reader(void *obj, const json_bind_ops *ops)
+                    : m_root(obj), m_root_ops(ops) {}
+
+            bool null() override;
+
+            bool boolean(bool val) override;
+
+            bool number_integer(int64_t val) override;
+
+            bool number_unsigned(uint64_t val) override;
+
+            bool number_float(double val) override;
+
+            bool string(StringRef val) override;
+
+            bool start_object() override;
+
+            bool key(StringRef val) override;
+
+            bool end_object() override;
+
+            bool start_array() override;
+
+            bool end_array() override;
+
+            void parse_error(std::size_t position, StringRef last_token,
+                             const detail::exception &ex) override;
+
+        private:
+            struct frame {
+                void *obj;
+                const json_bind_ops *ops;
+                std::size_t count;
+                void *child;
+                const json_bind_ops *child_ops;
+            };
+
+            /// locate the object the next value is stored into
+            void next_target(void **obj, const json_bind_ops **ops);
+
+            /// store a scalar into a json value under construction
+            void build(json &&val);
+
+            /// open an object or array in a json value under construction
+            void build_container(json &&val);
+
+            /// finish a container in a json value under construction
+            void build_end();
+
+            [[noreturn]] static void type_mismatch(const json_bind_ops *ops,
+                                                   const char *actual);
+
+            void *m_root;
+            const json_bind_ops *m_root_ops;
+            SmallVector<frame, 8> m_stack;
+
+            // values of types bound through from_json() are built as json first
+            json m_value;
+            SmallVector<json *, 8> m_build;
+            std::string m_key;
+            void *m_build_obj = nullptr;
+            const json_bind_ops *m_build_ops = nullptr;
+        };
+
+/// @throw out_of_range.401 for an element past the end of a fixed-size array
+        [[noreturn]] void json_bind_out_of_range(std::size_t index);
+
+/// binding of types without a direct one: through to_json()/from_json()
+        template<typename T, typename = void>
+        struct json_bind_impl {
+            static void write(json_writer &w, const T &val) {
+                w.value(json(val));
+            }
+
+            static void assign(void *obj, json &&val) {
+                if constexpr (std::is_same<T, json>::value) {
+                    *static_cast<T *>(obj) = std::move(val);
+                } else {
+                    *static_cast<T *>(obj) = val.template get<T>();
+                }
+            }
+
+            static constexpr json_bind_ops ops = {
+                    "value", nullptr, nullptr, nullptr, nullptr, nullptr,
+                    nullptr, nullptr, nullptr, &assign};
+        };
+
+        template<>
+        struct json_bind_impl<bool> {
+            static void write(json_writer &w, bool val) { w.boolean(val); }
+
+            static void set(void *obj, bool val) { *static_cast<bool *>(obj) = val; }
+
+            static constexpr json_bind_ops ops = {
+                    "boolean", &set, nullptr, nullptr, nullptr, nullptr,
+                    nullptr, nullptr, nullptr, nullptr};
+        };
+
+        template<typename T>
+        struct json_bind_impl<T, enable_if_t<std::is_arithmetic<T>::value and
+                                             not std::is_same<T, bool>::value>> {
+            static void write(json_writer &w, T val) {
+                if constexpr (std::is_floating_point<T>::value) {
+                    w.number_float(val);
+                } else if constexpr (std::is_signed<T>::value) {
+                    w.number_integer(val);
+                } else {
+                    w.number_unsigned(val);
+                }
+            }
+
+            template<typename U>
+            static void set(void *obj, U val) {
+                *static_cast<T *>(obj) = static_cast<T>(val);
+            }
+
+            static constexpr json_bind_ops ops = {
+                    "number", nullptr, &set<int64_t>, &set<uint64_t>, &set<double>,
+                    nullptr, nullptr, nullptr, nullptr, nullptr};
+        };
+
+        template<>
+        struct json_bind_impl<std::string> {
+            static void write(json_writer &w, const std::string &val) {
+                w.string(val);
+            }
+
+            static void set(void *obj, StringRef val) {
+                static_cast<std::string *>(obj)->assign(val.data(), val.size());
+            }
+
+            static constexpr json_bind_ops ops = {
+                    "string", nullptr, nullptr, nullptr, nullptr, &set,
+                    nullptr, nullptr, nullptr, nullptr};
+        };
+
+        template<typename T, typename Allocator>
+        struct json_bind_impl<std::vector<T, Allocator>> {
+            using vector_type = std::vector<T, Allocator>;
+
+            static void write(json_writer &w, const vector_type &val) {
+                w.start_array();
+                for (const auto &element : val) {
+                    json_bind_impl<T>::write(w, element);
+                }
+                w.end_array();
+            }
+
+            static void start(void *obj) { static_cast<vector_type *>(obj)->clear(); }
+
+            static void *element(void *obj, std::size_t, const json_bind_ops **ops) {
+                *ops = &json_bind_impl<T>::ops;
+                return &static_cast<vector_type *>(obj)->emplace_back();
+            }
+
+            static constexpr json_bind_ops ops = {
+                    "array", nullptr, nullptr, nullptr, nullptr, nullptr,
+                    nullptr, &start, &element, nullptr};
+        };
+
+        template<typename T, std::size_t N>
+        struct json_bind_impl<std::array<T, N>> {
+            static void write(json_writer &w, const std::array<T, N> &val) {
+                w.start_array();
+                for (const auto &element : val) {
+                    json_bind_impl<T>::write(w, element);
+                }
+                w.end_array();
+            }
+
+            static void *element(void *obj, std::size_t index,
+                                 const json_bind_ops **ops) {
+                if (index >= N) {
+                    json_bind_out_of_range(index);
+                }
+                *ops = &json_bind_impl<T>::ops;
+                return &(*static_cast<std::array<T, N> *>(obj))[index];
+            }
+
+            static constexpr json_bind_ops ops = {
+                    "array", nullptr, nullptr, nullptr, nullptr, nullptr,
+                    nullptr, nullptr, &element, nullptr};
+        };
+
+        template<typename T>
+        struct json_bind_impl<T, enable_if_t<is_json_bound<T>::value>> {
+            static void write(json_writer &w, const T &val) {
+                w.start_object();
+                json_binding<T>::fields.for_each([&](const auto &field) {
+                    using member_type = typename uncvref_t<decltype(field)>::member_type;
+                    w.key(StringRef(field.name, field.name_len));
+                    json_bind_impl<member_type>::write(w, val.*field.member);
+                });
+                w.end_object();
+            }
+
+            static bool member(void *obj, StringRef key, void **child,
+                               const json_bind_ops **child_ops) {
+                const auto &fields = json_binding<T>::fields;
+                int index = fields.find(key);
+                if (index < 0) {
+                    return false;
+                }
+                fields.visit(index, [&](const auto &field) {
+                    using member_type = typename uncvref_t<decltype(field)>::member_type;
+                    *child = &(static_cast<T *>(obj)->*field.member);
+                    *child_ops = &json_bind_impl<member_type>::ops;
+                });
+                return true;
+            }
+
+            static constexpr json_bind_ops ops = {
+                    "object", nullptr, nullptr, nullptr, nullptr, nullptr,
+                    &member, nullptr, nullptr, nullptr};
+        };
+    }  // namespace detail
+
+/*!
+@brief serialize a bound struct (or any supported type) as JSON text
+
+Produces the same compact text as `json(value).dump()` would with equivalent
+to_json() conversions, without building the json value.
+
+@param[in] os            stream to write to
+@param[in] value         value to serialize
+@param[in] ensure_ascii  whether to escape non-ASCII characters with
+                         \\uXXXX sequences
+*/
+    template<typename T>
+    void write_json(raw_ostream &os, const T &value, bool ensure_ascii = false) {
+        json_writer writer(os, ensure_ascii);
+        detail::json_bind_impl<T>::write(writer, value);
+    }
+
+/*!
+@brief parse JSON text directly into a bound struct (or any supported type)
+
+@throw parse_error.101 and others as json::parse() for malformed input
+@throw type_error.302 if a value has the wrong JSON type
+@sa detail::json_binding_reader for how the input is matched to @a value
+*/
+    template<typename T>
+    void read_json(StringRef s, T &value) {
+        detail::json_binding_reader reader(&value, &detail::json_bind_impl<T>::ops);
+        json::sax_parse(s, &reader);
+    }
+
+/// @copydoc read_json(StringRef, T&)
+    template<typename T>
+    void read_json(ArrayRef <uint8_t> arr, T &value) {
+        detail::json_binding_reader reader(&value, &detail::json_bind_impl<T>::ops);
+        json::sax_parse(arr, &reader);
+    }
+
+/// @copydoc read_json(StringRef, T&)
+    template<typename T>
+    void read_json(raw_istream &is, T &value) {
+        detail::json_binding_reader reader(&value, &detail::json_bind_impl<T>::ops);
+        json::sax_parse(is, &reader);
+    }
+
+/*!
+@brief decode CBOR directly into a bound struct (or any supported type)
+
+@throw parse_error.110 and others as json::from_cbor() for malformed input
+@throw type_error.302 if a value has the wrong JSON type
+*/
+    template<typename T>
+    void read_cbor(ArrayRef <uint8_t> arr, T &value) {
+        detail::json_binding_reader reader(&value, &detail::json_bind_impl<T>::ops);
+        json::sax_parse_cbor(arr, &reader);
+    }
+
+/*!
+@brief decode MessagePack directly into a bound struct (or any supported type)
+
+@throw parse_error.110 and others as json::from_msgpack() for malformed input
+@throw type_error.302 if a value has the wrong JSON type
+*/
+    template<typename T>
+    void read_msgpack(ArrayRef <uint8_t> arr, T &value) {
+        detail::json_binding_reader reader(&value, &detail::json_bind_impl<T>::ops);
+        json::sax_parse_msgpack(arr, &reader);
+    }
+
+}  // namespace wpi
+
+#endif  // WPIUTIL_WPI_JSON_BINDING_H_
@@ -0,0 +1,66 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#ifndef WPIUTIL_WPI_JSON_UV_H_
+#define WPIUTIL_WPI_JSON_UV_H_
+
+#include <cstddef>
+
+#include "wpi/SmallVector.h"
+#include "wpi/json.h"
+#include "wpi/raw_uv_ostream.h"
+#include "wpi/uv/Buffer.h"
+#include "wpi/uv/Stream.h"
+
+namespace wpi {
+
+/*!
+@brief serialize a JSON value into buffers from a pool
+
+The output is written directly into buffers allocated from @a pool, with no
+intermediate std::string, and appended to @a bufs ready to be passed to
+uv::Stream::Write() or WebSocket::SendText(). Release the buffers back into
+@a pool when the write completes:
+
+@code
+SmallVector<uv::Buffer, 4> bufs;
+json_dump(j, bufs, pool);
+ws.SendText(bufs, [&pool](auto bufs, uv::Error) { pool.Release(bufs); });
+@endcode
+
+@param[in] j  the value to serialize
+@param[out] bufs  buffers vector; NOT cleared
+@param[in] pool  the pool to allocate buffers from
+@param[in] indent  as json::dump()
+*/
+    template<size_t DEPTH>
+    void json_dump(const json &j, SmallVectorImpl <uv::Buffer> &bufs,
+                   uv::SimpleBufferPool<DEPTH> &pool, int indent = -1) {
+        raw_uv_pool_ostream os{bufs, pool};
+        j.dump(os, indent);
+    }
+
+/*!
+@brief serialize a JSON value and write it to a stream
+
+Serializes as json_dump() and writes the buffers to @a stream; they are
+released back into @a pool when the write completes, even if it failed.
+@a pool must outlive the write request.
+
+@param[in] stream  the stream to write to
+@param[in] j  the value to serialize
+@param[in] pool  the pool to allocate buffers from
+@param[in] indent  as json::dump()
+*/
+    template<size_t DEPTH>
+    void json_write(uv::Stream &stream, const json &j,
+                    uv::SimpleBufferPool<DEPTH> &pool, int indent = -1) {
+        SmallVector<uv::Buffer, 4> bufs;
+        json_dump(j, bufs, pool, indent);
+        stream.Write(bufs, [&pool](auto bufs, uv::Error) { pool.Release(bufs); });
+    }
+
+}  // namespace wpi
+
+#endif  // WPIUTIL_WPI_JSON_UV_H_
@@ -5,6 +5,7 @@
 #ifndef WPIUTIL_WPI_RAW_UV_OSTREAM_H_
 #define WPIUTIL_WPI_RAW_UV_OSTREAM_H_
 
+#include <functional>
 #include <utility>
 
 #include "wpi/ArrayRef.h"
@@ -65,6 +66,67 @@ namespace wpi {
         size_t m_left = 0;
     };
 
+/**
+ * raw_ostream style output to a SmallVector of uv::Buffer buffers, written
+ * directly into the buffers.  Unlike raw_uv_ostream, which is unbuffered and
+ * copies every write, the last buffer is used as the stream buffer, so small
+ * writes (e.g. from json::dump()) are plain stores into it and there is no
+ * intermediate copy.  Buffers are allocated as necessary, typically from a
+ * uv::SimpleBufferPool, and trimmed to the bytes written.
+ *
+ * Output still in the stream buffer is only accounted for in the buffers
+ * after flush(); bufs() and the destructor flush.  When a flush fills a
+ * buffer exactly, the next one is allocated right away, so the last buffer
+ * may be empty.  Buffers already in the SmallVector at start are not written
+ * to.
+ */
+    class raw_uv_pool_ostream : public raw_ostream {
+    public:
+        /**
+         * Construct a new raw_uv_pool_ostream.
+         * @param bufs Buffers vector.  NOT cleared on construction.
+         * @param alloc Allocator.
+         */
+        raw_uv_pool_ostream(SmallVectorImpl <uv::Buffer> &bufs,
+                            std::function<uv::Buffer()> alloc)
+                : raw_ostream(true), m_bufs(bufs), m_alloc(std::move(alloc)) {}
+
+        /**
+         * Construct a new raw_uv_pool_ostream.
+         * @param bufs Buffers vector.  NOT cleared on construction.
+         * @param pool Buffer pool to allocate from.  Release the buffers back
+         *             into it when done with them.
+         */
+        template<size_t DEPTH>
+        raw_uv_pool_ostream(SmallVectorImpl <uv::Buffer> &bufs,
+                            uv::SimpleBufferPool<DEPTH> &pool)
+                : raw_uv_pool_ostream(bufs, [&pool] { return pool.Allocate(); }) {}
+
+        ~raw_uv_pool_ostream() override { flush(); }
+
+        /**
+         * Returns an ArrayRef to the buffers, after flushing.
+         */
+        ArrayRef <uv::Buffer> bufs() {
+            flush();
+            return m_bufs;
+        }
+
+    private:
+        void write_impl(const char *data, size_t len) override;
+
+        uint64_t current_pos() const override;
+
+        // Append a newly allocated buffer.
+        void AllocateBuffer();
+
+        SmallVectorImpl <uv::Buffer> &m_bufs;
+        std::function<uv::Buffer()> m_alloc;
+
+        // Allocated size of the current buffer; 0 before the first one.
+        size_t m_capacity = 0;
+    };
+
 }  // namespace wpi
 
 #endif  // WPIUTIL_WPI_RAW_UV_OSTREAM_H_
@@ -244,7 +244,7 @@ namespace wpi::uv {
          * @return Amount of queued bytes waiting to be sent.
          */
         size_t GetWriteQueueSize() const noexcept {
-            return GetRawStream()->write_queue_size;
+            return uv_stream_get_write_queue_size(GetRawStream());
         }
 
         /**
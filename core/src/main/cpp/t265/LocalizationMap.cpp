@@ -0,0 +1,290 @@
+#include "LocalizationMap.h"
+
+#include <cstring>
+#include <stdexcept>
+
+#include <zlib.h>
+
+#include <librealsense2/rs.h>
+
+#include "Rs2PoseSource.h"
+#include "wpi/Endian.h"
+#include "wpi/SmallString.h"
+#include "wpi/WorkerThread.h"
+#include "wpi/raw_istream.h"
+#include "wpi/raw_ostream.h"
+#include "wpi/sha1.h"
+
+using namespace t265;
+
+namespace {
+
+    constexpr char kMagic[8] = {'F', 'T', 'C', '2', '6', '5', 'L', 'M'};
+    constexpr uint8_t kVersion = 1;
+    constexpr uint8_t kFlagCompressed = 0x01;
+    constexpr size_t kHeaderSize = sizeof(kMagic) + 2 + 4;
+    constexpr size_t kHashSize = 20;
+
+    void WriteChunk(wpi::raw_ostream &os, const uint8_t *data, size_t len) {
+        char lenBuf[4];
+        wpi::support::endian::write32le(lenBuf, len);
+        os.write(lenBuf, sizeof(lenBuf));
+        os.write(reinterpret_cast<const char *>(data), len);
+    }
+
+    bool Fail(std::string *error, const char *message) {
+        if (error) *error = message;
+        return false;
+    }
+
+// Reads the next payload chunk into buf. Returns 0 at the terminating chunk
+// and -1 on error.
+    int ReadChunk(wpi::raw_istream &is, uint8_t *buf, size_t *len) {
+        char lenBuf[4];
+        is.read(lenBuf, sizeof(lenBuf));
+        if (is.has_error()) return -1;
+        *len = wpi::support::endian::read32le(lenBuf);
+        if (*len == 0) return 0;
+        if (*len > LocalizationMap::kChunkSize) return -1;
+        is.read(buf, *len);
+        return is.has_error() ? -1 : 1;
+    }
+
+}  // namespace
+
+bool LocalizationMap::Write(wpi::raw_ostream &os, wpi::ArrayRef<uint8_t> map,
+                            bool compress, std::string *error) {
+    char header[kHeaderSize];
+    std::memcpy(header, kMagic, sizeof(kMagic));
+    header[8] = kVersion;
+    header[9] = compress ? kFlagCompressed : 0;
+    wpi::support::endian::write32le(&header[10], map.size());
+    os.write(header, sizeof(header));
+
+    wpi::SHA1 hash;
+    uint8_t out[kChunkSize];
+
+    if (!compress) {
+        for (size_t pos = 0; pos < map.size(); pos += kChunkSize) {
+            size_t len = (std::min)(kChunkSize, map.size() - pos);
+            hash.Update(wpi::StringRef(
+                    reinterpret_cast<const char *>(map.data() + pos), len));
+            WriteChunk(os, map.data() + pos, len);
+        }
+    } else {
+        z_stream strm;
+        std::memset(&strm, 0, sizeof(strm));
+        if (deflateInit(&strm, Z_DEFAULT_COMPRESSION) != Z_OK) {
+            return Fail(error, "could not initialize compressor");
+        }
+
+        size_t pos = 0;
+        int ret;
+        do {
+            // Feed and hash the input one chunk at a time
+            if (strm.avail_in == 0 && pos < map.size()) {
+                size_t len = (std::min)(kChunkSize, map.size() - pos);
+                hash.Update(wpi::StringRef(
+                        reinterpret_cast<const char *>(map.data() + pos), len));
+                strm.next_in = const_cast<Bytef *>(map.data() + pos);
+                strm.avail_in = len;
+                pos += len;
+            }
+            strm.next_out = out;
+            strm.avail_out = sizeof(out);
+            ret = deflate(&strm, pos == map.size() ? Z_FINISH : Z_NO_FLUSH);
+            if (ret == Z_STREAM_ERROR) break;
+            size_t have = sizeof(out) - strm.avail_out;
+            if (have > 0) WriteChunk(os, out, have);
+        } while (ret != Z_STREAM_END);
+        deflateEnd(&strm);
+        if (ret != Z_STREAM_END) return Fail(error, "compression failed");
+    }
+
+    WriteChunk(os, nullptr, 0);
+
+    wpi::SmallString<kHashSize> digest;
+    hash.RawFinal(digest);
+    os << digest.str();
+    return true;
+}
+
+bool LocalizationMap::Read(wpi::raw_istream &is, std::vector<uint8_t> *map,
+                           std::string *error) {
+    char header[kHeaderSize];
+    is.read(header, sizeof(header));
+    if (is.has_error()) return Fail(error, "truncated header");
+    if (std::memcmp(header, kMagic, sizeof(kMagic)) != 0) {
+        return Fail(error, "not a localization map");
+    }
+    if (static_cast<uint8_t>(header[8]) != kVersion) {
+        return Fail(error, "unsupported localization map version");
+    }
+    bool compressed = header[9] & kFlagCompressed;
+    size_t size = wpi::support::endian::read32le(&header[10]);
+    if (size > kMaxMapSize) return Fail(error, "map too large");
+
+    // Grow the output as data arrives instead of trusting the declared size,
+    // so a truncated or corrupt file cannot make us allocate it up front
+    map->clear();
+    map->reserve((std::min)(size, kChunkSize * 64));
+
+    wpi::SHA1 hash;
+    auto append = [&](const uint8_t *data, size_t len) {
+        if (len > size - map->size()) return false;
+        hash.Update(wpi::StringRef(reinterpret_cast<const char *>(data), len));
+        map->insert(map->end(), data, data + len);
+        return true;
+    };
+
+    uint8_t in[kChunkSize];
+    size_t len;
+    int chunk;
+
+    if (!compressed) {
+        while ((chunk = ReadChunk(is, in, &len)) > 0) {
+            if (!append(in, len)) return Fail(error, "map larger than declared");
+        }
+        if (chunk < 0) return Fail(error, "truncated payload");
+    } else {
+        z_stream strm;
+        std::memset(&strm, 0, sizeof(strm));
+        if (inflateInit(&strm) != Z_OK) {
+            return Fail(error, "could not initialize decompressor");
+        }
+
+        uint8_t out[kChunkSize];
+        int ret = Z_OK;
+        bool overflow = false;
+        while (ret == Z_OK && (chunk = ReadChunk(is, in, &len)) > 0) {
+            strm.next_in = in;
+            strm.avail_in = len;
+            do {
+                strm.next_out = out;
+                strm.avail_out = sizeof(out);
+                ret = inflate(&strm, Z_NO_FLUSH);
+                if (ret != Z_OK && ret != Z_STREAM_END) break;
+                if (!append(out, sizeof(out) - strm.avail_out)) {
+                    overflow = true;
+                    ret = Z_DATA_ERROR;
+                    break;
+                }
+            } while (strm.avail_in != 0 && ret == Z_OK);
+            // Data after the end of the deflate stream
+            if (ret == Z_STREAM_END && strm.avail_in != 0) ret = Z_DATA_ERROR;
+        }
+        // Consume the terminating chunk after the end of the stream
+        if (ret == Z_STREAM_END) {
+            chunk = ReadChunk(is, in, &len);
+            if (chunk > 0) ret = Z_DATA_ERROR;
+        }
+        inflateEnd(&strm);
+        if (overflow) return Fail(error, "map larger than declared");
+        if (chunk < 0) return Fail(error, "truncated payload");
+        if (ret != Z_STREAM_END) return Fail(error, "corrupt compressed payload");
+    }
+
+    if (map->size() != size) return Fail(error, "map smaller than declared");
+
+    char expected[kHashSize];
+    is.read(expected, sizeof(expected));
+    if (is.has_error()) return Fail(error, "truncated hash");
+
+    wpi::SmallString<kHashSize> digest;
+    if (hash.RawFinal(digest) != wpi::StringRef(expected, sizeof(expected))) {
+        return Fail(error, "hash mismatch");
+    }
+    return true;
+}
+
+rs2_sensor *LocalizationMap::FindPoseSensor(const rs2_device *device) {
+    rs2_error *e = nullptr;
+    rs2_sensor_list *sensors = rs2_query_sensors(device, &e);
+    CheckError(e);
+
+    rs2_sensor *found = nullptr;
+    int count = rs2_get_sensors_count(sensors, &e);
+    for (int i = 0; i < count && !found && !e; ++i) {
+        rs2_sensor *sensor = rs2_create_sensor(sensors, i, &e);
+        if (e) break;
+        if (rs2_is_sensor_extendable_to(sensor, RS2_EXTENSION_POSE_SENSOR, &e)) {
+            found = sensor;
+        } else {
+            rs2_delete_sensor(sensor);
+        }
+    }
+    rs2_delete_sensor_list(sensors);
+    CheckError(e);
+    return found;
+}
+
+bool LocalizationMap::Export(const rs2_sensor *sensor, wpi::StringRef path,
+                             bool compress, std::string *error) {
+    rs2_error *e = nullptr;
+    const rs2_raw_data_buffer *buffer = rs2_export_localization_map(sensor, &e);
+    if (e) {
+        if (error) *error = rs2_get_error_message(e);
+        rs2_free_error(e);
+        return false;
+    }
+
+    const unsigned char *data = rs2_get_raw_data(buffer, &e);
+    int size = e ? 0 : rs2_get_raw_data_size(buffer, &e);
+    bool ok = false;
+    if (e) {
+        if (error) *error = rs2_get_error_message(e);
+        rs2_free_error(e);
+    } else {
+        std::error_code ec;
+        wpi::raw_fd_ostream os(path, ec);
+        if (ec) {
+            if (error) *error = ec.message();
+        } else {
+            ok = Write(os, wpi::ArrayRef<uint8_t>(data, size), compress, error);
+            os.close();
+            if (ok && os.has_error()) {
+                ok = Fail(error, "write failed");
+                os.clear_error();
+            }
+        }
+    }
+    rs2_delete_raw_data(buffer);
+    return ok;
+}
+
+bool LocalizationMap::Import(const rs2_sensor *sensor, wpi::StringRef path,
+                             std::string *error) {
+    std::error_code ec;
+    wpi::raw_fd_istream is(path, ec, kChunkSize);
+    if (ec) {
+        if (error) *error = ec.message();
+        return false;
+    }
+
+    std::vector<uint8_t> map;
+    if (!Read(is, &map, error)) return false;
+
+    rs2_error *e = nullptr;
+    int ok = rs2_import_localization_map(sensor, map.data(), map.size(), &e);
+    if (e) {
+        if (error) *error = rs2_get_error_message(e);
+        rs2_free_error(e);
+        return false;
+    }
+    if (!ok) return Fail(error, "camera rejected the localization map");
+    return true;
+}
+
+wpi::future<std::string> LocalizationMap::ImportAsync(const rs2_sensor *sensor,
+                                                      std::string path) {
+    static wpi::WorkerThread<std::string(const rs2_sensor *, std::string)> worker;
+    return worker.QueueWork(
+            [](const rs2_sensor *sensor, std::string path) {
+                std::string error;
+                if (!Import(sensor, path, &error) && error.empty()) {
+                    error = "import failed";
+                }
+                return error;
+            },
+            sensor, std::move(path));
+}
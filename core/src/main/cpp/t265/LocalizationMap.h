@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "wpi/ArrayRef.h"
+#include "wpi/StringRef.h"
+#include "wpi/future.h"
+
+struct rs2_device;
+struct rs2_sensor;
+
+namespace wpi {
+    class raw_istream;
+
+    class raw_ostream;
+}  // namespace wpi
+
+namespace t265 {
+
+/**
+ * Streaming container for T265 relocalization maps.
+ *
+ * The file layout is:
+ *   - 8 byte magic "FTC265LM"
+ *   - 1 byte version, 1 byte flags (bit 0: payload is zlib-compressed)
+ *   - 4 byte little-endian uncompressed map size
+ *   - payload chunks, each a 4 byte little-endian length followed by that
+ *     many bytes, terminated by a zero-length chunk
+ *   - 20 byte SHA-1 of the uncompressed map
+ *
+ * The payload is processed in fixed-size chunks in both directions, so the
+ * only full-size buffer is the map itself (which librealsense requires).
+ * Chunk framing means neither side needs to know the compressed size up
+ * front or to seek.
+ */
+    namespace LocalizationMap {
+
+/// Size of the chunks read from and written to streams
+        constexpr size_t kChunkSize = 16 * 1024;
+
+/// Largest map Read() accepts; T265 maps are a few megabytes
+        constexpr size_t kMaxMapSize = 64 * 1024 * 1024;
+
+/**
+ * Writes a map to a stream.
+ *
+ * @param os output stream
+ * @param map raw map as exported by the camera
+ * @param compress whether to deflate the payload
+ * @param error set to a description of the failure, if any
+ * @return False on error
+ */
+        bool Write(wpi::raw_ostream &os, wpi::ArrayRef<uint8_t> map, bool compress,
+                   std::string *error);
+
+/**
+ * Reads a map from a stream, inflating it if needed and verifying its hash.
+ *
+ * @param is input stream
+ * @param map set to the raw map
+ * @param error set to a description of the failure, if any
+ * @return False on error (including a hash mismatch or a declared size
+ *         over kMaxMapSize)
+ */
+        bool Read(wpi::raw_istream &is, std::vector<uint8_t> *map,
+                  std::string *error);
+
+/**
+ * Returns the pose sensor of a device, or nullptr if it has none. The
+ * result must be released with rs2_delete_sensor().
+ */
+        rs2_sensor *FindPoseSensor(const rs2_device *device);
+
+/**
+ * Exports the camera's current map and writes it to a file.
+ */
+        bool Export(const rs2_sensor *sensor, wpi::StringRef path, bool compress,
+                    std::string *error);
+
+/**
+ * Reads a map from a file and imports it into the camera. The camera must
+ * not be streaming.
+ */
+        bool Import(const rs2_sensor *sensor, wpi::StringRef path,
+                    std::string *error);
+
+/**
+ * Runs Import() on a background thread so that the caller (typically OpMode
+ * init) is not blocked while a large map is read, inflated, verified and
+ * uploaded.
+ *
+ * The sensor must stay valid until the future is ready.
+ *
+ * @return future for an error message; empty on success
+ */
+        wpi::future<std::string> ImportAsync(const rs2_sensor *sensor,
+                                             std::string path);
+
+    }  // namespace LocalizationMap
+
+}  // namespace t265
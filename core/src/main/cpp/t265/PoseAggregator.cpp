@@ -0,0 +1,296 @@
+#include "PoseAggregator.h"
+
+#include <cassert>
+#include <cmath>
+#include <exception>
+#include <mutex>
+
+#include <Eigen/LU>
+
+#include "wpi/timestamp.h"
+
+using namespace t265;
+
+namespace {
+
+// librealsense reports poses with x right, y up and z out the back of the
+// camera. Rows of this matrix are the robot-style axes (x forward, y left,
+// z up) expressed in those camera axes.
+    const Eigen::Matrix3d kCameraToRobotBasis =
+            (Eigen::Matrix3d() << 0, 0, -1, -1, 0, 0, 0, 1, 0).finished();
+
+// Measurement covariance multiplier per tracker confidence level. Zero means
+// the sample is not used at all.
+    constexpr double kConfidenceScale[4] = {0, 16, 4, 1};
+
+    double WrapAngle(double angle) {
+        return std::remainder(angle, 2 * M_PI);
+    }
+
+    Eigen::Matrix3d QuaternionToMatrix(const double q[4]) {
+        double x = q[0], y = q[1], z = q[2], w = q[3];
+        Eigen::Matrix3d R;
+        R << 1 - 2 * (y * y + z * z), 2 * (x * y - z * w), 2 * (x * z + y * w),
+                2 * (x * y + z * w), 1 - 2 * (x * x + z * z), 2 * (y * z - x * w),
+                2 * (x * z - y * w), 2 * (y * z + x * w), 1 - 2 * (x * x + y * y);
+        return R;
+    }
+
+    Eigen::Matrix3d EulerToMatrix(double yaw, double pitch, double roll) {
+        double cy = std::cos(yaw), sy = std::sin(yaw);
+        double cp = std::cos(pitch), sp = std::sin(pitch);
+        double cr = std::cos(roll), sr = std::sin(roll);
+        Eigen::Matrix3d R;
+        R << cy * cp, cy * sp * sr - sy * cr, cy * sp * cr + sy * sr,
+                sy * cp, sy * sp * sr + cy * cr, sy * sp * cr - cy * sr,
+                -sp, cp * sr, cp * cr;
+        return R;
+    }
+
+    struct AlignedSample {
+        PoseSample sample;
+        uint64_t timestamp = 0;
+    };
+
+}  // namespace
+
+struct PoseAggregator::Stream {
+    std::unique_ptr<PoseSource> source;
+
+    // Camera pose in the robot frame
+    Eigen::Matrix3d extrinsicRotation;
+    Eigen::Vector3d extrinsicTranslation;
+    Eigen::Matrix3d covariance;
+
+    // Owned by whichever thread feeds the stream
+    ClockAligner clock;
+
+    PoseStreamStats stats;
+
+    wpi::spinlock mutex;
+    wpi::static_circular_buffer<AlignedSample, kHistorySize> history;
+
+    // Owned by the thread calling Update()
+    uint64_t lastUsed = 0;
+    // The sample used by the last tick, until MarkRead() records it
+    PoseSample lastFused;
+    bool readPending = false;
+
+    wpi::SafeThreadOwner<StreamThread> thread;
+};
+
+class PoseAggregator::StreamThread : public wpi::SafeThread {
+public:
+    StreamThread(PoseAggregator &aggregator, size_t index)
+            : m_aggregator(aggregator), m_index(index) {}
+
+    void Main() override {
+        PoseSource &source = *m_aggregator.m_streams[m_index]->source;
+        try {
+            source.Start();
+            PoseSample sample;
+            while (m_active) {
+                if (source.Next(&sample, 100)) m_aggregator.Inject(m_index, sample);
+            }
+        } catch (const std::exception &) {
+            // A failed camera simply stops contributing; its samples age out of
+            // the fusion and the remaining streams carry on.
+            m_active = false;
+        }
+        // Release the camera whether or not it failed
+        try {
+            source.Stop();
+        } catch (const std::exception &) {
+        }
+    }
+
+private:
+    PoseAggregator &m_aggregator;
+    size_t m_index;
+};
+
+uint64_t ClockAligner::Update(double deviceMs, uint64_t hostUs) {
+    double deviceUs = deviceMs * 1e3;
+    double offset = static_cast<double>(hostUs) - deviceUs;
+    if (!m_valid || offset < m_offset) {
+        m_offset = offset;
+        m_valid = true;
+    } else {
+        m_offset += (offset - m_offset) * kDriftGain;
+    }
+    return static_cast<uint64_t>(deviceUs + m_offset);
+}
+
+PoseAggregator::PoseAggregator() { SetProcessNoise(Eigen::Vector3d(1, 1, 1)); }
+
+PoseAggregator::~PoseAggregator() { Stop(); }
+
+size_t PoseAggregator::AddStream(std::unique_ptr<PoseSource> source,
+                                 const CameraExtrinsics &extrinsics,
+                                 const Eigen::Vector3d &stdDevs) {
+    assert(!m_started);
+    auto stream = std::make_unique<Stream>();
+    stream->source = std::move(source);
+    stream->extrinsicRotation =
+            EulerToMatrix(extrinsics.yaw, extrinsics.pitch, extrinsics.roll);
+    stream->extrinsicTranslation =
+            Eigen::Vector3d(extrinsics.translation[0], extrinsics.translation[1],
+                            extrinsics.translation[2]);
+    stream->covariance = stdDevs.cwiseProduct(stdDevs).asDiagonal();
+    m_streams.emplace_back(std::move(stream));
+    return m_streams.size() - 1;
+}
+
+void PoseAggregator::SetProcessNoise(const Eigen::Vector3d &stdDevs) {
+    m_processNoise = stdDevs.cwiseProduct(stdDevs).asDiagonal();
+}
+
+void PoseAggregator::Reset(double x, double y, double heading) {
+    m_estimate.x = x;
+    m_estimate.y = y;
+    m_estimate.heading = WrapAngle(heading);
+    m_estimate.covariance.setZero();
+    m_lastUpdate = 0;
+    m_initialized = false;
+}
+
+void PoseAggregator::Start() {
+    if (m_started) return;
+    m_started = true;
+    for (size_t i = 0; i < m_streams.size(); ++i) {
+        m_streams[i]->thread.Start(*this, i);
+    }
+}
+
+void PoseAggregator::Stop() {
+    if (!m_started) return;
+    for (auto &stream : m_streams) stream->thread.Join();
+    m_started = false;
+}
+
+void PoseAggregator::Inject(size_t index, const PoseSample &sample) {
+    Stream &stream = *m_streams[index];
+    AlignedSample aligned;
+    aligned.sample = sample;
+    aligned.timestamp =
+            stream.clock.Update(sample.deviceTimestamp, sample.hostTimestamp);
+    stream.stats.RecordArrival(sample, aligned.timestamp);
+
+    std::lock_guard<wpi::spinlock> lock(stream.mutex);
+    stream.history.push_back(aligned);
+}
+
+bool PoseAggregator::GetMeasurement(Stream &stream, uint64_t now,
+                                    Eigen::Vector3d *z, Eigen::Matrix3d *Rinv) {
+    AlignedSample newest;
+    {
+        std::lock_guard<wpi::spinlock> lock(stream.mutex);
+        size_t i = stream.history.size();
+        // Samples can be slightly ahead of a tick that is being run for a
+        // past time; use the newest one that is not.
+        while (i > 0 && stream.history[i - 1].timestamp > now) --i;
+        if (i == 0) return false;
+        newest = stream.history[i - 1];
+    }
+
+    if (newest.timestamp <= stream.lastUsed) return false;
+    if (now - newest.timestamp > m_maxSampleAge) return false;
+    unsigned int confidence = newest.sample.confidence;
+    if (confidence > 3 || kConfidenceScale[confidence] == 0) return false;
+    stream.lastUsed = newest.timestamp;
+    stream.stats.RecordFused(newest.sample, now);
+    stream.lastFused = newest.sample;
+    stream.readPending = true;
+
+    // Camera pose relative to its own start, re-expressed with robot-style axes
+    const PoseSample &s = newest.sample;
+    Eigen::Matrix3d cameraRotation = kCameraToRobotBasis *
+                                     QuaternionToMatrix(s.rotation) *
+                                     kCameraToRobotBasis.transpose();
+    Eigen::Vector3d cameraTranslation =
+            kCameraToRobotBasis *
+            Eigen::Vector3d(s.translation[0], s.translation[1], s.translation[2]);
+
+    // Robot pose relative to its own start: T_rc * T_camera * T_rc^-1
+    const Eigen::Matrix3d &Re = stream.extrinsicRotation;
+    const Eigen::Vector3d &te = stream.extrinsicTranslation;
+    Eigen::Matrix3d robotRotation = Re * cameraRotation * Re.transpose();
+    Eigen::Vector3d robotTranslation =
+            te + Re * cameraTranslation - robotRotation * te;
+
+    (*z)(0) = robotTranslation(0);
+    (*z)(1) = robotTranslation(1);
+    (*z)(2) = std::atan2(robotRotation(1, 0), robotRotation(0, 0));
+    *Rinv = (stream.covariance * kConfidenceScale[confidence]).inverse();
+    return true;
+}
+
+const PoseStreamStats &PoseAggregator::GetStreamStats(size_t stream) const {
+    return m_streams[stream]->stats;
+}
+
+wpi::json PoseAggregator::GetTelemetry() const {
+    wpi::json streams = wpi::json::array();
+    for (auto &&stream : m_streams) streams.push_back(stream->stats.GetSnapshot());
+    return {{"streams", std::move(streams)}};
+}
+
+const FusedPose &PoseAggregator::Update() { return Update(wpi::Now()); }
+
+void PoseAggregator::MarkRead(uint64_t now) {
+    for (auto &stream : m_streams) {
+        if (!stream->readPending) continue;
+        stream->stats.RecordRead(stream->lastFused, now);
+        stream->readPending = false;
+    }
+}
+
+void PoseAggregator::MarkRead() { MarkRead(wpi::Now()); }
+
+const FusedPose &PoseAggregator::Update(uint64_t now) {
+    Eigen::Vector3d x(m_estimate.x, m_estimate.y, m_estimate.heading);
+    Eigen::Matrix3d &P = m_estimate.covariance;
+
+    // Predict: random walk
+    if (m_lastUpdate != 0 && now > m_lastUpdate) {
+        P += m_processNoise * ((now - m_lastUpdate) * 1e-6);
+    }
+    m_lastUpdate = now;
+
+    // Combine every stream's measurement into one in information form so the
+    // estimator sees a single update per tick regardless of stream count.
+    Eigen::Matrix3d infoSum = Eigen::Matrix3d::Zero();
+    Eigen::Vector3d infoResidual = Eigen::Vector3d::Zero();
+    int numMeasurements = 0;
+    for (auto &stream : m_streams) {
+        Eigen::Vector3d z;
+        Eigen::Matrix3d Rinv;
+        if (!GetMeasurement(*stream, now, &z, &Rinv)) continue;
+        Eigen::Vector3d residual = z - x;
+        residual(2) = WrapAngle(residual(2));
+        infoSum += Rinv;
+        infoResidual += Rinv * residual;
+        ++numMeasurements;
+    }
+
+    if (numMeasurements > 0) {
+        // Fused measurement z_f = x + R_f * sum(Rinv_i * r_i), R_f = sum(Rinv_i)^-1
+        Eigen::Matrix3d Rf = infoSum.inverse();
+        // The starting pose has no covariance of its own; give it the same
+        // weight as the first measurement rather than treating it as exact.
+        if (!m_initialized) {
+            P = Rf;
+            m_initialized = true;
+        }
+        Eigen::Matrix3d K = P * (P + Rf).inverse();
+        x += K * (Rf * infoResidual);
+        P = (Eigen::Matrix3d::Identity() - K) * P;
+    }
+
+    m_estimate.timestamp = now;
+    m_estimate.x = x(0);
+    m_estimate.y = x(1);
+    m_estimate.heading = WrapAngle(x(2));
+    m_estimate.numMeasurements = numMeasurements;
+    return m_estimate;
+}
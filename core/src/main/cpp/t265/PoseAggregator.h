@@ -0,0 +1,211 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <Eigen/Core>
+
+#include "PoseSource.h"
+#include "PoseTelemetry.h"
+#include "wpi/SafeThread.h"
+#include "wpi/spinlock.h"
+#include "wpi/static_circular_buffer.h"
+
+namespace t265 {
+
+/**
+ * Rigid transform from the robot frame to a camera mounted on it, i.e. the
+ * camera's pose expressed in the robot frame (x forward, y left, z up).
+ */
+    struct CameraExtrinsics {
+        /// Camera position relative to the robot center, meters
+        double translation[3] = {0, 0, 0};
+        /// Camera yaw (about robot z) relative to the robot, radians
+        double yaw = 0;
+        /// Camera pitch (about robot y), radians
+        double pitch = 0;
+        /// Camera roll (about robot x), radians
+        double roll = 0;
+    };
+
+/**
+ * Planar robot pose produced by one fusion tick.
+ */
+    struct FusedPose {
+        /// Aligned host time of the estimate, microseconds
+        uint64_t timestamp = 0;
+        double x = 0;
+        double y = 0;
+        double heading = 0;
+        /// Covariance of (x, y, heading)
+        Eigen::Matrix3d covariance = Eigen::Matrix3d::Zero();
+        /// Number of streams that contributed a measurement this tick
+        int numMeasurements = 0;
+    };
+
+/**
+ * Maps a device clock onto the host clock.
+ *
+ * Transport latency only ever delays arrival, so the smallest observed
+ * host-minus-device difference is the best estimate of the true offset. The
+ * estimate is allowed to creep upward slowly so that it follows drift between
+ * the two oscillators.
+ */
+    class ClockAligner {
+    public:
+        /**
+         * Feeds a sample pair and returns the device time mapped to host time.
+         *
+         * @param deviceMs device timestamp, milliseconds
+         * @param hostUs host arrival timestamp, microseconds
+         * @return aligned host timestamp, microseconds
+         */
+        uint64_t Update(double deviceMs, uint64_t hostUs);
+
+        /// Returns the current host-minus-device offset, microseconds
+        double GetOffset() const { return m_offset; }
+
+        bool IsValid() const { return m_valid; }
+
+    private:
+        static constexpr double kDriftGain = 1e-3;
+
+        double m_offset = 0;
+        bool m_valid = false;
+    };
+
+/**
+ * Fuses pose streams from several tracking cameras into one robot pose.
+ *
+ * Each stream is serviced by its own thread, which timestamps samples,
+ * aligns them to the host clock and pushes them into a fixed-size ring. Once
+ * per tick Update() takes the newest sample from every stream, transforms it
+ * through that camera's extrinsics into a common robot-origin frame, and
+ * applies all of them to a planar (x, y, heading) estimator in a single
+ * information-form update weighted by each camera's covariance.
+ *
+ * Streams must be added before Start(). Nothing on the per-frame or per-tick
+ * path allocates.
+ */
+    class PoseAggregator {
+    public:
+        /// Number of samples retained per stream
+        static constexpr size_t kHistorySize = 32;
+
+        PoseAggregator();
+
+        ~PoseAggregator();
+
+        PoseAggregator(const PoseAggregator &) = delete;
+
+        PoseAggregator &operator=(const PoseAggregator &) = delete;
+
+        /**
+         * Adds a camera.
+         *
+         * @param source source of samples for this camera
+         * @param extrinsics pose of the camera on the robot
+         * @param stdDevs measurement standard deviations for (x, y, heading) at
+         *                high tracker confidence; lower confidence inflates these
+         * @return stream index
+         */
+        size_t AddStream(std::unique_ptr<PoseSource> source,
+                         const CameraExtrinsics &extrinsics,
+                         const Eigen::Vector3d &stdDevs);
+
+        size_t GetNumStreams() const { return m_streams.size(); }
+
+        /**
+         * Sets the random-walk process noise, as standard deviations per
+         * second of (x, y, heading).
+         */
+        void SetProcessNoise(const Eigen::Vector3d &stdDevs);
+
+        /**
+         * Sets how old a stream's newest sample may be, relative to the tick
+         * time, before that stream is left out of the update.
+         */
+        void SetMaxSampleAge(uint64_t maxAgeUs) { m_maxSampleAge = maxAgeUs; }
+
+        /**
+         * Resets the estimate to the given pose. The first tick with a
+         * measurement weighs this pose equally with that measurement.
+         */
+        void Reset(double x, double y, double heading);
+
+        /// Starts the per-stream threads.
+        void Start();
+
+        /// Stops and joins the per-stream threads.
+        void Stop();
+
+        /**
+         * Runs one fusion tick.
+         *
+         * @param now tick time on the host clock, microseconds
+         * @return the fused estimate
+         */
+        const FusedPose &Update(uint64_t now);
+
+        /**
+         * Runs one fusion tick at wpi::Now().
+         */
+        const FusedPose &Update();
+
+        /**
+         * Reports that the consumer of the estimate (such as the JNI binding
+         * handing it to Java) has read it. Records, for each stream that
+         * contributed to the latest tick, the time from its sample's arrival
+         * to this read in the stream's read latency histogram. Each sample is
+         * recorded once, however often the estimate is read.
+         *
+         * Must be called from the thread calling Update().
+         *
+         * @param now host time of the read, microseconds
+         */
+        void MarkRead(uint64_t now);
+
+        /**
+         * Reports a read of the estimate at wpi::Now().
+         */
+        void MarkRead();
+
+        /**
+         * Pushes a sample into a stream as if its thread had received it.
+         * Intended for driving the engine from recorded or synthetic data
+         * without starting threads.
+         */
+        void Inject(size_t stream, const PoseSample &sample);
+
+        const FusedPose &GetEstimate() const { return m_estimate; }
+
+        /// Returns health statistics for a stream.
+        const PoseStreamStats &GetStreamStats(size_t stream) const;
+
+        /**
+         * Returns health statistics for every stream as a JSON object, suitable
+         * for serving through TelemetryServer.
+         */
+        wpi::json GetTelemetry() const;
+
+    private:
+        struct Stream;
+
+        class StreamThread;
+
+        bool GetMeasurement(Stream &stream, uint64_t now, Eigen::Vector3d *z,
+                            Eigen::Matrix3d *Rinv);
+
+        std::vector<std::unique_ptr<Stream>> m_streams;
+        Eigen::Matrix3d m_processNoise;
+        uint64_t m_maxSampleAge = 100000;
+        uint64_t m_lastUpdate = 0;
+        FusedPose m_estimate;
+        // Whether the estimate has taken a measurement since the last reset
+        bool m_initialized = false;
+        bool m_started = false;
+    };
+
+}  // namespace t265
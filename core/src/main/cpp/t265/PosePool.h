@@ -0,0 +1,87 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "PoseSource.h"
+
+namespace t265 {
+
+/**
+ * A fixed pool of pose records shared between one producer (the librealsense
+ * frame callback) and one consumer.
+ *
+ * The producer extracts a pose straight into a free slot with BeginWrite() /
+ * CommitWrite(), so the frame can be released as soon as the copy is done.
+ * Nothing here allocates; if the consumer falls behind and the pool is full
+ * the newest sample is dropped and counted.
+ *
+ * @tparam N number of slots; must be a power of two
+ */
+    template<size_t N>
+    class PosePool {
+    public:
+        static_assert(N > 0 && (N & (N - 1)) == 0,
+                      "The pool size must be a power of two.");
+
+        /**
+         * Returns the next free slot, or nullptr if the pool is full. Producer
+         * only. The slot is not visible to the consumer until CommitWrite().
+         */
+        PoseSample *BeginWrite() {
+            uint64_t tail = m_tail.load(std::memory_order_relaxed);
+            if (tail - m_head.load(std::memory_order_acquire) == N) {
+                m_dropped.fetch_add(1, std::memory_order_relaxed);
+                return nullptr;
+            }
+            return &m_slots[tail & (N - 1)];
+        }
+
+        /**
+         * Publishes the slot returned by the last BeginWrite(). Producer only.
+         */
+        void CommitWrite() {
+            m_tail.store(m_tail.load(std::memory_order_relaxed) + 1,
+                         std::memory_order_release);
+        }
+
+        /**
+         * Copies out and frees the oldest record. Consumer only.
+         *
+         * @return False if the pool is empty
+         */
+        bool Pop(PoseSample *sample) {
+            uint64_t head = m_head.load(std::memory_order_relaxed);
+            if (head == m_tail.load(std::memory_order_acquire)) return false;
+            *sample = m_slots[head & (N - 1)];
+            m_head.store(head + 1, std::memory_order_release);
+            return true;
+        }
+
+        bool empty() const {
+            return m_head.load(std::memory_order_acquire) ==
+                   m_tail.load(std::memory_order_acquire);
+        }
+
+        size_t size() const {
+            return m_tail.load(std::memory_order_acquire) -
+                   m_head.load(std::memory_order_acquire);
+        }
+
+        static constexpr size_t capacity() { return N; }
+
+        /// Returns the number of samples dropped because the pool was full.
+        uint64_t GetDropped() const {
+            return m_dropped.load(std::memory_order_relaxed);
+        }
+
+    private:
+        PoseSample m_slots[N];
+        // Separate cache lines so producer and consumer do not false-share
+        alignas(64) std::atomic<uint64_t> m_head{0};
+        alignas(64) std::atomic<uint64_t> m_tail{0};
+        std::atomic<uint64_t> m_dropped{0};
+    };
+
+}  // namespace t265
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+
+namespace t265 {
+
+/**
+ * A single 6-DoF pose reported by a tracking camera, in the camera's own
+ * (librealsense) coordinate frame.
+ *
+ * This is deliberately a plain aggregate of scalars so that it can live in
+ * fixed-size ring buffers without any alignment or heap requirements.
+ */
+    struct PoseSample {
+        /// Device timestamp, in milliseconds, as reported by the camera
+        double deviceTimestamp = 0;
+        /// Host time the sample arrived at, in microseconds (wpi::Now() epoch)
+        uint64_t hostTimestamp = 0;
+        /// Monotonically increasing frame counter from the device
+        uint64_t frameNumber = 0;
+
+        /// Translation in meters
+        double translation[3] = {0, 0, 0};
+        /// Rotation quaternion, ordered x, y, z, w
+        double rotation[4] = {0, 0, 0, 1};
+        /// Linear velocity in meters/sec
+        double velocity[3] = {0, 0, 0};
+        /// Angular velocity in radians/sec
+        double angularVelocity[3] = {0, 0, 0};
+
+        /// Tracker confidence, 0 (failed) to 3 (high)
+        unsigned int confidence = 0;
+    };
+
+/**
+ * A blocking source of pose samples for a single camera.
+ *
+ * The aggregation engine runs one thread per source and calls Next() in a
+ * loop, so implementations may block in Next(). Hardware sources wrap a
+ * librealsense pipeline; synthetic sources can be used to exercise the engine
+ * without a camera attached.
+ */
+    class PoseSource {
+    public:
+        virtual ~PoseSource() = default;
+
+        /**
+         * Waits for the next sample.
+         *
+         * @param sample where to store the sample
+         * @param timeoutMs maximum time to block, in milliseconds
+         * @return False if no sample arrived within the timeout
+         */
+        virtual bool Next(PoseSample *sample, unsigned int timeoutMs) = 0;
+
+        /**
+         * Starts producing samples. Called once from the owning thread before
+         * the first call to Next().
+         */
+        virtual void Start() {}
+
+        /**
+         * Stops producing samples. Called once after the last call to Next(),
+         * including when Start() or Next() threw, so it must cope with a
+         * partially started source.
+         */
+        virtual void Stop() {}
+    };
+
+}  // namespace t265
@@ -0,0 +1,132 @@
+#include "PoseTelemetry.h"
+
+#include "wpi/MathExtras.h"
+
+using namespace t265;
+
+size_t LatencyHistogram::BucketIndex(uint64_t value) {
+    if (value < kSubBuckets) return value;
+    unsigned int msb = 63 - wpi::countLeadingZeros(value);
+    if (msb >= kMaxBits) return kNumBuckets - 1;
+    unsigned int shift = msb - kSubBucketBits;
+    size_t sub = (value >> shift) & (kSubBuckets - 1);
+    return (shift + 1) * kSubBuckets + sub;
+}
+
+uint64_t LatencyHistogram::BucketLowerBound(size_t index) {
+    if (index < kSubBuckets) return index;
+    unsigned int shift = index / kSubBuckets - 1;
+    uint64_t sub = index % kSubBuckets;
+    return (kSubBuckets + sub) << shift;
+}
+
+void LatencyHistogram::Record(uint64_t value) {
+    m_buckets[BucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+    m_sum.fetch_add(value, std::memory_order_relaxed);
+
+    uint64_t max = m_max.load(std::memory_order_relaxed);
+    while (value > max &&
+           !m_max.compare_exchange_weak(max, value, std::memory_order_relaxed)) {
+    }
+}
+
+uint64_t LatencyHistogram::GetPercentile(double percentile) const {
+    // Sum the buckets rather than trusting m_count, which may be a few
+    // increments ahead while another thread is recording.
+    uint64_t total = 0;
+    for (auto &&bucket : m_buckets) total += bucket.load(std::memory_order_relaxed);
+    if (total == 0) return 0;
+
+    uint64_t target = static_cast<uint64_t>(percentile / 100.0 * total);
+    if (target >= total) target = total - 1;
+    uint64_t seen = 0;
+    for (size_t i = 0; i < kNumBuckets; ++i) {
+        seen += m_buckets[i].load(std::memory_order_relaxed);
+        if (seen > target) return BucketLowerBound(i);
+    }
+    return BucketLowerBound(kNumBuckets - 1);
+}
+
+double LatencyHistogram::GetMean() const {
+    uint64_t count = GetCount();
+    if (count == 0) return 0;
+    return static_cast<double>(m_sum.load(std::memory_order_relaxed)) / count;
+}
+
+void LatencyHistogram::Reset() {
+    for (auto &&bucket : m_buckets) bucket.store(0, std::memory_order_relaxed);
+    m_count.store(0, std::memory_order_relaxed);
+    m_sum.store(0, std::memory_order_relaxed);
+    m_max.store(0, std::memory_order_relaxed);
+}
+
+wpi::json LatencyHistogram::GetSnapshot() const {
+    return {{"count", GetCount()},
+            {"mean", GetMean()},
+            {"max", GetMax()},
+            {"p50", GetPercentile(50)},
+            {"p90", GetPercentile(90)},
+            {"p99", GetPercentile(99)},
+            {"p999", GetPercentile(99.9)}};
+}
+
+void PoseStreamStats::RecordArrival(const PoseSample &sample,
+                                    uint64_t alignedTimestamp) {
+    uint64_t frames = m_frames.fetch_add(1, std::memory_order_relaxed);
+
+    // Only the receiving thread writes these, so plain load/store is enough
+    uint64_t last = m_lastFrameNumber.load(std::memory_order_relaxed);
+    if (frames > 0) {
+        if (sample.frameNumber <= last) {
+            m_duplicates.fetch_add(1, std::memory_order_relaxed);
+        } else if (sample.frameNumber > last + 1) {
+            m_dropped.fetch_add(sample.frameNumber - last - 1,
+                                std::memory_order_relaxed);
+        }
+    }
+    if (frames == 0 || sample.frameNumber > last) {
+        m_lastFrameNumber.store(sample.frameNumber, std::memory_order_relaxed);
+    }
+
+    unsigned int confidence = m_confidence.load(std::memory_order_relaxed);
+    if (frames > 0 && sample.confidence != confidence) {
+        m_confidenceTransitions.fetch_add(1, std::memory_order_relaxed);
+    }
+    m_confidence.store(sample.confidence, std::memory_order_relaxed);
+
+    m_arrivalLatency.Record(sample.hostTimestamp > alignedTimestamp
+                            ? sample.hostTimestamp - alignedTimestamp
+                            : 0);
+}
+
+void PoseStreamStats::RecordFused(const PoseSample &sample, uint64_t now) {
+    m_fuseLatency.Record(now > sample.hostTimestamp ? now - sample.hostTimestamp
+                                                    : 0);
+}
+
+void PoseStreamStats::RecordRead(const PoseSample &sample, uint64_t now) {
+    m_readLatency.Record(now > sample.hostTimestamp ? now - sample.hostTimestamp
+                                                    : 0);
+}
+
+void PoseStreamStats::Reset() {
+    m_arrivalLatency.Reset();
+    m_fuseLatency.Reset();
+    m_readLatency.Reset();
+    m_frames.store(0, std::memory_order_relaxed);
+    m_dropped.store(0, std::memory_order_relaxed);
+    m_duplicates.store(0, std::memory_order_relaxed);
+    m_confidenceTransitions.store(0, std::memory_order_relaxed);
+}
+
+wpi::json PoseStreamStats::GetSnapshot() const {
+    return {{"frames", GetFrames()},
+            {"dropped", GetDropped()},
+            {"duplicates", GetDuplicates()},
+            {"confidence", m_confidence.load(std::memory_order_relaxed)},
+            {"confidenceTransitions", GetConfidenceTransitions()},
+            {"arrivalLatencyUs", m_arrivalLatency.GetSnapshot()},
+            {"fuseLatencyUs", m_fuseLatency.GetSnapshot()},
+            {"readLatencyUs", m_readLatency.GetSnapshot()}};
+}
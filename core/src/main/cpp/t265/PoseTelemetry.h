@@ -0,0 +1,155 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "PoseSource.h"
+#include "wpi/json.h"
+
+namespace t265 {
+
+/**
+ * A log-bucketed (HDR-style) latency histogram that is safe to record into
+ * from one or more threads while another thread takes snapshots.
+ *
+ * Values are bucketed with kSubBuckets linear sub-buckets per power of two,
+ * giving a constant relative error of 1/kSubBuckets (12.5%) across the whole
+ * range without any per-value allocation. Recording is a handful of relaxed
+ * atomic increments.
+ */
+    class LatencyHistogram {
+    public:
+        static constexpr unsigned int kSubBucketBits = 3;
+        static constexpr unsigned int kSubBuckets = 1u << kSubBucketBits;
+        /// Values at or above 2^kMaxBits microseconds land in the last bucket
+        static constexpr unsigned int kMaxBits = 32;
+        static constexpr size_t kNumBuckets =
+                (kMaxBits - kSubBucketBits + 1) * kSubBuckets;
+
+        /**
+         * Records a value.
+         *
+         * @param value latency in microseconds
+         */
+        void Record(uint64_t value);
+
+        /// Returns the bucket a value falls in.
+        static size_t BucketIndex(uint64_t value);
+
+        /// Returns the smallest value that falls in a bucket.
+        static uint64_t BucketLowerBound(size_t index);
+
+        /**
+         * Returns an approximate percentile (the lower bound of the bucket it
+         * falls in), or 0 if nothing has been recorded.
+         *
+         * @param percentile percentile in [0, 100]
+         */
+        uint64_t GetPercentile(double percentile) const;
+
+        uint64_t GetCount() const { return m_count.load(std::memory_order_relaxed); }
+
+        uint64_t GetMax() const { return m_max.load(std::memory_order_relaxed); }
+
+        double GetMean() const;
+
+        void Reset();
+
+        /**
+         * Returns count, mean, max and common percentiles as a JSON object.
+         */
+        wpi::json GetSnapshot() const;
+
+    private:
+        std::atomic<uint64_t> m_buckets[kNumBuckets] = {};
+        std::atomic<uint64_t> m_count{0};
+        std::atomic<uint64_t> m_sum{0};
+        std::atomic<uint64_t> m_max{0};
+    };
+
+/**
+ * Health counters and latency histograms for one pose stream.
+ *
+ * RecordArrival() is called by the thread that receives frames, and
+ * RecordFused() and RecordRead() by the thread that runs the fusion;
+ * GetSnapshot() may be called from anywhere (such as a telemetry server
+ * loop).
+ */
+    class PoseStreamStats {
+    public:
+        /**
+         * Records a frame as it arrives from the device.
+         *
+         * @param sample the frame
+         * @param alignedTimestamp device timestamp mapped onto the host clock,
+         *                         microseconds
+         */
+        void RecordArrival(const PoseSample &sample, uint64_t alignedTimestamp);
+
+        /**
+         * Records a frame being used by a fusion tick.
+         *
+         * @param sample the frame
+         * @param now host time of the tick, microseconds
+         */
+        void RecordFused(const PoseSample &sample, uint64_t now);
+
+        /**
+         * Records the estimate built from a frame being read by its consumer
+         * (see PoseAggregator::MarkRead()).
+         *
+         * @param sample the frame
+         * @param now host time of the read, microseconds
+         */
+        void RecordRead(const PoseSample &sample, uint64_t now);
+
+        uint64_t GetFrames() const { return m_frames.load(std::memory_order_relaxed); }
+
+        uint64_t GetDropped() const {
+            return m_dropped.load(std::memory_order_relaxed);
+        }
+
+        uint64_t GetDuplicates() const {
+            return m_duplicates.load(std::memory_order_relaxed);
+        }
+
+        uint64_t GetConfidenceTransitions() const {
+            return m_confidenceTransitions.load(std::memory_order_relaxed);
+        }
+
+        /**
+         * Time from the (clock-aligned) device timestamp to arrival on the host.
+         * Because the clock alignment is anchored to the fastest observed
+         * delivery, this measures latency in excess of the best case.
+         */
+        const LatencyHistogram &GetArrivalLatency() const { return m_arrivalLatency; }
+
+        /// Time from arrival on the host to being used by a fusion tick.
+        const LatencyHistogram &GetFuseLatency() const { return m_fuseLatency; }
+
+        /**
+         * Time from arrival on the host to the consumer (such as Java code, via
+         * JNI) reading the estimate the frame went into. Empty unless the
+         * consumer reports its reads through PoseAggregator::MarkRead().
+         */
+        const LatencyHistogram &GetReadLatency() const { return m_readLatency; }
+
+        void Reset();
+
+        wpi::json GetSnapshot() const;
+
+    private:
+        LatencyHistogram m_arrivalLatency;
+        LatencyHistogram m_fuseLatency;
+        LatencyHistogram m_readLatency;
+
+        std::atomic<uint64_t> m_frames{0};
+        std::atomic<uint64_t> m_dropped{0};
+        std::atomic<uint64_t> m_duplicates{0};
+        std::atomic<uint64_t> m_confidenceTransitions{0};
+        std::atomic<uint64_t> m_lastFrameNumber{0};
+        std::atomic<unsigned int> m_confidence{0};
+    };
+
+}  // namespace t265
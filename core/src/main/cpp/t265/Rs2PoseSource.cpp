@@ -0,0 +1,198 @@
+#include "Rs2PoseSource.h"
+
+#include <chrono>
+#include <mutex>
+#include <stdexcept>
+
+#include <librealsense2/rs.h>
+#include <librealsense2/h/rs_pipeline.h>
+
+#include "wpi/timestamp.h"
+
+namespace t265 {
+
+    void CheckError(rs2_error *error) {
+        if (!error) return;
+
+        std::string message = std::string(rs2_get_failed_function(error)) + "(" +
+                              rs2_get_failed_args(error) +
+                              "): " + rs2_get_error_message(error);
+        rs2_free_error(error);
+        throw std::runtime_error(message);
+    }
+
+    bool ExtractPose(const rs2_frame *frame, PoseSample *sample) {
+        rs2_error *e = nullptr;
+        if (rs2_is_frame_extendable_to(frame, RS2_EXTENSION_POSE_FRAME, &e) == 0) {
+            CheckError(e);
+            return false;
+        }
+
+        rs2_pose pose;
+        rs2_pose_frame_get_pose_data(frame, &pose, &e);
+        CheckError(e);
+
+        sample->deviceTimestamp = rs2_get_frame_timestamp(frame, &e);
+        CheckError(e);
+        sample->frameNumber = rs2_get_frame_number(frame, &e);
+        CheckError(e);
+        sample->hostTimestamp = wpi::Now();
+
+        sample->translation[0] = pose.translation.x;
+        sample->translation[1] = pose.translation.y;
+        sample->translation[2] = pose.translation.z;
+        sample->rotation[0] = pose.rotation.x;
+        sample->rotation[1] = pose.rotation.y;
+        sample->rotation[2] = pose.rotation.z;
+        sample->rotation[3] = pose.rotation.w;
+        sample->velocity[0] = pose.velocity.x;
+        sample->velocity[1] = pose.velocity.y;
+        sample->velocity[2] = pose.velocity.z;
+        sample->angularVelocity[0] = pose.angular_velocity.x;
+        sample->angularVelocity[1] = pose.angular_velocity.y;
+        sample->angularVelocity[2] = pose.angular_velocity.z;
+        sample->confidence = pose.tracker_confidence;
+        return true;
+    }
+
+    Rs2PipelinePoseSource::Rs2PipelinePoseSource(std::string serial)
+            : m_serial(std::move(serial)) {}
+
+    Rs2PipelinePoseSource::~Rs2PipelinePoseSource() { Stop(); }
+
+    void Rs2PipelinePoseSource::Start() { StartPipeline(nullptr, nullptr); }
+
+    void Rs2PipelinePoseSource::StartPipeline(void (*callback)(rs2_frame *, void *),
+                                              void *user) {
+        rs2_error *e = nullptr;
+        m_context = rs2_create_context(RS2_API_VERSION, &e);
+        CheckError(e);
+        m_pipeline = rs2_create_pipeline(m_context, &e);
+        CheckError(e);
+
+        rs2_config *config = rs2_create_config(&e);
+        CheckError(e);
+        if (!m_serial.empty()) {
+            rs2_config_enable_device(config, m_serial.c_str(), &e);
+        }
+        if (!e) {
+            rs2_config_enable_stream(config, RS2_STREAM_POSE, -1, 0, 0,
+                                     RS2_FORMAT_6DOF, 0, &e);
+        }
+        if (!e) {
+            if (callback) {
+                m_profile = rs2_pipeline_start_with_config_and_callback(
+                        m_pipeline, config, callback, user, &e);
+            } else {
+                m_profile = rs2_pipeline_start_with_config(m_pipeline, config, &e);
+            }
+        }
+        rs2_delete_config(config);
+        CheckError(e);
+    }
+
+    void Rs2PipelinePoseSource::Stop() {
+        if (m_profile) {
+            // errors on shutdown are not actionable
+            rs2_pipeline_stop(m_pipeline, nullptr);
+            rs2_delete_pipeline_profile(m_profile);
+            m_profile = nullptr;
+        }
+        if (m_pipeline) {
+            rs2_delete_pipeline(m_pipeline);
+            m_pipeline = nullptr;
+        }
+        if (m_context) {
+            rs2_delete_context(m_context);
+            m_context = nullptr;
+        }
+    }
+
+    bool Rs2PipelinePoseSource::Next(PoseSample *sample, unsigned int timeoutMs) {
+        rs2_error *e = nullptr;
+        rs2_frame *frames = nullptr;
+        if (!rs2_pipeline_try_wait_for_frames(m_pipeline, &frames, timeoutMs, &e)) {
+            CheckError(e);
+            return false;
+        }
+
+        // The pipeline always hands back a frameset; find the pose inside it
+        bool found = false;
+        int count = rs2_embedded_frames_count(frames, &e);
+        for (int i = 0; i < count && !found && !e; ++i) {
+            rs2_frame *frame = rs2_extract_frame(frames, i, &e);
+            if (e) break;
+            try {
+                found = ExtractPose(frame, sample);
+            } catch (...) {
+                rs2_release_frame(frame);
+                rs2_release_frame(frames);
+                throw;
+            }
+            rs2_release_frame(frame);
+        }
+        rs2_release_frame(frames);
+        CheckError(e);
+        return found;
+    }
+
+    Rs2CallbackPoseSource::~Rs2CallbackPoseSource() { Stop(); }
+
+    void Rs2CallbackPoseSource::Start() { StartPipeline(OnFrame, this); }
+
+    void Rs2CallbackPoseSource::Stop() {
+        Rs2PipelinePoseSource::Stop();
+        m_cond.notify_all();
+    }
+
+    void Rs2CallbackPoseSource::OnFrame(rs2_frame *frame, void *user) {
+        auto self = static_cast<Rs2CallbackPoseSource *>(user);
+
+        // Exceptions must not unwind into librealsense
+        rs2_frame *f = nullptr;
+        try {
+            PoseSample *slot = self->m_pool.BeginWrite();
+            bool found = false;
+            if (slot) {
+                rs2_error *e = nullptr;
+                if (rs2_is_frame_extendable_to(frame, RS2_EXTENSION_COMPOSITE_FRAME,
+                                               &e)) {
+                    int count = rs2_embedded_frames_count(frame, &e);
+                    for (int i = 0; i < count && !found && !e; ++i) {
+                        f = rs2_extract_frame(frame, i, &e);
+                        if (e) break;
+                        found = ExtractPose(f, slot);
+                        rs2_release_frame(f);
+                        f = nullptr;
+                    }
+                } else if (!e) {
+                    found = ExtractPose(frame, slot);
+                }
+                if (e) rs2_free_error(e);
+            }
+            rs2_release_frame(frame);
+            frame = nullptr;
+
+            if (found) {
+                {
+                    std::scoped_lock lock(self->m_mutex);
+                    self->m_pool.CommitWrite();
+                }
+                self->m_cond.notify_one();
+            }
+        } catch (...) {
+            if (f) rs2_release_frame(f);
+            if (frame) rs2_release_frame(frame);
+        }
+    }
+
+    bool Rs2CallbackPoseSource::Next(PoseSample *sample, unsigned int timeoutMs) {
+        if (m_pool.Pop(sample)) return true;
+
+        std::unique_lock lock(m_mutex);
+        m_cond.wait_for(lock, std::chrono::milliseconds(timeoutMs),
+                        [&] { return !m_pool.empty(); });
+        return m_pool.Pop(sample);
+    }
+
+}  // namespace t265
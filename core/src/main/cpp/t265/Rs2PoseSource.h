@@ -0,0 +1,107 @@
+#pragma once
+
+#include <string>
+
+#include "PosePool.h"
+#include "PoseSource.h"
+#include "wpi/condition_variable.h"
+#include "wpi/mutex.h"
+
+struct rs2_context;
+struct rs2_pipeline;
+struct rs2_pipeline_profile;
+struct rs2_frame;
+struct rs2_error;
+
+namespace t265 {
+
+/**
+ * Throws a std::runtime_error describing (and freeing) a librealsense error,
+ * if there is one.
+ */
+    void CheckError(rs2_error *error);
+
+/**
+ * Copies the pose carried by a librealsense pose frame into a sample. Does
+ * not take ownership of the frame.
+ *
+ * @return False if the frame is not a pose frame
+ */
+    bool ExtractPose(const rs2_frame *frame, PoseSample *sample);
+
+/**
+ * A pose source backed by a librealsense pipeline for a single T265.
+ *
+ * Uses the librealsense C API directly so that several of these can coexist
+ * (one per camera) without the reference-counted C++ wrapper objects.
+ */
+    class Rs2PipelinePoseSource : public PoseSource {
+    public:
+        /**
+         * @param serial serial number of the camera to open; if empty the first
+         *               pose-capable device found is used
+         */
+        explicit Rs2PipelinePoseSource(std::string serial = std::string{});
+
+        ~Rs2PipelinePoseSource() override;
+
+        Rs2PipelinePoseSource(const Rs2PipelinePoseSource &) = delete;
+
+        Rs2PipelinePoseSource &operator=(const Rs2PipelinePoseSource &) = delete;
+
+        void Start() override;
+
+        void Stop() override;
+
+        bool Next(PoseSample *sample, unsigned int timeoutMs) override;
+
+    protected:
+        /**
+         * Opens the camera and starts streaming poses. If a callback is given,
+         * frames are delivered to it instead of being queued for Next().
+         */
+        void StartPipeline(void (*callback)(rs2_frame *, void *), void *user);
+
+    private:
+        std::string m_serial;
+        rs2_context *m_context = nullptr;
+        rs2_pipeline *m_pipeline = nullptr;
+        rs2_pipeline_profile *m_profile = nullptr;
+    };
+
+/**
+ * A pose source driven by the librealsense frame callback.
+ *
+ * The callback is a plain C function pointer registered through the C API, so
+ * there is no std::function or reference-counted rs2::frame per frame. Each
+ * pose is copied straight into a preallocated pool slot and the frame is
+ * released before the callback returns; nothing on that path touches the
+ * heap. Next() hands the pooled records to the consuming thread.
+ */
+    class Rs2CallbackPoseSource : public Rs2PipelinePoseSource {
+    public:
+        /// Number of pooled pose records (~300 ms at 200 Hz)
+        static constexpr size_t kPoolSize = 64;
+
+        using Rs2PipelinePoseSource::Rs2PipelinePoseSource;
+
+        ~Rs2CallbackPoseSource() override;
+
+        void Start() override;
+
+        void Stop() override;
+
+        bool Next(PoseSample *sample, unsigned int timeoutMs) override;
+
+        /// Returns the number of poses dropped because the consumer fell behind.
+        uint64_t GetDropped() const { return m_pool.GetDropped(); }
+
+    private:
+        static void OnFrame(rs2_frame *frame, void *user);
+
+        PosePool<kPoolSize> m_pool;
+        wpi::mutex m_mutex;
+        wpi::condition_variable m_cond;
+    };
+
+}  // namespace t265
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+#include "PoseSource.h"
+#include "wpi/timestamp.h"
+
+namespace t265 {
+
+/**
+ * A pose source that translates at a constant velocity while spinning at a
+ * constant yaw rate.
+ *
+ * Used to exercise the aggregation engine (threads, clock alignment and
+ * fusion) without hardware. The device clock is simulated as the host clock
+ * shifted by a fixed offset, which the engine is expected to recover.
+ */
+    class SyntheticPoseSource : public PoseSource {
+    public:
+        /**
+         * @param rateHz sample rate
+         * @param velocity linear velocity in the camera's start frame, meters/sec
+         * @param yawRate rotation rate about the camera's up (y) axis, rad/sec
+         * @param clockOffsetMs device clock minus host clock, milliseconds
+         */
+        SyntheticPoseSource(double rateHz, const double velocity[3], double yawRate,
+                            double clockOffsetMs = 0)
+                : m_period(1.0 / rateHz),
+                  m_yawRate(yawRate),
+                  m_clockOffsetMs(clockOffsetMs) {
+            for (int i = 0; i < 3; ++i) m_velocity[i] = velocity[i];
+        }
+
+        void Start() override { m_startTime = wpi::Now(); }
+
+        bool Next(PoseSample *sample, unsigned int timeoutMs) override {
+            if (m_period > timeoutMs * 1e-3) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(timeoutMs));
+                return false;
+            }
+            std::this_thread::sleep_for(std::chrono::duration<double>(m_period));
+
+            uint64_t now = wpi::Now();
+            double t = (now - m_startTime) * 1e-6;
+            double yaw = m_yawRate * t;
+
+            sample->hostTimestamp = now;
+            sample->deviceTimestamp = now * 1e-3 + m_clockOffsetMs;
+            sample->frameNumber = ++m_frameNumber;
+            for (int i = 0; i < 3; ++i) {
+                sample->translation[i] = m_velocity[i] * t;
+                sample->velocity[i] = m_velocity[i];
+                sample->angularVelocity[i] = 0;
+            }
+            sample->angularVelocity[1] = m_yawRate;
+            sample->rotation[0] = 0;
+            sample->rotation[1] = std::sin(yaw / 2);
+            sample->rotation[2] = 0;
+            sample->rotation[3] = std::cos(yaw / 2);
+            sample->confidence = 3;
+            return true;
+        }
+
+    private:
+        double m_period;
+        double m_velocity[3];
+        double m_yawRate;
+        double m_clockOffsetMs;
+        uint64_t m_startTime = 0;
+        uint64_t m_frameNumber = 0;
+    };
+
+}  // namespace t265
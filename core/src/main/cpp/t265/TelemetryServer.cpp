@@ -0,0 +1,109 @@
+#include "TelemetryServer.h"
+
+#include "wpi/HttpWebSocketServerConnection.h"
+#include "wpi/UrlParser.h"
+#include "wpi/raw_uv_ostream.h"
+#include "wpi/uv/Loop.h"
+#include "wpi/uv/Tcp.h"
+#include "wpi/uv/Timer.h"
+
+using namespace t265;
+
+namespace uv = wpi::uv;
+
+class TelemetryServer::Connection
+        : public wpi::HttpWebSocketServerConnection<Connection> {
+public:
+    Connection(std::shared_ptr<uv::Stream> stream, const TelemetryServer &server)
+            : HttpWebSocketServerConnection(stream, {}), m_server(server) {}
+
+protected:
+    void ProcessRequest() override;
+
+    void ProcessWsUpgrade() override;
+
+private:
+    bool IsTelemetryPath() const;
+
+    const TelemetryServer &m_server;
+};
+
+bool TelemetryServer::Connection::IsTelemetryPath() const {
+    wpi::StringRef url = m_request.GetUrl();
+    wpi::UrlParser parser{url, false};
+    if (!parser.IsValid()) return false;
+    return parser.GetPath() == "/telemetry";
+}
+
+void TelemetryServer::Connection::ProcessRequest() {
+    if (m_request.GetMethod() != wpi::HTTP_GET) {
+        SendError(405);
+        return;
+    }
+    if (!IsTelemetryPath()) {
+        SendError(404);
+        return;
+    }
+    SendResponse(200, "OK", "application/json", m_server.GetSnapshot().dump());
+}
+
+void TelemetryServer::Connection::ProcessWsUpgrade() {
+    if (!IsTelemetryPath()) {
+        m_websocket->Fail(1008, "unknown path");
+        return;
+    }
+
+    auto timer = uv::Timer::Create(m_stream.GetLoopRef());
+    if (!timer) return;
+
+    wpi::WebSocket *ws = m_websocket;
+    timer->timeout.connect([ws, server = &m_server] {
+        wpi::SmallVector<uv::Buffer, 4> bufs;
+        wpi::raw_uv_ostream os{bufs, 4096};
+        server->GetSnapshot().dump(os);
+        ws->SendText(bufs, [](auto bufs, uv::Error) {
+            for (auto &&buf : bufs) buf.Deallocate();
+        });
+    });
+    m_websocket->closed.connect(
+            [timer](uint16_t, wpi::StringRef) { timer->Close(); });
+    timer->Start(m_server.m_period, m_server.m_period);
+}
+
+TelemetryServer::TelemetryServer(unsigned int port,
+                                 std::chrono::milliseconds period)
+        : m_port(port), m_period(period) {}
+
+TelemetryServer::~TelemetryServer() {
+    // Stop the loop (and with it every connection) before the providers go away
+    m_loop.reset();
+}
+
+void TelemetryServer::Add(wpi::StringRef name, Provider provider) {
+    m_providers.emplace_back(name, std::move(provider));
+}
+
+wpi::json TelemetryServer::GetSnapshot() const {
+    wpi::json snapshot = wpi::json::object();
+    for (auto &&provider : m_providers) {
+        snapshot[provider.first] = provider.second();
+    }
+    return snapshot;
+}
+
+void TelemetryServer::Start() {
+    if (m_loop) return;
+    m_loop = std::make_unique<wpi::EventLoopRunner>();
+    m_loop->ExecAsync([this](uv::Loop &loop) {
+        auto tcp = uv::Tcp::Create(loop);
+        if (!tcp) return;
+        tcp->Bind("", m_port);
+        tcp->connection.connect([this, srv = tcp.get()] {
+            auto stream = srv->Accept();
+            if (!stream) return;
+            auto conn = std::make_shared<Connection>(stream, *this);
+            stream->SetData(conn);
+        });
+        tcp->Listen();
+    });
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "wpi/EventLoopRunner.h"
+#include "wpi/StringRef.h"
+#include "wpi/json.h"
+
+namespace t265 {
+
+/**
+ * Serves telemetry snapshots as JSON over HTTP and WebSocket.
+ *
+ * `GET /telemetry` returns a single snapshot. A WebSocket connection to the
+ * same path receives a snapshot as a text message every period.
+ *
+ * A snapshot is an object with one member per registered provider. Providers
+ * are called on the server's event loop thread, so they must be thread-safe
+ * (PoseStreamStats and PoseAggregator::GetTelemetry() are).
+ */
+    class TelemetryServer {
+    public:
+        using Provider = std::function<wpi::json()>;
+
+        /**
+         * @param port TCP port to listen on
+         * @param period interval between WebSocket pushes
+         */
+        explicit TelemetryServer(
+                unsigned int port,
+                std::chrono::milliseconds period = std::chrono::milliseconds(500));
+
+        ~TelemetryServer();
+
+        /**
+         * Registers a provider. Must be called before Start().
+         */
+        void Add(wpi::StringRef name, Provider provider);
+
+        /// Starts listening.
+        void Start();
+
+        /// Returns the current snapshot.
+        wpi::json GetSnapshot() const;
+
+    private:
+        class Connection;
+
+        unsigned int m_port;
+        std::chrono::milliseconds m_period;
+        std::vector<std::pair<std::string, Provider>> m_providers;
+        std::unique_ptr<wpi::EventLoopRunner> m_loop;
+    };
+
+}  // namespace t265
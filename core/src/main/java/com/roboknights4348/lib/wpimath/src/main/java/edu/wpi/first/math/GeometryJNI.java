@@ -0,0 +1,134 @@
+package com.roboknights4348.lib.wpimath.src.main.java.edu.wpi.first.math;
+
+
+import android.util.Log;
+
+
+/**
+ * Batched rigid-body geometry on packed arrays.
+ *
+ * <p>Planar poses are packed as (x, y, theta) and spatial poses as (x, y, z, qw, qx, qy, qz), one
+ * after another. Points are packed as (x, y) or (x, y, z). Twists are packed as (dx, dy, dtheta) or
+ * (vx, vy, vz, wx, wy, wz). Each call processes every element of its input array, so one call can
+ * replace a loop over thousands of Pose2d or Pose3d objects. Output arrays may be the same as input
+ * arrays when both use the same packing.
+ */
+public final class GeometryJNI
+{
+
+    static final String kLogTag = "wpiforftc";
+
+    static {
+        try {
+            System.loadLibrary("wpimathjni");
+        } catch (UnsatisfiedLinkError e) {
+            Log.e(kLogTag, "Failed to load native code", e);
+        }
+    }
+
+    /**
+     * Applies a planar transform to every pose: out[i] = transform * poses[i].
+     *
+     * @param transform The transform as (x, y, theta).
+     * @param poses     Packed planar poses.
+     * @param out       Array where the result will be stored.
+     */
+    public static native void transformPoses2d(double[] transform, double[] poses, double[] out);
+
+    /**
+     * Applies a spatial transform to every pose: out[i] = transform * poses[i].
+     *
+     * @param transform The transform as (x, y, z, qw, qx, qy, qz).
+     * @param poses     Packed spatial poses.
+     * @param out       Array where the result will be stored.
+     */
+    public static native void transformPoses3d(double[] transform, double[] poses, double[] out);
+
+    /**
+     * Applies a planar transform to every point.
+     *
+     * @param transform The transform as (x, y, theta).
+     * @param points    Packed (x, y) points.
+     * @param out       Array where the result will be stored.
+     */
+    public static native void transformPoints2d(double[] transform, double[] points, double[] out);
+
+    /**
+     * Applies a spatial transform to every point.
+     *
+     * @param transform The transform as (x, y, z, qw, qx, qy, qz).
+     * @param points    Packed (x, y, z) points.
+     * @param out       Array where the result will be stored.
+     */
+    public static native void transformPoints3d(double[] transform, double[] points, double[] out);
+
+    /**
+     * Appends a planar transform to every pose: out[i] = poses[i] * transform.
+     *
+     * @param poses     Packed planar poses.
+     * @param transform The transform as (x, y, theta).
+     * @param out       Array where the result will be stored.
+     */
+    public static native void composePoses2d(double[] poses, double[] transform, double[] out);
+
+    /**
+     * Appends a spatial transform to every pose: out[i] = poses[i] * transform.
+     *
+     * @param poses     Packed spatial poses.
+     * @param transform The transform as (x, y, z, qw, qx, qy, qz).
+     * @param out       Array where the result will be stored.
+     */
+    public static native void composePoses3d(double[] poses, double[] transform, double[] out);
+
+    /**
+     * Maps planar twists to poses.
+     *
+     * @param twists Packed (dx, dy, dtheta) twists.
+     * @param out    Array where the packed poses will be stored.
+     */
+    public static native void expPoses2d(double[] twists, double[] out);
+
+    /**
+     * Maps planar poses to twists.
+     *
+     * @param poses Packed planar poses.
+     * @param out   Array where the packed twists will be stored.
+     */
+    public static native void logPoses2d(double[] poses, double[] out);
+
+    /**
+     * Maps spatial twists to poses.
+     *
+     * @param twists Packed (vx, vy, vz, wx, wy, wz) twists.
+     * @param out    Array where the packed poses will be stored.
+     */
+    public static native void expPoses3d(double[] twists, double[] out);
+
+    /**
+     * Maps spatial poses to twists.
+     *
+     * @param poses Packed spatial poses.
+     * @param out   Array where the packed twists will be stored.
+     */
+    public static native void logPoses3d(double[] poses, double[] out);
+
+    /**
+     * Interpolates pairwise along the twist between planar poses.
+     *
+     * @param a   Packed start poses.
+     * @param b   Packed end poses.
+     * @param t   Interpolation parameter in [0, 1].
+     * @param out Array where the result will be stored.
+     */
+    public static native void interpolatePoses2d(double[] a, double[] b, double t, double[] out);
+
+    /**
+     * Interpolates pairwise along the twist between spatial poses.
+     *
+     * @param a   Packed start poses.
+     * @param b   Packed end poses.
+     * @param t   Interpolation parameter in [0, 1].
+     * @param out Array where the result will be stored.
+     */
+    public static native void interpolatePoses3d(double[] a, double[] b, double t, double[] out);
+}
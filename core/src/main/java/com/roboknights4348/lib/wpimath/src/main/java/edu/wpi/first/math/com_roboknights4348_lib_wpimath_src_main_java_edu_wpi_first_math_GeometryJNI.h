@@ -0,0 +1,109 @@
+/* DO NOT EDIT THIS FILE - it is machine generated */
+#include <jni.h>
+/* Header for class com_roboknights4348_lib_wpimath_src_main_java_edu_wpi_first_math_GeometryJNI */
+
+#ifndef _Included_com_roboknights4348_lib_wpimath_src_main_java_edu_wpi_first_math_GeometryJNI
+#define _Included_com_roboknights4348_lib_wpimath_src_main_java_edu_wpi_first_math_GeometryJNI
+#ifdef __cplusplus
+extern "C" {
+#endif
+/*
+ * Class:     com_roboknights4348_lib_wpimath_src_main_java_edu_wpi_first_math_GeometryJNI
+ * Method:    transformPoses2d
+ * Signature: ([D[D[D)V
+ */
+JNIEXPORT void JNICALL Java_com_roboknights4348_lib_wpimath_src_main_java_edu_wpi_first_math_GeometryJNI_transformPoses2d
+  (JNIEnv *, jclass, jdoubleArray, jdoubleArray, jdoubleArray);
+
+/*
+ * Class:     com_roboknights4348_lib_wpimath_src_main_java_edu_wpi_first_math_GeometryJNI
+ * Method:    transformPoses3d
+ * Signature: ([D[D[D)V
+ */
+JNIEXPORT void JNICALL Java_com_roboknights4348_lib_wpimath_src_main_java_edu_wpi_first_math_GeometryJNI_transformPoses3d
+  (JNIEnv *, jclass, jdoubleArray, jdoubleArray, jdoubleArray);
+
+/*
+ * Class:     com_roboknights4348_lib_wpimath_src_main_java_edu_wpi_first_math_GeometryJNI
+ * Method:    transformPoints2d
+ * Signature: ([D[D[D)V
+ */
+JNIEXPORT void JNICALL Java_com_roboknights4348_lib_wpimath_src_main_java_edu_wpi_first_math_GeometryJNI_transformPoints2d
+  (JNIEnv *, jclass, jdoubleArray, jdoubleArray, jdoubleArray);
+
+/*
+ * Class:     com_roboknights4348_lib_wpimath_src_main_java_edu_wpi_first_math_GeometryJNI
+ * Method:    transformPoints3d
+ * Signature: ([D[D[D)V
+ */
+JNIEXPORT void JNICALL Java_com_roboknights4348_lib_wpimath_src_main_java_edu_wpi_first_math_GeometryJNI_transformPoints3d
+  (JNIEnv *, jclass, jdoubleArray, jdoubleArray, jdoubleArray);
+
+/*
+ * Class:     com_roboknights4348_lib_wpimath_src_main_java_edu_wpi_first_math_GeometryJNI
+ * Method:    composePoses2d
+ * Signature: ([D[D[D)V
+ */
+JNIEXPORT void JNICALL Java_com_roboknights4348_lib_wpimath_src_main_java_edu_wpi_first_math_GeometryJNI_composePoses2d
+  (JNIEnv *, jclass, jdoubleArray, jdoubleArray, jdoubleArray);
+
+/*
+ * Class:     com_roboknights4348_lib_wpimath_src_main_java_edu_wpi_first_math_GeometryJNI
+ * Method:    composePoses3d
+ * Signature: ([D[D[D)V
+ */
+JNIEXPORT void JNICALL Java_com_roboknights4348_lib_wpimath_src_main_java_edu_wpi_first_math_GeometryJNI_composePoses3d
+  (JNIEnv *, jclass, jdoubleArray, jdoubleArray, jdoubleArray);
+
+/*
+ * Class:     com_roboknights4348_lib_wpimath_src_main_java_edu_wpi_first_math_GeometryJNI
+ * Method:    expPoses2d
+ * Signature: ([D[D)V
+ */
+JNIEXPORT void JNICALL Java_com_roboknights4348_lib_wpimath_src_main_java_edu_wpi_first_math_GeometryJNI_expPoses2d
+  (JNIEnv *, jclass, jdoubleArray, jdoubleArray);
+
+/*
+ * Class:     com_roboknights4348_lib_wpimath_src_main_java_edu_wpi_first_math_GeometryJNI
+ * Method:    logPoses2d
+ * Signature: ([D[D)V
+ */
+JNIEXPORT void JNICALL Java_com_roboknights4348_lib_wpimath_src_main_java_edu_wpi_first_math_GeometryJNI_logPoses2d
+  (JNIEnv *, jclass, jdoubleArray, jdoubleArray);
+
+/*
+ * Class:     com_roboknights4348_lib_wpimath_src_main_java_edu_wpi_first_math_GeometryJNI
+ * Method:    expPoses3d
+ * Signature: ([D[D)V
+ */
+JNIEXPORT void JNICALL Java_com_roboknights4348_lib_wpimath_src_main_java_edu_wpi_first_math_GeometryJNI_expPoses3d
+  (JNIEnv *, jclass, jdoubleArray, jdoubleArray);
+
+/*
+ * Class:     com_roboknights4348_lib_wpimath_src_main_java_edu_wpi_first_math_GeometryJNI
+ * Method:    logPoses3d
+ * Signature: ([D[D)V
+ */
+JNIEXPORT void JNICALL Java_com_roboknights4348_lib_wpimath_src_main_java_edu_wpi_first_math_GeometryJNI_logPoses3d
+  (JNIEnv *, jclass, jdoubleArray, jdoubleArray);
+
+/*
+ * Class:     com_roboknights4348_lib_wpimath_src_main_java_edu_wpi_first_math_GeometryJNI
+ * Method:    interpolatePoses2d
+ * Signature: ([D[DD[D)V
+ */
+JNIEXPORT void JNICALL Java_com_roboknights4348_lib_wpimath_src_main_java_edu_wpi_first_math_GeometryJNI_interpolatePoses2d
+  (JNIEnv *, jclass, jdoubleArray, jdoubleArray, jdouble, jdoubleArray);
+
+/*
+ * Class:     com_roboknights4348_lib_wpimath_src_main_java_edu_wpi_first_math_GeometryJNI
+ * Method:    interpolatePoses3d
+ * Signature: ([D[DD[D)V
+ */
+JNIEXPORT void JNICALL Java_com_roboknights4348_lib_wpimath_src_main_java_edu_wpi_first_math_GeometryJNI_interpolatePoses3d
+  (JNIEnv *, jclass, jdoubleArray, jdoubleArray, jdouble, jdoubleArray);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
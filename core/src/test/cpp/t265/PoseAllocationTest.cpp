@@ -0,0 +1,324 @@
+// Checks that the pose hot path never touches the heap: frames delivered
+// through the librealsense callback, copied into the pool, handed to the
+// aggregator's stream thread and fused by Update(). librealsense is replaced
+// by a fake camera that calls the registered callback at 200 Hz, and the
+// global allocation functions count every call made while measuring.
+//
+// Build from core/src/main/cpp, linking the wpiutil sources in native/cpp:
+//
+//   g++ -std=c++17 -pthread -I. -Iinclude -Inative/include -It265 \
+//       ../../test/cpp/t265/PoseAllocationTest.cpp t265/PoseAggregator.cpp \
+//       t265/PoseTelemetry.cpp t265/Rs2PoseSource.cpp <wpiutil> \
+//       -o PoseAllocationTest
+//
+// Exits with a non-zero status if anything was allocated per frame.
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <thread>
+
+#include <librealsense2/rs.h>
+#include <librealsense2/h/rs_pipeline.h>
+
+#include "PoseAggregator.h"
+#include "Rs2PoseSource.h"
+
+namespace {
+
+    std::atomic<bool> gCounting{false};
+    std::atomic<uint64_t> gAllocations{0};
+
+    void *Allocate(size_t size, size_t alignment = 0) {
+        if (gCounting.load(std::memory_order_relaxed)) {
+            gAllocations.fetch_add(1, std::memory_order_relaxed);
+        }
+        if (size == 0) size = 1;
+        void *p;
+        if (alignment > alignof(std::max_align_t)) {
+            p = std::aligned_alloc(alignment,
+                                   (size + alignment - 1) / alignment * alignment);
+        } else {
+            p = std::malloc(size);
+        }
+        if (!p) throw std::bad_alloc();
+        return p;
+    }
+
+}  // namespace
+
+void *operator new(size_t size) { return Allocate(size); }
+
+void *operator new[](size_t size) { return Allocate(size); }
+
+void *operator new(size_t size, std::align_val_t alignment) {
+    return Allocate(size, static_cast<size_t>(alignment));
+}
+
+void *operator new[](size_t size, std::align_val_t alignment) {
+    return Allocate(size, static_cast<size_t>(alignment));
+}
+
+void *operator new(size_t size, const std::nothrow_t &) noexcept {
+    try {
+        return Allocate(size);
+    } catch (const std::bad_alloc &) {
+        return nullptr;
+    }
+}
+
+void *operator new[](size_t size, const std::nothrow_t &) noexcept {
+    try {
+        return Allocate(size);
+    } catch (const std::bad_alloc &) {
+        return nullptr;
+    }
+}
+
+void operator delete(void *p) noexcept { std::free(p); }
+
+void operator delete[](void *p) noexcept { std::free(p); }
+
+void operator delete(void *p, size_t) noexcept { std::free(p); }
+
+void operator delete[](void *p, size_t) noexcept { std::free(p); }
+
+void operator delete(void *p, std::align_val_t) noexcept { std::free(p); }
+
+void operator delete[](void *p, std::align_val_t) noexcept { std::free(p); }
+
+void operator delete(void *p, size_t, std::align_val_t) noexcept { std::free(p); }
+
+void operator delete[](void *p, size_t, std::align_val_t) noexcept {
+    std::free(p);
+}
+
+// The opaque librealsense types only need to exist for the fake
+struct rs2_error {
+};
+struct rs2_context {
+};
+struct rs2_pipeline {
+};
+struct rs2_config {
+};
+struct rs2_pipeline_profile {
+};
+struct rs2_frame {
+    bool composite;
+    // the pose frame embedded in a frameset
+    rs2_frame *embedded;
+    rs2_pose pose;
+    rs2_time_t timestamp;
+    unsigned long long number;
+};
+
+namespace {
+
+/**
+ * Stands in for a T265: calls the pipeline callback at 200 Hz from its own
+ * thread, alternating between bare pose frames and framesets holding one.
+ * Frames are preallocated and reused, as librealsense does with its frame
+ * pool, and references are counted to check that every one is released.
+ */
+    class FakeCamera {
+    public:
+        static constexpr auto kPeriod = std::chrono::microseconds(5000);
+
+        void Start(rs2_frame_callback_ptr callback, void *user) {
+            m_running = true;
+            m_thread = std::thread([=] { Run(callback, user); });
+        }
+
+        void Stop() {
+            m_running = false;
+            if (m_thread.joinable()) m_thread.join();
+        }
+
+        void AddRef() { m_references.fetch_add(1, std::memory_order_relaxed); }
+
+        void Release() { m_references.fetch_sub(1, std::memory_order_relaxed); }
+
+        int GetReferences() const { return m_references.load(); }
+
+    private:
+        void Run(rs2_frame_callback_ptr callback, void *user) {
+            auto start = std::chrono::steady_clock::now();
+            auto next = start;
+            for (unsigned long long number = 1; m_running; ++number) {
+                next += kPeriod;
+                std::this_thread::sleep_until(next);
+
+                double t = std::chrono::duration<double>(next - start).count();
+                m_pose.composite = false;
+                m_pose.embedded = nullptr;
+                m_pose.pose = rs2_pose{};
+                m_pose.pose.translation.z = static_cast<float>(-0.5 * t);
+                m_pose.pose.rotation.w = 1;
+                m_pose.pose.tracker_confidence = 3;
+                m_pose.timestamp = t * 1e3;
+                m_pose.number = number;
+
+                rs2_frame *frame = &m_pose;
+                if (number % 2 == 0) {
+                    m_frameset = m_pose;
+                    m_frameset.composite = true;
+                    m_frameset.embedded = &m_pose;
+                    frame = &m_frameset;
+                }
+                AddRef();
+                callback(frame, user);
+            }
+        }
+
+        std::atomic<bool> m_running{false};
+        std::atomic<int> m_references{0};
+        std::thread m_thread;
+        rs2_frame m_pose{};
+        rs2_frame m_frameset{};
+    };
+
+    FakeCamera gCamera;
+    rs2_context gContext;
+    rs2_pipeline gPipeline;
+    rs2_config gConfig;
+    rs2_pipeline_profile gProfile;
+
+}  // namespace
+
+extern "C" {
+
+const char *rs2_get_failed_function(const rs2_error *) { return "fake"; }
+
+const char *rs2_get_failed_args(const rs2_error *) { return ""; }
+
+const char *rs2_get_error_message(const rs2_error *) { return "fake"; }
+
+void rs2_free_error(rs2_error *) {}
+
+rs2_context *rs2_create_context(int, rs2_error **) { return &gContext; }
+
+void rs2_delete_context(rs2_context *) {}
+
+rs2_pipeline *rs2_create_pipeline(rs2_context *, rs2_error **) {
+    return &gPipeline;
+}
+
+void rs2_delete_pipeline(rs2_pipeline *) {}
+
+rs2_config *rs2_create_config(rs2_error **) { return &gConfig; }
+
+void rs2_delete_config(rs2_config *) {}
+
+void rs2_config_enable_device(rs2_config *, const char *, rs2_error **) {}
+
+void rs2_config_enable_stream(rs2_config *, rs2_stream, int, int, int,
+                              rs2_format, int, rs2_error **) {}
+
+rs2_pipeline_profile *rs2_pipeline_start_with_config(rs2_pipeline *,
+                                                     rs2_config *,
+                                                     rs2_error **) {
+    return &gProfile;
+}
+
+rs2_pipeline_profile *rs2_pipeline_start_with_config_and_callback(
+        rs2_pipeline *, rs2_config *, rs2_frame_callback_ptr on_frame, void *user,
+        rs2_error **) {
+    gCamera.Start(on_frame, user);
+    return &gProfile;
+}
+
+void rs2_pipeline_stop(rs2_pipeline *, rs2_error **) { gCamera.Stop(); }
+
+void rs2_delete_pipeline_profile(rs2_pipeline_profile *) {}
+
+int rs2_pipeline_try_wait_for_frames(rs2_pipeline *, rs2_frame **, unsigned int,
+                                     rs2_error **) {
+    return 0;
+}
+
+int rs2_is_frame_extendable_to(const rs2_frame *frame,
+                               rs2_extension extension_type, rs2_error **) {
+    if (extension_type == RS2_EXTENSION_COMPOSITE_FRAME) return frame->composite;
+    if (extension_type == RS2_EXTENSION_POSE_FRAME) return !frame->composite;
+    return 0;
+}
+
+int rs2_embedded_frames_count(rs2_frame *composite, rs2_error **) {
+    return composite->composite ? 1 : 0;
+}
+
+rs2_frame *rs2_extract_frame(rs2_frame *composite, int, rs2_error **) {
+    gCamera.AddRef();
+    return composite->embedded;
+}
+
+void rs2_release_frame(rs2_frame *) { gCamera.Release(); }
+
+void rs2_pose_frame_get_pose_data(const rs2_frame *frame, rs2_pose *pose,
+                                  rs2_error **) {
+    *pose = frame->pose;
+}
+
+rs2_time_t rs2_get_frame_timestamp(const rs2_frame *frame, rs2_error **) {
+    return frame->timestamp;
+}
+
+unsigned long long rs2_get_frame_number(const rs2_frame *frame, rs2_error **) {
+    return frame->number;
+}
+
+}  // extern "C"
+
+int main() {
+    using namespace t265;
+    using namespace std::chrono_literals;
+
+    PoseAggregator aggregator;
+    auto source = std::make_unique<Rs2CallbackPoseSource>();
+    Rs2CallbackPoseSource *camera = source.get();
+    aggregator.AddStream(std::move(source), CameraExtrinsics{},
+                         Eigen::Vector3d(0.01, 0.01, 0.01));
+
+    // Let threads start and the first frames through before measuring
+    aggregator.Start();
+    std::this_thread::sleep_for(500ms);
+
+    const PoseStreamStats &stats = aggregator.GetStreamStats(0);
+    uint64_t framesBefore = stats.GetFrames();
+    int ticks = 0;
+    gCounting = true;
+    auto end = std::chrono::steady_clock::now() + 2s;
+    while (std::chrono::steady_clock::now() < end) {
+        std::this_thread::sleep_for(20ms);
+        if (aggregator.Update().numMeasurements > 0) ++ticks;
+        aggregator.MarkRead();
+    }
+    gCounting = false;
+    uint64_t frames = stats.GetFrames() - framesBefore;
+
+    aggregator.Stop();
+
+    bool ok = true;
+    std::printf("%llu frames, %d fused ticks, %llu allocations, %llu dropped\n",
+                static_cast<unsigned long long>(frames), ticks,
+                static_cast<unsigned long long>(gAllocations.load()),
+                static_cast<unsigned long long>(camera->GetDropped()));
+    if (gAllocations.load() != 0) {
+        std::printf("FAIL: the hot path allocated\n");
+        ok = false;
+    }
+    // 2 s at 200 Hz, allowing for scheduling jitter
+    if (frames < 300 || ticks == 0) {
+        std::printf("FAIL: frames did not reach the aggregator\n");
+        ok = false;
+    }
+    if (gCamera.GetReferences() != 0) {
+        std::printf("FAIL: %d frame references not released\n",
+                    gCamera.GetReferences());
+        ok = false;
+    }
+    return ok ? 0 : 1;
+}